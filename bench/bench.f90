@@ -0,0 +1,450 @@
+module bench_kernels
+  use, intrinsic :: iso_c_binding
+  use, intrinsic :: iso_fortran_env
+  use :: vector
+  use :: vector_i32
+  use :: concurrent_vector
+  use :: concurrent_append_vector
+  implicit none
+
+
+  !* Elements of a few sizes. The bytes don't matter, only how many there are.
+  type :: bytes_4
+    integer(c_int8_t), dimension(4) :: b = 1
+  end type bytes_4
+
+  type :: bytes_16
+    integer(c_int8_t), dimension(16) :: b = 1
+  end type bytes_16
+
+  type :: bytes_64
+    integer(c_int8_t), dimension(64) :: b = 1
+  end type bytes_64
+
+
+  !* Where the CSV goes.
+  integer :: output = output_unit
+
+  !* Every run is repeated this many times, and the fastest one is reported.
+  integer, parameter :: REPEATS = 3
+
+  !* How many elements insert and remove shift through, since each one is O(n).
+  integer(c_size_t), parameter :: SHIFT_OPS = 1000
+
+  !* Keeps the optimizer from throwing away loops that only read.
+  integer(int64) :: sink = 0
+
+  integer(int64) :: gc_calls = 0
+
+  !* What the contention workers push into. A worker only sees its user_data, so these live here.
+  type(concurrent_vec) :: shared_concurrent
+  type(concurrent_append_vec) :: shared_append
+  integer :: contention_target = 0
+  integer(c_size_t) :: pushes_per_thread = 0
+
+
+contains
+
+
+  function now() result(seconds)
+    implicit none
+
+    real(real64) :: seconds
+    integer(int64) :: count, rate
+
+    call system_clock(count, rate)
+
+    seconds = real(count, real64) / real(rate, real64)
+  end function now
+
+
+  subroutine report(benchmark, container, element_size, count, threads, seconds, ops)
+    implicit none
+
+    character(len = *), intent(in) :: benchmark, container
+    integer(c_size_t), intent(in) :: element_size, count, ops
+    integer, intent(in) :: threads
+    real(real64), intent(in) :: seconds
+
+    write(output, '(a, ",", a, ",", i0, ",", i0, ",", i0, ",", f0.9, ",", f0.3)') &
+      benchmark, container, element_size, count, threads, seconds, (seconds * 1.0e9_real64) / real(max(ops, 1_c_size_t), real64)
+  end subroutine report
+
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_calls = gc_calls + 1
+  end subroutine counting_gc
+
+
+  subroutine fill(v, prototype, count)
+    implicit none
+
+    type(vec), intent(inout) :: v
+    class(*), intent(in), target :: prototype
+    integer(c_size_t), intent(in) :: count
+    integer(c_size_t) :: i
+
+    do i = 1, count
+      call v%push_back(prototype)
+    end do
+  end subroutine fill
+
+
+  !* Every vec operation, for one element size and count.
+  subroutine bench_vec(prototype, element_size, count)
+    implicit none
+
+    class(*), intent(in), target :: prototype
+    integer(c_size_t), intent(in) :: element_size, count
+    type(vec) :: v, copy
+    integer(c_int8_t), pointer :: first_byte
+    integer(c_size_t) :: i, shifts
+    integer :: r
+    real(real64) :: start, best(9)
+
+    best = huge(1.0_real64)
+    shifts = min(count, SHIFT_OPS)
+
+    do r = 1, REPEATS
+      v = new_vec(element_size, 0_c_size_t)
+
+      start = now()
+      call fill(v, prototype, count)
+      best(1) = min(best(1), now() - start)
+
+      start = now()
+      do i = 1, count
+        call c_f_pointer(v%get(i), first_byte)
+        sink = sink + first_byte
+      end do
+      best(2) = min(best(2), now() - start)
+
+      start = now()
+      do i = 1, count
+        call v%set(i, prototype)
+      end do
+      best(3) = min(best(3), now() - start)
+
+      start = now()
+      do i = 1, shifts
+        call v%insert(1_c_size_t, prototype)
+      end do
+      best(4) = min(best(4), now() - start)
+
+      start = now()
+      do i = 1, shifts
+        call v%remove(1_c_size_t)
+      end do
+      best(5) = min(best(5), now() - start)
+
+      ! Sharing is free, the copy happens on the first write.
+      start = now()
+      call v%clone(copy)
+      best(6) = min(best(6), now() - start)
+
+      start = now()
+      call copy%make_unique()
+      best(7) = min(best(7), now() - start)
+      call copy%destroy()
+
+      start = now()
+      call v%resize(count * 2, prototype)
+      call v%resize(count, prototype)
+      best(8) = min(best(8), now() - start)
+
+      call v%destroy()
+
+      v = new_vec(element_size, count, counting_gc)
+      call fill(v, prototype, count)
+      gc_calls = 0
+
+      start = now()
+      call v%clear()
+      best(9) = min(best(9), now() - start)
+
+      if (gc_calls /= count) then
+        error stop "[Bench] The GC didn't run on every element."
+      end if
+
+      call v%destroy()
+    end do
+
+    call report("push_back", "vec", element_size, count, 1, best(1), count)
+    call report("get", "vec", element_size, count, 1, best(2), count)
+    call report("set", "vec", element_size, count, 1, best(3), count)
+    call report("insert_front", "vec", element_size, count, 1, best(4), shifts)
+    call report("remove_front", "vec", element_size, count, 1, best(5), shifts)
+    call report("clone_shared", "vec", element_size, count, 1, best(6), 1_c_size_t)
+    call report("clone_unique", "vec", element_size, count, 1, best(7), count)
+    call report("resize", "vec", element_size, count, 1, best(8), count * 2)
+    call report("clear_gc", "vec", element_size, count, 1, best(9), count)
+  end subroutine bench_vec
+
+
+  !* The same operations on 4 byte integers, with vec_i32 and a plain allocatable array.
+  !* This is the baseline the library has to beat, or at least keep up with.
+  subroutine bench_baselines(count)
+    implicit none
+
+    integer(c_size_t), intent(in) :: count
+    type(vec_i32) :: typed
+    integer(c_int32_t), dimension(:), allocatable :: array, grown, copy
+    integer(c_size_t) :: i, length, shifts
+    integer :: r
+    real(real64) :: start, best(8), typed_best(3)
+
+    best = huge(1.0_real64)
+    typed_best = huge(1.0_real64)
+    shifts = min(count, SHIFT_OPS)
+
+    do r = 1, REPEATS
+      typed = new_vec_i32(0_c_size_t)
+
+      start = now()
+      do i = 1, count
+        call typed%push_back(int(i, c_int32_t))
+      end do
+      typed_best(1) = min(typed_best(1), now() - start)
+
+      start = now()
+      do i = 1, count
+        sink = sink + typed%get(i)
+      end do
+      typed_best(2) = min(typed_best(2), now() - start)
+
+      start = now()
+      do i = 1, count
+        call typed%set(i, 7_c_int32_t)
+      end do
+      typed_best(3) = min(typed_best(3), now() - start)
+
+      call typed%destroy()
+
+      ! Growing by doubling by hand, the way you would without a vector.
+      allocate(array(1))
+      length = 0
+
+      start = now()
+      do i = 1, count
+        if (length == size(array, kind = c_size_t)) then
+          allocate(grown(size(array) * 2))
+          grown(1:length) = array(1:length)
+          call move_alloc(grown, array)
+        end if
+        length = length + 1
+        array(length) = int(i, c_int32_t)
+      end do
+      best(1) = min(best(1), now() - start)
+
+      start = now()
+      do i = 1, count
+        sink = sink + array(i)
+      end do
+      best(2) = min(best(2), now() - start)
+
+      start = now()
+      do i = 1, count
+        array(i) = 7
+      end do
+      best(3) = min(best(3), now() - start)
+
+      if (size(array, kind = c_size_t) < length + shifts) then
+        allocate(grown(length + shifts))
+        grown(1:length) = array(1:length)
+        call move_alloc(grown, array)
+      end if
+
+      start = now()
+      do i = 1, shifts
+        array(2:length + 1) = array(1:length)
+        array(1) = 3
+        length = length + 1
+      end do
+      best(4) = min(best(4), now() - start)
+
+      start = now()
+      do i = 1, shifts
+        array(1:length - 1) = array(2:length)
+        length = length - 1
+      end do
+      best(5) = min(best(5), now() - start)
+
+      start = now()
+      copy = array(1:length)
+      best(6) = min(best(6), now() - start)
+      sink = sink + copy(1)
+      deallocate(copy)
+
+      start = now()
+      allocate(grown(length * 2))
+      grown(1:length) = array(1:length)
+      grown(length + 1:) = 7
+      call move_alloc(grown, array)
+      allocate(grown(length))
+      grown = array(1:length)
+      call move_alloc(grown, array)
+      best(7) = min(best(7), now() - start)
+
+      start = now()
+      deallocate(array)
+      best(8) = min(best(8), now() - start)
+    end do
+
+    call report("push_back", "vec_i32", 4_c_size_t, count, 1, typed_best(1), count)
+    call report("get", "vec_i32", 4_c_size_t, count, 1, typed_best(2), count)
+    call report("set", "vec_i32", 4_c_size_t, count, 1, typed_best(3), count)
+    call report("push_back", "allocatable", 4_c_size_t, count, 1, best(1), count)
+    call report("get", "allocatable", 4_c_size_t, count, 1, best(2), count)
+    call report("set", "allocatable", 4_c_size_t, count, 1, best(3), count)
+    call report("insert_front", "allocatable", 4_c_size_t, count, 1, best(4), shifts)
+    call report("remove_front", "allocatable", 4_c_size_t, count, 1, best(5), shifts)
+    call report("clone_unique", "allocatable", 4_c_size_t, count, 1, best(6), count)
+    call report("resize", "allocatable", 4_c_size_t, count, 1, best(7), count * 2)
+    call report("clear", "allocatable", 4_c_size_t, count, 1, best(8), count)
+  end subroutine bench_baselines
+
+
+  !* Each worker thread runs this once, and pushes its share into the shared vector.
+  !* The driver vec holds one slot per thread, so each span is one thread's job.
+  subroutine contention_worker(base_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_size_t) :: job, i
+    integer(c_int32_t) :: value
+
+    value = 1
+
+    do job = 1, count
+      do i = 1, pushes_per_thread
+        if (contention_target == 3) then
+          call shared_append%push_back(value)
+        else
+          call shared_concurrent%push_back(value)
+        end if
+      end do
+    end do
+  end subroutine contention_worker
+
+
+  !* Many threads pushing into one vector at once.
+  !* 1 is concurrent_vec with a mutex, 2 is with a reader/writer lock, 3 is concurrent_append_vec.
+  subroutine bench_contention(total_pushes)
+    implicit none
+
+    integer(c_size_t), intent(in) :: total_pushes
+    integer, dimension(4), parameter :: thread_counts = [1, 2, 4, 8]
+    character(len = 24), dimension(3), parameter :: names = [character(len = 24) :: &
+      "concurrent_vec_mutex", "concurrent_vec_rwlock", "concurrent_append_vec"]
+    type(vec) :: driver
+    integer(c_int64_t) :: slot
+    integer :: t, kind, r
+    integer(c_size_t) :: threads, pushed
+    real(real64) :: start, best
+
+    slot = 0
+
+    do kind = 1, 3
+      do t = 1, size(thread_counts)
+        threads = int(thread_counts(t), c_size_t)
+        pushes_per_thread = total_pushes / threads
+        contention_target = kind
+        best = huge(1.0_real64)
+
+        call vec_set_parallel_threads(threads)
+
+        driver = new_vec(8_c_size_t, threads)
+        do while (driver%size() < threads)
+          call driver%push_back(slot)
+        end do
+
+        do r = 1, REPEATS
+          select case (kind)
+          case (1)
+            shared_concurrent = new_concurrent_vec(4_c_size_t, 0_c_size_t)
+          case (2)
+            shared_concurrent = new_concurrent_vec(4_c_size_t, 0_c_size_t, use_rwlock = .true.)
+          case (3)
+            shared_append = new_concurrent_append_vec(4_c_size_t, 1024_c_size_t)
+          end select
+
+          start = now()
+          call driver%parallel_for_each(contention_worker, 1_c_size_t)
+          best = min(best, now() - start)
+
+          if (kind == 3) then
+            pushed = shared_append%size()
+            call shared_append%destroy()
+          else
+            pushed = shared_concurrent%size()
+            call shared_concurrent%destroy()
+          end if
+
+          if (pushed /= pushes_per_thread * threads) then
+            error stop "[Bench] A push went missing."
+          end if
+        end do
+
+        call driver%destroy()
+
+        call report("push_back_contended", trim(names(kind)), 4_c_size_t, pushes_per_thread * threads, thread_counts(t), &
+          best, pushes_per_thread * threads)
+      end do
+    end do
+
+    call vec_set_parallel_threads(0_c_size_t)
+  end subroutine bench_contention
+
+
+end module bench_kernels
+
+
+!* Times the vectors, and writes one CSV row per measurement.
+!*
+!* fpm run bench -- results.csv
+!*
+!* With no argument, the CSV goes to the terminal.
+!* ns_per_op is the fastest of a few repeats, so the noise mostly cancels out.
+program bench
+  use, intrinsic :: iso_c_binding
+  use :: bench_kernels
+  implicit none
+
+  type(bytes_4) :: element_4
+  type(bytes_16) :: element_16
+  type(bytes_64) :: element_64
+  integer(c_size_t), dimension(2), parameter :: counts = [10000_c_size_t, 1000000_c_size_t]
+  character(len = 4096) :: path
+  integer :: i
+
+  if (command_argument_count() >= 1) then
+    call get_command_argument(1, path)
+    open(newunit = output, file = trim(path), status = "replace", action = "write")
+  end if
+
+  write(output, '(a)') "benchmark,container,element_size,count,threads,seconds,ns_per_op"
+
+  do i = 1, size(counts)
+    call bench_vec(element_4, 4_c_size_t, counts(i))
+    call bench_vec(element_16, 16_c_size_t, counts(i))
+    call bench_vec(element_64, 64_c_size_t, counts(i))
+    call bench_baselines(counts(i))
+  end do
+
+  call bench_contention(1000000_c_size_t)
+
+  if (output /= output_unit) then
+    close(output)
+  end if
+
+  ! So the reads can't be optimized away.
+  if (sink == -1) then
+    print *, sink
+  end if
+end program bench
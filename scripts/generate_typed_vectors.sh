@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Generates the type specialized vectors in src/ from scripts/templates/typed_vec.f90.in
+# Run it from the root of the repo after you change the template.
+
+template="./scripts/templates/typed_vec.f90.in"
+
+if [ ! -f "$template" ]; then
+  echo "Run this from the root of the repo!"
+  exit 1
+fi
+
+# name | type | zero | how the radix sort reads it
+types=(
+  "i32|integer(c_int32_t)|0_c_int32_t|VEC_RADIX_SIGNED"
+  "i64|integer(c_int64_t)|0_c_int64_t|VEC_RADIX_SIGNED"
+  "r32|real(c_float)|0.0_c_float|VEC_RADIX_REAL"
+  "r64|real(c_double)|0.0_c_double|VEC_RADIX_REAL"
+  "c_ptr|type(c_ptr)|c_null_ptr|VEC_RADIX_UNSIGNED"
+)
+
+for entry in "${types[@]}"; do
+  IFS="|" read -r name type zero radix_kind <<< "$entry"
+
+  sed -e "s/@NAME@/$name/g" \
+      -e "s/@TYPE@/$type/g" \
+      -e "s/@ZERO@/$zero/g" \
+      -e "s/@RADIX_KIND@/$radix_kind/g" \
+      "$template" > "./src/vector_$name.f90"
+
+  echo "Generated src/vector_$name.f90"
+done
+
+exit 0
@@ -0,0 +1,202 @@
+module concurrent_append_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  implicit none
+
+
+  private
+
+
+  public :: concurrent_append_vec
+  public :: new_concurrent_append_vec
+
+
+  !* An append only vector that any number of threads can push into and read from at once.
+  !* There is no mutex. Each push reserves its slot with a single atomic add.
+  !*
+  !* Elements are stored in segments that double in size, so growing never moves anything.
+  !* The pointer you get from get() stays valid until the vector is destroyed.
+  type :: concurrent_append_vec
+    private
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => concurrent_append_vector_destroy
+    procedure :: get => concurrent_append_vector_get
+    procedure :: is_empty => concurrent_append_vector_is_empty
+    procedure :: size => concurrent_append_vector_size
+    procedure :: capacity => concurrent_append_vector_capacity
+    procedure :: push_back => concurrent_append_vector_push_back
+    procedure :: push_back_array => concurrent_append_vector_push_back_array
+  end type concurrent_append_vec
+
+
+contains
+
+
+  !* Create a new append only vector.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* initial_size is the capacity of the first segment. It's rounded up to a power of 2.
+  function new_concurrent_append_vec(size_of_type, initial_size, optional_gc_func) result(v)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, initial_size
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(concurrent_append_vec) :: v
+
+    ! This will automatically clean your memory upon deletion.
+    if (present(optional_gc_func)) then
+      v%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    v%data = internal_new_append_vector(initial_size, size_of_type)
+
+    v%size_of_type = size_of_type
+  end function new_concurrent_append_vec
+
+
+  !* Destroy all components of the vector. Elements and underlying C memory.
+  !* Make sure no other thread is still using the vector when you call this.
+  subroutine concurrent_append_vector_destroy(this)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_size_t) :: i
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    if (c_associated(this%gc_func)) then
+      call c_f_procpointer(this%gc_func, optional_gc)
+
+      do i = 1, this%size()
+        call optional_gc(internal_append_vector_get(this%data, i))
+      end do
+    end if
+
+    call internal_destroy_append_vector(this%data)
+
+    this%data = c_null_ptr
+    this%size_of_type = 0
+  end subroutine concurrent_append_vector_destroy
+
+
+  !* Get an element at an index in the vector.
+  !* The pointer stays valid while other threads keep pushing.
+  function concurrent_append_vector_get(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    if (index < 1) then
+      error stop "[Vector] Error: Went out of bounds."
+    end if
+
+    raw_c_pointer = internal_append_vector_get(this%data, index)
+
+    if (.not. c_associated(raw_c_pointer)) then
+      error stop "[Vector] Error: Went out of bounds."
+    end if
+  end function concurrent_append_vector_get
+
+
+  !* Check if the vector is empty.
+  function concurrent_append_vector_is_empty(this) result(empty)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    if (.not. c_associated(this%data)) then
+      empty = .true.
+    else
+      empty = internal_append_vector_size(this%data) == 0
+    end if
+  end function concurrent_append_vector_is_empty
+
+
+  !* Get the number of elements in the vector that are ready to be read.
+  function concurrent_append_vector_size(this) result(size)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    size = internal_append_vector_size(this%data)
+  end function concurrent_append_vector_size
+
+
+  !* Get the total allocated size (in elements) of the vector.
+  function concurrent_append_vector_capacity(this) result(cap)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    integer(c_size_t) :: cap
+
+    cap = internal_append_vector_capacity(this%data)
+  end function concurrent_append_vector_capacity
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element to the back of the vector. Safe to call from any thread.
+  !* If you need to know where it went, pass in index.
+  subroutine concurrent_append_vector_push_back(this, fortran_data, index)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    integer(c_size_t), intent(out), optional :: index
+    type(c_ptr) :: black_magic
+    integer(c_size_t) :: stored_index
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    stored_index = internal_append_vector_push_back(this%data, black_magic)
+
+    if (present(index)) then
+      index = stored_index
+    end if
+  end subroutine concurrent_append_vector_push_back
+
+
+  !* Uses memcpy under the hood.
+  !* Push a whole contiguous Fortran array to the back of the vector. Safe to call from any thread.
+  !* Their indices always come one after another, even with other threads pushing.
+  !* If you need to know where the first one went, pass in index.
+  !! They're not always next to each other in memory. A range that crosses into a new segment
+  !! is split between two allocations, so get(index) can't be used as a base pointer for all of them.
+  subroutine concurrent_append_vector_push_back_array(this, fortran_data, index)
+    implicit none
+
+    class(concurrent_append_vec), intent(inout) :: this
+    class(*), dimension(:), intent(in), target, contiguous :: fortran_data
+    integer(c_size_t), intent(out), optional :: index
+    type(c_ptr) :: black_magic
+    integer(c_size_t) :: stored_index
+
+    if (size(fortran_data) == 0) then
+      if (present(index)) then
+        index = 0
+      end if
+      return
+    end if
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    stored_index = internal_append_vector_push_back_array(this%data, black_magic, int(size(fortran_data), c_size_t))
+
+    if (present(index)) then
+      index = stored_index
+    end if
+  end subroutine concurrent_append_vector_push_back_array
+
+
+end module concurrent_append_vector
@@ -1,6 +1,7 @@
 module concurrent_vector
   use, intrinsic :: iso_c_binding
   use :: fortran_vector_bindings
+  use :: vector_config
   use :: thread_mutex
   implicit none
 
@@ -17,24 +18,53 @@ module concurrent_vector
     type(c_ptr) :: data = c_null_ptr
     integer(c_size_t) :: size_of_type = 0
     type(c_funptr) :: gc_func = c_null_funptr
+    type(c_funptr) :: gc_range_func = c_null_funptr
     type(c_ptr) :: mutex = c_null_ptr
+    type(c_ptr) :: rwlock = c_null_ptr
+    ! Time how long lock() waits. Only when stats are on, the clock isn't free.
+    logical(c_bool) :: time_lock = .false.
   contains
     procedure :: destroy => concurrent_vector_destroy
+    procedure :: lock => concurrent_vector_lock
+    procedure :: lock_shared => concurrent_vector_lock_shared
+    procedure :: unlock => concurrent_vector_unlock
     procedure :: get => concurrent_vector_get
+    procedure :: get_unlocked => concurrent_vector_get_unlocked
     procedure :: set => concurrent_vector_set
+    procedure :: set_unlocked => concurrent_vector_set_unlocked
     procedure :: is_empty => concurrent_vector_is_empty
+    procedure :: is_empty_unlocked => concurrent_vector_is_empty_unlocked
     procedure :: size => concurrent_vector_size
+    procedure :: size_unlocked => concurrent_vector_size_unlocked
     procedure :: capacity => concurrent_vector_capacity
+    procedure :: capacity_unlocked => concurrent_vector_capacity_unlocked
     procedure :: shrink_to_fit => concurrent_vector_shrink_to_fit
+    procedure :: shrink_to_fit_unlocked => concurrent_vector_shrink_to_fit_unlocked
     procedure :: clear => concurrent_vector_clear
+    procedure :: clear_unlocked => concurrent_vector_clear_unlocked
     procedure :: insert => concurrent_vector_insert
+    procedure :: insert_unlocked => concurrent_vector_insert_unlocked
+    procedure :: insert_range => concurrent_vector_insert_range
+    procedure :: insert_range_unlocked => concurrent_vector_insert_range_unlocked
     procedure :: remove => concurrent_vector_remove
+    procedure :: remove_unlocked => concurrent_vector_remove_unlocked
+    procedure :: remove_range => concurrent_vector_remove_range
+    procedure :: remove_range_unlocked => concurrent_vector_remove_range_unlocked
     procedure :: push_back => concurrent_vector_push_back
+    procedure :: push_back_unlocked => concurrent_vector_push_back_unlocked
     procedure :: pop_back => concurrent_vector_pop_back
+    procedure :: pop_back_unlocked => concurrent_vector_pop_back_unlocked
+    procedure :: pop_back_into => concurrent_vector_pop_back_into
+    procedure :: pop_back_into_unlocked => concurrent_vector_pop_back_into_unlocked
+    procedure :: take => concurrent_vector_take
+    procedure :: take_unlocked => concurrent_vector_take_unlocked
     procedure :: reserve => concurrent_vector_reserve
+    procedure :: reserve_unlocked => concurrent_vector_reserve_unlocked
     procedure :: resize => concurrent_vector_resize
+    procedure :: resize_unlocked => concurrent_vector_resize_unlocked
     procedure :: swap => concurrent_vector_swap
     procedure :: clone => concurrent_vector_clone
+    procedure :: stats => concurrent_vector_stats
   end type concurrent_vec
 
 
@@ -44,12 +74,26 @@ contains
   !* Create a new vector.
   !* I did not create a module interface because I want you to be able to see explicitly
   !* Where you create your vector.
-  function new_concurrent_vec(size_of_type, initial_size, optional_gc_func) result(v)
+  !*
+  !* If your vector is read far more than it's written, set use_rwlock to .true.
+  !* Then get, size, capacity, and is_empty only take shared access, so readers
+  !* don't block each other. Anything that changes the vector still takes exclusive access.
+  !*
+  !* optional_gc_range_func is a GC that gets a whole range of elements in one call.
+  !* (See vec_gc_range_blueprint)
+  !*
+  !* stats_name turns on stats for this vector, under that name, including how long threads wait on the lock.
+  !* (See stats() and vec_stats_dump)
+  function new_concurrent_vec(size_of_type, initial_size, optional_gc_func, use_rwlock, optional_gc_range_func, &
+      stats_name) result(v)
     implicit none
 
     ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
     integer(c_size_t), intent(in), value :: size_of_type, initial_size
     procedure(vec_gc_blueprint), optional :: optional_gc_func
+    procedure(vec_gc_range_blueprint), optional :: optional_gc_range_func
+    logical, intent(in), optional :: use_rwlock
+    character(len = *), intent(in), optional :: stats_name
     type(concurrent_vec) :: v
 
     ! This will automatically clean your memory upon deletion.
@@ -57,15 +101,39 @@ contains
       v%gc_func = c_funloc(optional_gc_func)
     end if
 
-    v%data = internal_new_vector(initial_size, size_of_type)
+    ! Or clean it a whole range at a time.
+    if (present(optional_gc_range_func)) then
+      if (present(optional_gc_func)) then
+        error stop "[Vector] Error: Give either a GC function or a range GC function, not both."
+      end if
+      v%gc_range_func = c_funloc(optional_gc_range_func)
+    end if
+
+    v%data = internal_new_vector(initial_size, size_of_type, c_null_ptr, 0_c_size_t)
 
     v%size_of_type = size_of_type
 
+    if (present(stats_name)) then
+      call internal_vector_enable_stats(v%data, trim(stats_name)//c_null_char)
+      v%time_lock = .true.
+    else if (VECTOR_STATS) then
+      call internal_vector_enable_stats(v%data, c_null_char)
+      v%time_lock = .true.
+    end if
+
+    if (present(use_rwlock)) then
+      if (use_rwlock) then
+        v%rwlock = internal_vector_rwlock_create()
+        return
+      end if
+    end if
+
     v%mutex = thread_create_mutex()
   end function new_concurrent_vec
 
 
   !* Destroy all components of the vector. Elements and underlying C memory.
+  !* Make sure no other thread is still using the vector when you call this.
   subroutine concurrent_vector_destroy(this)
     implicit none
 
@@ -75,19 +143,112 @@ contains
       return
     end if
 
-    if (.not. this%is_empty()) then
-      call conc_run_gc(this, 1_8, this%size())
+    call this%lock()
+
+    if (.not. this%is_empty_unlocked()) then
+      call conc_run_gc(this, 1_8, this%size_unlocked())
     end if
 
     call internal_destroy_vector(this%data)
 
     this%data = c_null_ptr
     this%size_of_type = 0
-    call thread_destroy_mutex(this%mutex)
+
+    call this%unlock()
+
+    this%time_lock = .false.
+
+    if (c_associated(this%rwlock)) then
+      call internal_vector_rwlock_destroy(this%rwlock)
+      this%rwlock = c_null_ptr
+    else
+      call thread_destroy_mutex(this%mutex)
+      this%mutex = c_null_ptr
+    end if
   end subroutine concurrent_vector_destroy
 
 
+  !* Lock the vector for exclusive access.
+  !* Use this to batch up operations with the *_unlocked procedures under one lock.
+  !*
+  !* Example:
+  !* call v%lock()
+  !* do i = 1,1000
+  !*   call v%push_back_unlocked(i)
+  !* end do
+  !* call v%unlock()
+  subroutine concurrent_vector_lock(this)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_int) :: status
+    integer(c_int64_t) :: start
+
+    start = 0
+
+    if (this%time_lock) then
+      start = internal_vector_stats_clock()
+    end if
+
+    if (c_associated(this%rwlock)) then
+      status = internal_vector_rwlock_lock_exclusive(this%rwlock)
+    else
+      status = thread_lock_mutex(this%mutex)
+    end if
+
+    if (this%time_lock) then
+      call internal_vector_stats_record_lock_wait(this%data, internal_vector_stats_clock() - start)
+    end if
+  end subroutine concurrent_vector_lock
+
+
+  !* Lock the vector for shared access.
+  !* Other readers can hold the lock at the same time, so only use read-only
+  !* *_unlocked procedures while holding it. (get, size, capacity, is_empty)
+  !* Without a rwlock, this is the same as lock().
+  subroutine concurrent_vector_lock_shared(this)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_int) :: status
+    integer(c_int64_t) :: start
+
+    start = 0
+
+    if (this%time_lock) then
+      start = internal_vector_stats_clock()
+    end if
+
+    if (c_associated(this%rwlock)) then
+      status = internal_vector_rwlock_lock_shared(this%rwlock)
+    else
+      status = thread_lock_mutex(this%mutex)
+    end if
+
+    if (this%time_lock) then
+      call internal_vector_stats_record_lock_wait(this%data, internal_vector_stats_clock() - start)
+    end if
+  end subroutine concurrent_vector_lock_shared
+
+
+  !* Unlock the vector. Works for both exclusive and shared access.
+  subroutine concurrent_vector_unlock(this)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_int) :: status
+
+    if (c_associated(this%rwlock)) then
+      status = internal_vector_rwlock_unlock(this%rwlock)
+    else
+      status = thread_unlock_mutex(this%mutex)
+    end if
+  end subroutine concurrent_vector_unlock
+
+
   !* Get an element at an index in the vector.
+  !! The pointer is only safe to use while nothing else changes the vector.
+  !! If other threads push into it, hold the lock and use get_unlocked instead.
   function concurrent_vector_get(this, index) result(raw_c_pointer)
     implicit none
 
@@ -95,35 +256,69 @@ contains
     integer(c_size_t), intent(in), value :: index
     type(c_ptr) :: raw_c_pointer
 
-    if (index < 1 .or. index > this%size()) then
-      error stop "[Vector] Error: Went out of bounds."
+    call this%lock_shared()
+    raw_c_pointer = this%get_unlocked(index)
+    call this%unlock()
+  end function concurrent_vector_get
+
+
+  !* Get an element at an index in the vector.
+  !* Does not lock. You must be holding the lock.
+  function concurrent_vector_get_unlocked(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size_unlocked()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
     end if
 
     raw_c_pointer = internal_vector_get(this%data, index)
-  end function concurrent_vector_get
+  end function concurrent_vector_get_unlocked
+
 
   !* Overwrite the data at an index in the vector.
   !* This will run the GC.
   subroutine concurrent_vector_set(this, index, fortran_data)
     implicit none
 
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(in), target :: fortran_data
+
+    call this%lock()
+    call this%set_unlocked(index, fortran_data)
+    call this%unlock()
+  end subroutine concurrent_vector_set
+
+
+  !* Overwrite the data at an index in the vector.
+  !* This will run the GC.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_set_unlocked(this, index, fortran_data)
+    implicit none
+
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: index
     class(*), intent(in), target :: fortran_data
     type(c_ptr) :: black_magic
 
-    if (index < 1 .or. index > this%size()) then
-      error stop "[Vector] Error: Went out of bounds."
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size_unlocked()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
     end if
 
-    if (.not. this%is_empty()) then
-      call conc_run_gc(this, index, this%size())
-    end if
+    call conc_run_gc(this, index, index)
 
     black_magic = transfer(loc(fortran_data), black_magic)
 
     call internal_vector_set(this%data, index, black_magic)
-  end subroutine concurrent_vector_set
+  end subroutine concurrent_vector_set_unlocked
 
 
   !* Check if the vector is empty.
@@ -133,12 +328,31 @@ contains
     class(concurrent_vec), intent(inout) :: this
     logical(c_bool) :: empty
 
+    if (.not. c_associated(this%data)) then
+      empty = .true.
+      return
+    end if
+
+    call this%lock_shared()
+    empty = this%is_empty_unlocked()
+    call this%unlock()
+  end function concurrent_vector_is_empty
+
+
+  !* Check if the vector is empty.
+  !* Does not lock. You must be holding the lock.
+  function concurrent_vector_is_empty_unlocked(this) result(empty)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    logical(c_bool) :: empty
+
     if (.not. c_associated(this%data)) then
       empty = .true.
     else
       empty = internal_vector_is_empty(this%data)
     end if
-  end function concurrent_vector_is_empty
+  end function concurrent_vector_is_empty_unlocked
 
 
   !* Get the number of elements in the vector.
@@ -148,10 +362,24 @@ contains
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t) :: size
 
-    size = internal_vector_size(this%data)
+    call this%lock_shared()
+    size = this%size_unlocked()
+    call this%unlock()
   end function concurrent_vector_size
 
 
+  !* Get the number of elements in the vector.
+  !* Does not lock. You must be holding the lock.
+  function concurrent_vector_size_unlocked(this) result(size)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    size = internal_vector_size(this%data)
+  end function concurrent_vector_size_unlocked
+
+
   !* Get the total allocated size (in elements) of the vector.
   !* You can think of this as: "slots available before a resize occurs"
   function concurrent_vector_capacity(this) result(cap)
@@ -160,10 +388,24 @@ contains
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t) :: cap
 
-    cap = internal_vector_capacity(this%data)
+    call this%lock_shared()
+    cap = this%capacity_unlocked()
+    call this%unlock()
   end function concurrent_vector_capacity
 
 
+  !* Get the total allocated size (in elements) of the vector.
+  !* Does not lock. You must be holding the lock.
+  function concurrent_vector_capacity_unlocked(this) result(cap)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t) :: cap
+
+    cap = internal_vector_capacity(this%data)
+  end function concurrent_vector_capacity_unlocked
+
+
   !* Shrink the capacity of the vector to it's size.
   !* (container size is trimmed to the current number of elements)
   subroutine concurrent_vector_shrink_to_fit(this)
@@ -171,10 +413,23 @@ contains
 
     class(concurrent_vec), intent(inout) :: this
 
-    call internal_vector_shrink_to_fit(this%data)
+    call this%lock()
+    call this%shrink_to_fit_unlocked()
+    call this%unlock()
   end subroutine concurrent_vector_shrink_to_fit
 
 
+  !* Shrink the capacity of the vector to it's size.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_shrink_to_fit_unlocked(this)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+
+    call internal_vector_shrink_to_fit(this%data)
+  end subroutine concurrent_vector_shrink_to_fit_unlocked
+
+
   !* Clear all the elements from the vector.
   !* The GC function will run on each element.
   subroutine concurrent_vector_clear(this)
@@ -182,18 +437,47 @@ contains
 
     class(concurrent_vec), intent(inout) :: this
 
-    if (.not. this%is_empty()) then
-      call conc_run_gc(this, 1_8, this%size())
+    call this%lock()
+    call this%clear_unlocked()
+    call this%unlock()
+  end subroutine concurrent_vector_clear
+
+
+  !* Clear all the elements from the vector.
+  !* The GC function will run on each element.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_clear_unlocked(this)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+
+    if (.not. this%is_empty_unlocked()) then
+      call conc_run_gc(this, 1_8, this%size_unlocked())
     end if
 
     call internal_vector_clear(this%data)
-  end subroutine concurrent_vector_clear
+  end subroutine concurrent_vector_clear_unlocked
 
 
   !* Insert an element into an index of the array.
   subroutine concurrent_vector_insert(this, index, fortran_data)
     implicit none
 
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(in), target :: fortran_data
+
+    call this%lock()
+    call this%insert_unlocked(index, fortran_data)
+    call this%unlock()
+  end subroutine concurrent_vector_insert
+
+
+  !* Insert an element into an index of the array.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_insert_unlocked(this, index, fortran_data)
+    implicit none
+
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: index
     class(*), intent(in), target :: fortran_data
@@ -201,8 +485,45 @@ contains
 
     black_magic = transfer(loc(fortran_data), black_magic)
 
-    call internal_vector_insert(this%data, index, black_magic, this%size_of_type)
-  end subroutine concurrent_vector_insert
+    call internal_vector_insert(this%data, index, black_magic)
+  end subroutine concurrent_vector_insert_unlocked
+
+
+  !* Insert count contiguous elements, starting at raw_c_pointer, into an index of the array.
+  !* The memory must hold elements of this vector's type.
+  !* Everything after the index is only shifted once, no matter how many elements you insert.
+  subroutine concurrent_vector_insert_range(this, index, raw_c_pointer, count)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_size_t), intent(in), value :: count
+
+    call this%lock()
+    call this%insert_range_unlocked(index, raw_c_pointer, count)
+    call this%unlock()
+  end subroutine concurrent_vector_insert_range
+
+
+  !* Insert count contiguous elements, starting at raw_c_pointer, into an index of the array.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_insert_range_unlocked(this, index, raw_c_pointer, count)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_size_t), intent(in), value :: count
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size_unlocked() + 1) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call internal_vector_insert_range(this%data, index, raw_c_pointer, count)
+  end subroutine concurrent_vector_insert_range_unlocked
 
 
   !* Remove an element from the vector at an index.
@@ -213,16 +534,69 @@ contains
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: index
 
-    if (index < 1 .or. index > this%size()) then
-      error stop "[Vector] Error: Went out of bounds."
+    call this%lock()
+    call this%remove_unlocked(index)
+    call this%unlock()
+  end subroutine concurrent_vector_remove
+
+
+  !* Remove an element from the vector at an index.
+  !* This will call the GC on the element.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_remove_unlocked(this, index)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size_unlocked()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
     end if
 
-    if (.not. this%is_empty()) then
+    if (.not. this%is_empty_unlocked()) then
       call conc_run_gc(this, index, index)
     end if
 
     call internal_vector_remove(this%data, index)
-  end subroutine concurrent_vector_remove
+  end subroutine concurrent_vector_remove_unlocked
+
+
+  !* Remove all elements from first to last (inclusive) in the vector.
+  !* This will call the GC on each removed element.
+  !* Everything after the range is only shifted once, no matter how many elements you remove.
+  subroutine concurrent_vector_remove_range(this, first, last)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: first, last
+
+    call this%lock()
+    call this%remove_range_unlocked(first, last)
+    call this%unlock()
+  end subroutine concurrent_vector_remove_range
+
+
+  !* Remove all elements from first to last (inclusive) in the vector.
+  !* This will call the GC on each removed element.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_remove_range_unlocked(this, first, last)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: first, last
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (first < 1 .or. last > this%size_unlocked() .or. first > last) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call conc_run_gc(this, first, last)
+
+    call internal_vector_remove_range(this%data, first, last)
+  end subroutine concurrent_vector_remove_range_unlocked
 
 
   !* Uses memcpy under the hood.
@@ -230,36 +604,134 @@ contains
   subroutine concurrent_vector_push_back(this, fortran_data)
     implicit none
 
+    class(concurrent_vec), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+
+    call this%lock()
+    call this%push_back_unlocked(fortran_data)
+    call this%unlock()
+  end subroutine concurrent_vector_push_back
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element to the back of the vector.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_push_back_unlocked(this, fortran_data)
+    implicit none
+
     class(concurrent_vec), intent(inout) :: this
     class(*), intent(in), target :: fortran_data
     type(c_ptr) :: black_magic
 
     black_magic = transfer(loc(fortran_data), black_magic)
 
-    call internal_vector_push_back(this%data, black_magic, this%size_of_type)
-  end subroutine concurrent_vector_push_back
+    call internal_vector_push_back(this%data, black_magic)
+  end subroutine concurrent_vector_push_back_unlocked
 
 
   !* Remove the last element of the vector.
   subroutine concurrent_vector_pop_back(this)
     implicit none
 
+    class(concurrent_vec), intent(inout) :: this
+
+    call this%lock()
+    call this%pop_back_unlocked()
+    call this%unlock()
+  end subroutine concurrent_vector_pop_back
+
+
+  !* Remove the last element of the vector.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_pop_back_unlocked(this)
+    implicit none
+
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t) :: size
 
     !? If it's empty, popping can corrupt the memory.
-    if (this%is_empty()) then
+    if (this%is_empty_unlocked()) then
       return
     end if
 
-    size = this%size()
+    size = this%size_unlocked()
 
-    if (.not. this%is_empty()) then
-      call conc_run_gc(this, size, size)
-    end if
+    call conc_run_gc(this, size, size)
 
     call internal_vector_pop_back(this%data)
-  end subroutine concurrent_vector_pop_back
+  end subroutine concurrent_vector_pop_back_unlocked
+
+
+  !* Move the last element of the vector out into out, and remove it.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  subroutine concurrent_vector_pop_back_into(this, out)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    class(*), intent(inout), target :: out
+
+    call this%lock()
+    call this%pop_back_into_unlocked(out)
+    call this%unlock()
+  end subroutine concurrent_vector_pop_back_into
+
+
+  !* Move the last element of the vector out into out, and remove it.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_pop_back_into_unlocked(this, out)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    if (this%is_empty_unlocked()) then
+      error stop "[Vector] Error: Can't pop from an empty vector."
+    end if
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call internal_vector_pop_back_into(this%data, black_magic)
+  end subroutine concurrent_vector_pop_back_into_unlocked
+
+
+  !* Move the element at index out into out, and remove it from the vector.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  subroutine concurrent_vector_take(this, index, out)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(inout), target :: out
+
+    call this%lock()
+    call this%take_unlocked(index, out)
+    call this%unlock()
+  end subroutine concurrent_vector_take
+
+
+  !* Move the element at index out into out, and remove it from the vector.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_take_unlocked(this, index, out)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size_unlocked()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call internal_vector_take(this%data, index, black_magic)
+  end subroutine concurrent_vector_take_unlocked
 
 
   !* Reserve an internal capacity of the vector.
@@ -269,83 +741,172 @@ contains
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: new_capacity
 
-    call internal_vector_reserve(this%data, new_capacity)
+    call this%lock()
+    call this%reserve_unlocked(new_capacity)
+    call this%unlock()
   end subroutine concurrent_vector_reserve
 
 
+  !* Reserve an internal capacity of the vector.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_reserve_unlocked(this, new_capacity)
+    implicit none
+
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_capacity
+
+    call internal_vector_reserve(this%data, new_capacity)
+  end subroutine concurrent_vector_reserve_unlocked
+
+
   !* Resize a vector to a new size.
   !* Requires a new default element.
+  !* If it shrinks, the GC runs on the elements that get dropped.
   subroutine concurrent_vector_resize(this, new_size, default_element)
     implicit none
 
+    class(concurrent_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_size
+    class(*), intent(in), target :: default_element
+
+    call this%lock()
+    call this%resize_unlocked(new_size, default_element)
+    call this%unlock()
+  end subroutine concurrent_vector_resize
+
+
+  !* Resize a vector to a new size.
+  !* Requires a new default element.
+  !* If it shrinks, the GC runs on the elements that get dropped.
+  !* Does not lock. You must be holding the lock.
+  subroutine concurrent_vector_resize_unlocked(this, new_size, default_element)
+    implicit none
+
     class(concurrent_vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: new_size
     class(*), intent(in), target :: default_element
     type(c_ptr) :: black_magic
 
-    black_magic = transfer(loc(default_element), black_magic)
+    ! Clean up whatever gets dropped off the end.
+    if (new_size < this%size_unlocked()) then
+      call conc_run_gc(this, new_size + 1, this%size_unlocked())
+    end if
 
-    !! FIXME: this will need some in depth analysis of how to GC this.
+    black_magic = transfer(loc(default_element), black_magic)
 
     call internal_vector_resize(this%data, new_size, black_magic)
-  end subroutine concurrent_vector_resize
+  end subroutine concurrent_vector_resize_unlocked
 
 
   !* Swap one vector's contents with another.
   !* If they are not of the same type, this will throw a C exception.
+  !* Both vectors are locked, always in the same order, so two threads swapping
+  !* the same pair of vectors cannot deadlock.
   subroutine concurrent_vector_swap(this, other)
     implicit none
 
     class(concurrent_vec), intent(inout) :: this
     type(concurrent_vec), intent(inout) :: other
+    integer(c_intptr_t) :: this_address, other_address
+
+    this_address = lock_address(this)
+    other_address = lock_address(other)
+
+    if (this_address == other_address) then
+      return
+    end if
+
+    if (this_address < other_address) then
+      call this%lock()
+      call other%lock()
+    else
+      call other%lock()
+      call this%lock()
+    end if
 
     call internal_vector_swap(this%data, other%data)
+
+    call other%unlock()
+    call this%unlock()
   end subroutine concurrent_vector_swap
 
 
-  !* Clone a vector into another one.
-  !* Might want to make sure that it's uninitialized or this might cause issues.
+  !* Clone a vector into another one. Whatever other held is destroyed first.
+  !*
+  !* The clone doesn't get the GC. Its elements are a bytewise copy,
+  !* and this vector still owns whatever they point to.
   subroutine concurrent_vector_clone(this, other)
     implicit none
 
-    class(concurrent_vec), intent(in) :: this
+    class(concurrent_vec), intent(inout) :: this
     type(concurrent_vec), intent(inout) :: other
 
-    call internal_vector_clone(this%data, other%data)
-  end subroutine concurrent_vector_clone
+    call other%destroy()
 
+    call this%lock()
 
-  !* Lock the hashmap mutex.
-  subroutine concurrent_str_hashmap_lock(this)
-    implicit none
+    call internal_vector_clone(this%data, other%data)
 
-    class(concurrent_vec), intent(inout) :: this
-    integer(c_int) :: status
+    other%size_of_type = this%size_of_type
+    other%gc_func = c_null_funptr
+    other%gc_range_func = c_null_funptr
+    other%time_lock = this%time_lock
 
-    status = thread_lock_mutex(this%mutex)
-  end subroutine concurrent_str_hashmap_lock
+    call this%unlock()
+
+    ! The clone gets its own lock, of the same kind.
+    if (c_associated(this%rwlock)) then
+      if (.not. c_associated(other%rwlock)) then
+        other%rwlock = internal_vector_rwlock_create()
+      end if
+    else if (.not. c_associated(other%mutex)) then
+      other%mutex = thread_create_mutex()
+    end if
+  end subroutine concurrent_vector_clone
 
 
-  !* Unlock the hashmap mutex.
-  subroutine concurrent_str_hashmap_unlock(this)
+  !* Get what this vector has counted so far.
+  !* Everything is 0 if stats are off. (See stats_name in new_concurrent_vec)
+  function concurrent_vector_stats(this) result(stats)
     implicit none
 
     class(concurrent_vec), intent(inout) :: this
-    integer(c_int) :: status
+    type(vec_stats) :: stats
+    logical(c_bool) :: enabled
 
-    status = thread_unlock_mutex(this%mutex)
-  end subroutine concurrent_str_hashmap_unlock
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call this%lock_shared()
+    enabled = internal_vector_stats(this%data, stats)
+    call this%unlock()
+  end function concurrent_vector_stats
 
 
 !? BEGIN INTERNAL ONLY ==============================================
 
+  !* The caller must be holding the lock.
   subroutine conc_run_gc(this, min, max)
     implicit none
 
     type(concurrent_vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: min, max
     procedure(vec_gc_blueprint), pointer :: optional_gc
+    procedure(vec_gc_range_blueprint), pointer :: optional_gc_range
     integer(c_size_t) :: i
+    integer(c_intptr_t) :: address
+
+    if (max < min) then
+      return
+    end if
+
+    if (c_associated(this%gc_range_func)) then
+      call c_f_procpointer(this%gc_range_func, optional_gc_range)
+      call optional_gc_range(internal_vector_get(this%data, min), (max - min) + 1, this%size_of_type)
+      call internal_vector_stats_record_gc_calls(this%data, (max - min) + 1)
+      return
+    end if
 
     ! No GC function was assigned to the vector.
     if (.not. c_associated(this%gc_func)) then
@@ -354,9 +915,30 @@ contains
 
     call c_f_procpointer(this%gc_func, optional_gc)
 
+    ! The elements are contiguous, so only ask C where the first one is.
+    address = transfer(internal_vector_get(this%data, min), address)
+
     do i = min, max
-      call optional_gc(this%get(i))
+      call optional_gc(transfer(address, c_null_ptr))
+      address = address + int(this%size_of_type, c_intptr_t)
     end do
+
+    call internal_vector_stats_record_gc_calls(this%data, (max - min) + 1)
   end subroutine conc_run_gc
 
+
+  !* Get the address of whichever lock the vector uses, for lock ordering.
+  function lock_address(this) result(address)
+    implicit none
+
+    type(concurrent_vec), intent(in) :: this
+    integer(c_intptr_t) :: address
+
+    if (c_associated(this%rwlock)) then
+      address = transfer(this%rwlock, address)
+    else
+      address = transfer(this%mutex, address)
+    end if
+  end function lock_address
+
 end module concurrent_vector
@@ -0,0 +1,62 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * The global state behind cvector.h, by jordan4ibanez.
+ *
+ * This is the only translation unit that has the global allocator, so setting it
+ * from anywhere changes it for everyone.
+ */
+
+#include <stdlib.h>
+#include "cvector.h"
+
+static void *cvector_malloc_allocate(size_t size, void *user_data)
+{
+    (void)user_data;
+    return malloc(size);
+}
+
+static void *cvector_malloc_reallocate(void *memory, size_t old_size, size_t new_size, void *user_data)
+{
+    (void)old_size;
+    (void)user_data;
+    return realloc(memory, new_size);
+}
+
+static void cvector_malloc_free(void *memory, size_t size, void *user_data)
+{
+    (void)size;
+    (void)user_data;
+    free(memory);
+}
+
+// The C library allocator.
+static const cvector_allocator CVECTOR_MALLOC_ALLOCATOR = {
+    cvector_malloc_allocate,
+    cvector_malloc_reallocate,
+    cvector_malloc_free,
+    NULL,
+};
+
+// What cvector_init uses when it isn't given an allocator.
+static const cvector_allocator *cvector_global_allocator = &CVECTOR_MALLOC_ALLOCATOR;
+
+/**
+ * @brief cvector_set_global_allocator - sets the allocator new vectors get when they aren't given one
+ * Existing vectors keep the allocator they were created with.
+ * @param allocator - the allocator, or NULL to go back to malloc
+ * @return void
+ */
+void cvector_set_global_allocator(const cvector_allocator *allocator)
+{
+    cvector_global_allocator = allocator ? allocator : &CVECTOR_MALLOC_ALLOCATOR;
+}
+
+/**
+ * @brief cvector_get_global_allocator - gets the allocator new vectors get when they aren't given one
+ * @return the allocator
+ */
+const cvector_allocator *cvector_get_global_allocator()
+{
+    return cvector_global_allocator;
+}
@@ -9,58 +9,245 @@
 #ifndef CVECTOR_H_
 #define CVECTOR_H_
 
-/* cvector heap implemented using C library malloc() */
+/* cvector heap implemented using C library malloc() by default, or any cvector_allocator */
+
+/*
+ * Everything in here is static inline, so the compiler folds these straight into the
+ * shims in fortran_vector.c, and with -flto the shims can be inlined into the Fortran
+ * that calls them. (See make release_lto)
+ *
+ * The global allocator is the only state, and it lives in cvector.c, so any number of
+ * translation units can include this and still share it.
+ */
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <assert.h>
 #include <inttypes.h>
 #include <string.h>
+#include <sched.h>
+#include "cvector_stats.h"
 
 // Forward declaration.
 typedef struct cvector_header cvector_header;
+typedef struct cvector_allocator cvector_allocator;
+
+static inline size_t cvector_capacity(char *vec);
+static inline size_t cvector_size(char *vec);
+static inline size_t cvector_element_size(char *vec);
+
+static inline bool cvector_empty(char *vec);
+static inline void cvector_reserve(char **vec, size_t new_capacity);
+static inline char *cvector_init(size_t capacity, size_t element_size, const cvector_allocator *allocator,
+                                 size_t alignment);
+static inline size_t cvector_alignment(char *vec);
+static inline size_t cvector_block_size(char *vec);
+static inline char *cvector_block(char *vec);
+static inline const cvector_allocator *cvector_allocator_of(char *vec);
+void cvector_set_global_allocator(const cvector_allocator *allocator);
+const cvector_allocator *cvector_get_global_allocator();
+static inline void cvector_remove(char *vec, size_t index);
+static inline void cvector_remove_range(char *vec, size_t index, size_t count);
+static inline void cvector_clear(char *vec);
+static inline void cvector_free(char *vec);
+static inline size_t cvector_compute_next_grow(char *vec, size_t required_capacity);
+static inline void cvector_set_growth_policy(char *vec, size_t policy, size_t amount);
+static inline void cvector_push_back(char **vec, char *value);
+static inline void cvector_push_back_array(char **vec, char *values, size_t count);
+static inline char *cvector_emplace_back(char **vec, size_t count);
+static inline void cvector_insert(char **vec, size_t pos, char *fortran_data);
+static inline void cvector_insert_range(char **vec, size_t index, char *values, size_t count);
+static inline void cvector_pop_back(char *vec);
+static inline void cvector_take(char *vec, size_t index, char *out);
+static inline void cvector_pop_back_into(char *vec, char *out);
+static inline void cvector_clone(char *from, char **to);
+static inline char *cvector_share(char *vec);
+static inline bool cvector_is_shared(char *vec);
+static inline void cvector_unshare(char **vec);
+static inline void cvector_swap(char **vec, char **other);
+static inline void cvector_set_capacity(char *vec, size_t size);
+static inline void cvector_set_size(char *vec, size_t _size);
+static inline void cvector_grow(char **vec, size_t count);
+static inline void cvector_shrink_to_fit(char **vec);
+static inline char *cvector_get(char *vec, size_t index);
+static inline char *cvector_data(char *vec);
+static inline void cvector_set(char *vec, size_t index, void *fortran_data);
+static inline char *cvector_front(char *vec);
+static inline char *cvector_back(char *vec);
+static inline void cvector_resize(char **vec, size_t count, char *value);
+static inline size_t cvector_atomic_reserve(size_t *counter, size_t count);
+static inline size_t cvector_atomic_load(size_t *counter);
+static inline void cvector_atomic_publish(size_t *published, size_t first, size_t count);
+static inline void cvector_enable_stats(char *vec, const char *name);
+static inline cvector_stats *cvector_stats_of(char *vec);
 
-size_t cvector_capacity(char *vec);
-size_t cvector_size(char *vec);
-size_t cvector_element_size(char *vec);
-
-bool cvector_empty(char *vec);
-void cvector_reserve(char **vec, size_t new_capacity);
-char *cvector_init(size_t capacity, size_t element_size);
-void cvector_remove(char *vec, size_t index);
-void cvector_clear(char *vec);
-void cvector_free(char *vec);
-size_t cvector_compute_next_grow(size_t size);
-void cvector_push_back(char **vec, char *value);
-void cvector_insert(char **vec, size_t pos, char *fortran_data);
-void cvector_pop_back(char *vec);
-void cvector_clone(char *from, char **to);
-void cvector_swap(char **vec, char **other);
-void cvector_set_capacity(char *vec, size_t size);
-void cvector_set_size(char *vec, size_t _size);
-void cvector_grow(char **vec, size_t count);
-void cvector_shrink_to_fit(char **vec);
-char *cvector_get(char *vec, size_t index);
-void cvector_set(char *vec, size_t index, void *fortran_data);
-char *cvector_front(char *vec);
-char *cvector_back(char *vec);
-void cvector_resize(char **vec, size_t count, char *value);
+/**
+ * A table of memory functions a vector uses for its heap block.
+ * user_data is handed back to every function, so one table can serve an arena, a pool, etc.
+ * The old/current block size is always passed in, so allocators don't need to track it.
+ */
+struct cvector_allocator
+{
+    void *(*allocate)(size_t size, void *user_data);
+    void *(*reallocate)(void *memory, size_t old_size, size_t new_size, void *user_data);
+    void (*free)(void *memory, size_t size, void *user_data);
+    void *user_data;
+};
 
 struct cvector_header
 {
     size_t size;
     size_t capacity;
     size_t element_size;
+    const cvector_allocator *allocator;
+    // Element 1 starts on a multiple of this. 0 means whatever the allocator gives.
+    uint32_t alignment;
+    // How far the header was pushed into the heap block to align the elements.
+    uint32_t block_offset;
+    // Elements, for the policies that need a number.
+    size_t growth_amount;
+    // One of cvector_growth_policy.
+    uint32_t growth_policy;
+    // How many owners share this memory. Only touched atomically. (See cvector_share)
+    uint32_t reference_count;
+    // NULL unless stats were turned on. (See cvector_enable_stats)
+    cvector_stats *stats;
+};
+
+/**
+ * How a vector picks its next capacity when it runs out of room.
+ */
+enum cvector_growth_policy
+{
+    // Capacity * 2.
+    CVECTOR_GROWTH_DOUBLE = 0,
+    // Capacity * 1.5. Wastes at most a third at the moment of reallocation.
+    CVECTOR_GROWTH_FACTOR_1_5 = 1,
+    // Capacity + growth_amount.
+    CVECTOR_GROWTH_CHUNK = 2,
+    // Capacity * 2, but never more than growth_amount elements at once.
+    CVECTOR_GROWTH_CAPPED = 3,
 };
 
 // Cache this.
 const static size_t HEADER_SIZE = sizeof(cvector_header);
 
+/**
+ * @brief cvector_alignment_padding - For internal use, the extra bytes a block needs so it can always be aligned
+ * @internal
+ */
+static inline size_t cvector_alignment_padding(size_t alignment)
+{
+    return alignment > 1 ? alignment - 1 : 0;
+}
+
+/**
+ * @brief cvector_offset_for_block - For internal use, how far into a block the header must go to align the elements
+ * @internal
+ */
+static inline size_t cvector_offset_for_block(char *block, size_t alignment)
+{
+    if (alignment <= 1)
+    {
+        return 0;
+    }
+
+    const uintptr_t elements = (uintptr_t)(block + HEADER_SIZE);
+
+    return (alignment - (elements % alignment)) % alignment;
+}
+
+/**
+ * @brief cvector_heap_size - For internal use, the size of the heap block for a capacity
+ * @internal
+ */
+static inline size_t cvector_heap_size(size_t capacity, size_t element_size, size_t alignment)
+{
+    return HEADER_SIZE + (capacity * element_size) + cvector_alignment_padding(alignment);
+}
+
+/**
+ * @brief cvector_repeat - For internal use, writes count copies of value starting at first
+ * Copies the value in once, then keeps doubling what's already filled in.
+ * So it's log(n) memcpy calls instead of n.
+ * @internal
+ */
+static inline void cvector_repeat(char *first, const char *value, size_t element_size, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t total = count * element_size;
+
+    memcpy(first, value, element_size);
+
+    size_t filled = element_size;
+
+    while (filled < total)
+    {
+        const size_t chunk = (total - filled) < filled ? (total - filled) : filled;
+        memcpy(first + filled, first, chunk);
+        filled += chunk;
+    }
+}
+
+/**
+ * @brief cvector_alignment - gets the alignment of the elements
+ * @param vec - the vector
+ * @return the alignment in bytes, 0 if it was left to the allocator
+ */
+static inline size_t cvector_alignment(char *vec)
+{
+    assert(vec);
+
+    return ((cvector_header *)vec)->alignment;
+}
+
+/**
+ * @brief cvector_block - gets the start of the heap block the vector lives in
+ * This is what the allocator handed out, the header may sit a few bytes after it.
+ * @param vec - the vector
+ * @return the heap block
+ */
+static inline char *cvector_block(char *vec)
+{
+    assert(vec);
+
+    return vec - ((cvector_header *)vec)->block_offset;
+}
+
+/**
+ * @brief cvector_block_size - gets the size of the heap block the vector lives in
+ * @param vec - the vector
+ * @return the size in bytes
+ */
+static inline size_t cvector_block_size(char *vec)
+{
+    assert(vec);
+
+    return cvector_heap_size(cvector_capacity(vec), cvector_element_size(vec), cvector_alignment(vec));
+}
+
+/**
+ * @brief cvector_allocator_of - gets the allocator that owns a vector's memory
+ * @param vec - the vector
+ * @return the allocator
+ */
+static inline const cvector_allocator *cvector_allocator_of(char *vec)
+{
+    assert(vec);
+
+    return ((cvector_header *)vec)->allocator;
+}
+
 /**
  * @brief cvector_capacity - gets the current capacity of the vector
  * @param vec - the vector
  * @return the capacity as a size_t
  */
-size_t cvector_capacity(char *vec)
+static inline size_t cvector_capacity(char *vec)
 {
     assert(vec);
 
@@ -72,7 +259,7 @@ size_t cvector_capacity(char *vec)
  * @param vec - the vector
  * @return the size as a size_t
  */
-size_t cvector_size(char *vec)
+static inline size_t cvector_size(char *vec)
 {
     assert(vec);
 
@@ -84,7 +271,7 @@ size_t cvector_size(char *vec)
  * @param vec - the vector
  * @return the size as a size_t
  */
-size_t cvector_element_size(char *vec)
+static inline size_t cvector_element_size(char *vec)
 {
 
     assert(vec);
@@ -97,7 +284,7 @@ size_t cvector_element_size(char *vec)
  * @param vec - the vector
  * @return non-zero if empty, zero if non-empty
  */
-bool cvector_empty(char *vec)
+static inline bool cvector_empty(char *vec)
 {
     return cvector_size(vec) == 0;
 }
@@ -111,7 +298,7 @@ bool cvector_empty(char *vec)
  * @param new_capacity - Minimum capacity for the vector.
  * @return void
  */
-void cvector_reserve(char **vec, size_t new_capacity)
+static inline void cvector_reserve(char **vec, size_t new_capacity)
 {
     if (cvector_capacity(*vec) < new_capacity)
     {
@@ -122,21 +309,41 @@ void cvector_reserve(char **vec, size_t new_capacity)
 /**
  * @brief cvector_init - Initialize a vector.  The vector must be NULL for this to do anything.
  * @param capacity - vector capacity to reserve
+ * @param element_size - the size of the elements
+ * @param allocator - the allocator for the vector's memory, or NULL for the global allocator
+ * @param alignment - a power of 2 that element 1 will be aligned to (e.g. 32 for AVX, 64 for a cache line), or 0
  * @return void
  */
-char *cvector_init(size_t capacity, size_t element_size)
+static inline char *cvector_init(size_t capacity, size_t element_size, const cvector_allocator *allocator,
+                                 size_t alignment)
 {
-    char *vec = malloc(HEADER_SIZE);
+    // Must be a power of 2, and fit in the header.
+    assert((alignment & (alignment - 1)) == 0);
+    assert(alignment <= UINT32_MAX);
 
-    ((cvector_header *)vec)->capacity = 0;
-    ((cvector_header *)vec)->size = 0;
-    ((cvector_header *)vec)->element_size = element_size;
-
-    if (!vec)
+    if (!allocator)
     {
-        cvector_reserve(&vec, capacity);
+        allocator = cvector_get_global_allocator();
     }
 
+    // The initial capacity comes in the same allocation, so the first push_back doesn't reallocate.
+    char *block = allocator->allocate(cvector_heap_size(capacity, element_size, alignment), allocator->user_data);
+    assert(block);
+
+    const size_t block_offset = cvector_offset_for_block(block, alignment);
+    char *vec = block + block_offset;
+
+    ((cvector_header *)vec)->capacity = capacity;
+    ((cvector_header *)vec)->size = 0;
+    ((cvector_header *)vec)->element_size = element_size;
+    ((cvector_header *)vec)->allocator = allocator;
+    ((cvector_header *)vec)->alignment = (uint32_t)alignment;
+    ((cvector_header *)vec)->block_offset = (uint32_t)block_offset;
+    ((cvector_header *)vec)->growth_policy = CVECTOR_GROWTH_DOUBLE;
+    ((cvector_header *)vec)->growth_amount = 0;
+    ((cvector_header *)vec)->reference_count = 1;
+    ((cvector_header *)vec)->stats = NULL;
+
     return vec;
 }
 
@@ -146,7 +353,7 @@ char *cvector_init(size_t capacity, size_t element_size)
  * @param index - index of element to remove
  * @return void
  */
-void cvector_remove(char *vec, size_t index)
+static inline void cvector_remove(char *vec, size_t index)
 {
     // Null pointer.
     if (!vec)
@@ -172,6 +379,49 @@ void cvector_remove(char *vec, size_t index)
     const size_t length = (new_size - index) * element_size;
 
     memmove(min, max, length);
+
+    if (((cvector_header *)vec)->stats)
+    {
+        cvector_stats_record_memmove(((cvector_header *)vec)->stats, length);
+    }
+}
+
+/**
+ * @brief cvector_remove_range - removes count elements starting at index i from the vector
+ * The tail of the vector is shifted down with a single memmove.
+ * @param vec - the vector
+ * @param index - index of the first element to remove
+ * @param count - the number of elements to remove
+ * @return void
+ */
+static inline void cvector_remove_range(char *vec, size_t index, size_t count)
+{
+    // Null pointer.
+    if (!vec)
+    {
+        return;
+    }
+    const size_t vector_size = cvector_size(vec);
+
+    // Out of bounds.
+    if (count == 0 || index >= vector_size || count > vector_size - index)
+    {
+        return;
+    }
+
+    const size_t new_size = vector_size - count;
+    cvector_set_size(vec, new_size);
+    const size_t element_size = cvector_element_size(vec);
+    char *min = vec + HEADER_SIZE + (index * element_size);
+    const char *max = min + (count * element_size);
+    const size_t length = (new_size - index) * element_size;
+
+    memmove(min, max, length);
+
+    if (((cvector_header *)vec)->stats)
+    {
+        cvector_stats_record_memmove(((cvector_header *)vec)->stats, length);
+    }
 }
 
 /**
@@ -179,7 +429,7 @@ void cvector_remove(char *vec, size_t index)
  * @param vec - the vector
  * @return void
  */
-void cvector_clear(char *vec)
+static inline void cvector_clear(char *vec)
 {
     assert(vec);
 
@@ -191,29 +441,90 @@ void cvector_clear(char *vec)
  * @param vec - the vector
  * @return void
  */
-void cvector_free(char *vec)
+static inline void cvector_free(char *vec)
 {
     assert(vec);
 
-    free(vec);
+    uint32_t *reference_count = &((cvector_header *)vec)->reference_count;
+
+    // A sole owner never writes the count, so read only memory can be freed too.
+    // Otherwise, whoever lets go last frees it.
+    if (__atomic_load_n(reference_count, __ATOMIC_ACQUIRE) > 1 &&
+        __atomic_sub_fetch(reference_count, 1, __ATOMIC_ACQ_REL) > 0)
+    {
+        return;
+    }
+
+    if (((cvector_header *)vec)->stats)
+    {
+        cvector_stats_destroy(((cvector_header *)vec)->stats);
+    }
+
+    const cvector_allocator *allocator = cvector_allocator_of(vec);
+
+    allocator->free(cvector_block(vec), cvector_block_size(vec), allocator->user_data);
+}
+
+/**
+ * @brief cvector_set_growth_policy - chooses how the vector grows when it runs out of room
+ * @param vec - the vector
+ * @param policy - one of cvector_growth_policy
+ * @param amount - the chunk size or cap in elements, for CVECTOR_GROWTH_CHUNK and CVECTOR_GROWTH_CAPPED
+ * @return void
+ */
+static inline void cvector_set_growth_policy(char *vec, size_t policy, size_t amount)
+{
+    assert(vec);
+    assert(policy <= CVECTOR_GROWTH_CAPPED);
+    assert(policy < CVECTOR_GROWTH_CHUNK || amount > 0);
+
+    ((cvector_header *)vec)->growth_policy = policy;
+    ((cvector_header *)vec)->growth_amount = amount;
 }
 
 /**
  * @brief cvector_compute_next_grow - returns an the computed size in next vector grow
- * size is increased by multiplication of 2
- * @param size - current size
- * @return size after next vector grow
+ * The growth policy of the vector is applied once to the current capacity.
+ * If that's still not enough, it grows straight to required_capacity.
+ * @param vec - the vector
+ * @param required_capacity - the capacity that is needed
+ * @return capacity after next vector grow
  */
-size_t cvector_compute_next_grow(size_t size)
+static inline size_t cvector_compute_next_grow(char *vec, size_t required_capacity)
 {
-    if (size)
+    assert(vec);
+
+    const size_t capacity = cvector_capacity(vec);
+    const size_t amount = ((cvector_header *)vec)->growth_amount;
+    size_t next = capacity;
+
+    switch (((cvector_header *)vec)->growth_policy)
     {
-        return size << 1;
+    case CVECTOR_GROWTH_FACTOR_1_5:
+        next = capacity + (capacity >> 1);
+        break;
+    case CVECTOR_GROWTH_CHUNK:
+        next = capacity + amount;
+        break;
+    case CVECTOR_GROWTH_CAPPED:
+        next = capacity + (capacity < amount ? capacity : amount);
+        break;
+    default:
+        next = capacity << 1;
+        break;
     }
-    else
+
+    if (next <= capacity)
+    {
+        next = capacity + 1;
+    }
+
+    if (next < required_capacity)
     {
-        return 1;
+        next = required_capacity;
     }
+
+    return next;
 }
 
 /**
@@ -222,14 +533,14 @@ size_t cvector_compute_next_grow(size_t size)
  * @param value - the value to add
  * @return void
  */
-void cvector_push_back(char **vec, char *value)
+static inline void cvector_push_back(char **vec, char *value)
 {
 
     size_t current_capacity = cvector_capacity(*vec);
 
     if (current_capacity <= cvector_size(*vec))
     {
-        cvector_grow(vec, cvector_compute_next_grow(current_capacity));
+        cvector_grow(vec, cvector_compute_next_grow(*vec, cvector_size(*vec) + 1));
     }
 
     char *current_element = *vec + HEADER_SIZE + (cvector_element_size(*vec) * cvector_size(*vec));
@@ -238,6 +549,64 @@ void cvector_push_back(char **vec, char *value)
     cvector_set_size(*vec, cvector_size(*vec) + 1);
 }
 
+/**
+ * @brief cvector_push_back_array - adds count contiguous elements to the end of the vector
+ * The vector is grown at most once and the whole block is copied with a single memcpy.
+ * @param vec - the vector
+ * @param values - pointer to the first of the contiguous elements to add
+ * @param count - the number of elements to add
+ * @return void
+ */
+static inline void cvector_push_back_array(char **vec, char *values, size_t count)
+{
+    assert(*vec);
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t current_size = cvector_size(*vec);
+    const size_t required_capacity = current_size + count;
+    const size_t current_capacity = cvector_capacity(*vec);
+
+    // Reserve once for the whole block.
+    if (current_capacity < required_capacity)
+    {
+        cvector_grow(vec, cvector_compute_next_grow(*vec, required_capacity));
+    }
+
+    const size_t element_size = cvector_element_size(*vec);
+
+    memcpy(*vec + HEADER_SIZE + (element_size * current_size), values, element_size * count);
+    cvector_set_size(*vec, required_capacity);
+}
+
+/**
+ * @brief cvector_emplace_back - adds count uninitialized elements to the end of the vector
+ * Nothing is copied in. Write the elements straight into the slots it gives back.
+ * The vector is grown at most once.
+ * @param vec - the vector
+ * @param count - the number of elements to add
+ * @return the first new slot, only good until the vector grows again
+ */
+static inline char *cvector_emplace_back(char **vec, size_t count)
+{
+    assert(*vec);
+
+    const size_t current_size = cvector_size(*vec);
+    const size_t required_capacity = current_size + count;
+
+    if (cvector_capacity(*vec) < required_capacity)
+    {
+        cvector_grow(vec, cvector_compute_next_grow(*vec, required_capacity));
+    }
+
+    cvector_set_size(*vec, required_capacity);
+
+    return *vec + HEADER_SIZE + (cvector_element_size(*vec) * current_size);
+}
+
 /**
  * @brief cvector_insert - insert element at index pos to the vector
  * @param vec - the vector
@@ -245,7 +614,7 @@ void cvector_push_back(char **vec, char *value)
  * @param fortran_data - value to be copied (or moved) to the inserted elements.
  * @return void
  */
-void cvector_insert(char **vec, size_t index, char *fortran_data)
+static inline void cvector_insert(char **vec, size_t index, char *fortran_data)
 {
 
     assert(*vec);
@@ -254,7 +623,7 @@ void cvector_insert(char **vec, size_t index, char *fortran_data)
 
     if (vec_capacity <= cvector_size(*vec))
     {
-        cvector_grow(vec, cvector_compute_next_grow(vec_capacity));
+        cvector_grow(vec, cvector_compute_next_grow(*vec, cvector_size(*vec) + 1));
     }
 
     size_t current_size = cvector_size(*vec);
@@ -269,43 +638,218 @@ void cvector_insert(char **vec, size_t index, char *fortran_data)
         const size_t length = (current_size - index) * element_size;
 
         memmove(max, min, length);
+
+        if (((cvector_header *)*vec)->stats)
+        {
+            cvector_stats_record_memmove(((cvector_header *)*vec)->stats, length);
+        }
     }
 
     memcpy(*vec + HEADER_SIZE + (element_size * index), fortran_data, element_size);
     cvector_set_size(*vec, current_size + 1);
 }
 
+/**
+ * @brief cvector_insert_range - insert count contiguous elements at index pos to the vector
+ * The vector is grown at most once and the tail is shifted forwards with a single memmove.
+ * @param vec - the vector
+ * @param index - index in the vector where the new elements are inserted.
+ * @param values - pointer to the first of the contiguous elements to be copied in.
+ * @param count - the number of elements to insert.
+ * @return void
+ */
+static inline void cvector_insert_range(char **vec, size_t index, char *values, size_t count)
+{
+    assert(*vec);
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t current_size = cvector_size(*vec);
+    const size_t required_capacity = current_size + count;
+    const size_t vec_capacity = cvector_capacity(*vec);
+
+    assert(index <= current_size);
+
+    if (vec_capacity < required_capacity)
+    {
+        cvector_grow(vec, cvector_compute_next_grow(*vec, required_capacity));
+    }
+
+    const size_t element_size = cvector_element_size(*vec);
+    char *min = *vec + HEADER_SIZE + (index * element_size);
+
+    // If we're inserting into the middle, shove everything forwards in one go.
+    if (index < current_size)
+    {
+        char *max = min + (count * element_size);
+        const size_t length = (current_size - index) * element_size;
+
+        memmove(max, min, length);
+
+        if (((cvector_header *)*vec)->stats)
+        {
+            cvector_stats_record_memmove(((cvector_header *)*vec)->stats, length);
+        }
+    }
+
+    memcpy(min, values, count * element_size);
+    cvector_set_size(*vec, required_capacity);
+}
+
+/**
+ * @brief cvector_take - moves the element at index out of the vector
+ * The bytes are copied into out, and the element is removed, but never cleaned up.
+ * So whatever it owns belongs to the caller now.
+ * @param vec - the vector
+ * @param index - index of the element
+ * @param out - where the element goes, element_size bytes
+ * @return void
+ */
+static inline void cvector_take(char *vec, size_t index, char *out)
+{
+    assert(vec);
+    assert(index < cvector_size(vec));
+
+    memcpy(out, vec + HEADER_SIZE + (index * cvector_element_size(vec)), cvector_element_size(vec));
+
+    cvector_remove(vec, index);
+}
+
+/**
+ * @brief cvector_pop_back_into - moves the last element out of the vector
+ * Same as cvector_take on the last element, without any shifting.
+ * @param vec - the vector
+ * @param out - where the element goes, element_size bytes
+ * @return void
+ */
+static inline void cvector_pop_back_into(char *vec, char *out)
+{
+    assert(vec);
+    assert(cvector_size(vec) > 0);
+
+    memcpy(out, cvector_back(vec), cvector_element_size(vec));
+
+    cvector_pop_back(vec);
+}
+
 /**
  * @brief cvector_pop_back - removes the last element from the vector
  * @param vec - the vector
  * @return void
  */
-void cvector_pop_back(char *vec)
+static inline void cvector_pop_back(char *vec)
 {
     cvector_set_size(vec, cvector_size(vec) - 1);
 }
 
 /**
- * @brief cvector_clone - copy a vector
- * @param from - the original vector
- * @param to - destination to which the function copy to
- * @return void
+ * @brief cvector_copy - For internal use, a new vector with the same elements, in memory of its own
+ * Only the elements are copied, not the spare capacity after them.
+ * @internal
  */
-void cvector_clone(char *from, char **to)
+static inline char *cvector_copy(char *from, size_t capacity)
 {
+    const cvector_allocator *allocator = cvector_allocator_of(from);
+    const size_t alignment = cvector_alignment(from);
+    const size_t size = cvector_size(from);
+
+    assert(capacity >= size);
+
+    char *block = allocator->allocate(cvector_heap_size(capacity, cvector_element_size(from), alignment), allocator->user_data);
+    assert(block);
+
+    // The new block may need a different offset to keep the same alignment.
+    const size_t block_offset = cvector_offset_for_block(block, alignment);
+    char *to = block + block_offset;
 
+    memcpy(to, from, HEADER_SIZE + (size * cvector_element_size(from)));
+
+    ((cvector_header *)to)->capacity = capacity;
+    ((cvector_header *)to)->block_offset = (uint32_t)block_offset;
+    ((cvector_header *)to)->reference_count = 1;
+
+    // The copy is a vector of its own now, so it gets its own counters, under the same name.
+    if (((cvector_header *)from)->stats)
+    {
+        const cvector_stats *stats = ((cvector_header *)from)->stats;
+        ((cvector_header *)to)->stats = cvector_stats_create(stats->name, stats->element_size, capacity);
+    }
+
+    return to;
+}
+
+/**
+ * @brief cvector_clone - copies a vector into memory of its own
+ * The clone's capacity is exactly its size.
+ * @param from - the vector
+ * @param to - a reference to where the clone goes, it must be NULL
+ * @return void
+ */
+static inline void cvector_clone(char *from, char **to)
+{
     // Can't copy from a null pointer.
     assert(from);
 
     // If it's initialized, completely bail out.
     assert(*to == NULL);
 
-    // We're literally going to pure copy it.
-    const size_t heap_size = HEADER_SIZE + (cvector_capacity(from) * cvector_element_size(from));
+    *to = cvector_copy(from, cvector_size(from));
+}
+
+/**
+ * @brief cvector_share - adds an owner to a vector's memory, for copy on write
+ * Both owners see the same elements until one of them calls cvector_unshare.
+ * Every owner frees it with cvector_free, and the memory goes away with the last one.
+ * @param vec - the vector
+ * @return the same vector, for the new owner
+ */
+static inline char *cvector_share(char *vec)
+{
+    assert(vec);
+
+    __atomic_add_fetch(&((cvector_header *)vec)->reference_count, 1, __ATOMIC_RELAXED);
+
+    return vec;
+}
+
+/**
+ * @brief cvector_is_shared - checks if more than one owner has a vector's memory
+ * @param vec - the vector
+ * @return if it's shared
+ */
+static inline bool cvector_is_shared(char *vec)
+{
+    assert(vec);
+
+    return __atomic_load_n(&((cvector_header *)vec)->reference_count, __ATOMIC_ACQUIRE) > 1;
+}
+
+/**
+ * @brief cvector_unshare - gives this owner a copy of its own, if the memory is shared
+ * Call this before changing a shared vector. The other owners keep the old memory.
+ * @param vec - a reference to the vector, it will move if it was shared
+ * @return void
+ */
+static inline void cvector_unshare(char **vec)
+{
+    assert(vec);
+    assert(*vec);
+
+    if (!cvector_is_shared(*vec))
+    {
+        return;
+    }
 
-    *to = malloc(heap_size);
+    // Keep the capacity, the write that made us unshare is probably about to use it.
+    char *copy = cvector_copy(*vec, cvector_capacity(*vec));
 
-    memcpy(*to, from, heap_size);
+    // If the others let go in the meantime, this frees it.
+    cvector_free(*vec);
+
+    *vec = copy;
 }
 
 /**
@@ -315,7 +859,7 @@ void cvector_clone(char *from, char **to)
  * @param type - the type of both vectors
  * @return void
  */
-void cvector_swap(char **vec, char **other)
+static inline void cvector_swap(char **vec, char **other)
 {
     assert(*vec);
 
@@ -336,7 +880,7 @@ void cvector_swap(char **vec, char **other)
  * @return void
  * @internal
  */
-void cvector_set_capacity(char *vec, size_t new_capacity)
+static inline void cvector_set_capacity(char *vec, size_t new_capacity)
 {
     assert(vec);
 
@@ -350,7 +894,7 @@ void cvector_set_capacity(char *vec, size_t new_capacity)
  * @return void
  * @internal
  */
-void cvector_set_size(char *vec, size_t new_size)
+static inline void cvector_set_size(char *vec, size_t new_size)
 {
     assert(vec);
 
@@ -364,11 +908,36 @@ void cvector_set_size(char *vec, size_t new_size)
  * @return void
  * @internal
  */
-void cvector_grow(char **vec, size_t new_capacity)
+static inline void cvector_grow(char **vec, size_t new_capacity)
 {
-    const size_t NEW_SIZE = HEADER_SIZE + (new_capacity * cvector_element_size(*vec));
-    char *temp = realloc(*vec, NEW_SIZE);
-    assert(temp);
+    if (((cvector_header *)*vec)->stats && new_capacity > cvector_capacity(*vec))
+    {
+        // Whatever is in use has to survive the reallocation, wherever it lands.
+        cvector_stats_record_grow(((cvector_header *)*vec)->stats,
+                                  HEADER_SIZE + (cvector_size(*vec) * cvector_element_size(*vec)), new_capacity);
+    }
+
+    const cvector_allocator *allocator = cvector_allocator_of(*vec);
+    const size_t alignment = cvector_alignment(*vec);
+    const size_t old_offset = ((cvector_header *)*vec)->block_offset;
+    const size_t OLD_SIZE = cvector_block_size(*vec);
+    const size_t NEW_SIZE = cvector_heap_size(new_capacity, cvector_element_size(*vec), alignment);
+    char *block = allocator->reallocate(cvector_block(*vec), OLD_SIZE, NEW_SIZE, allocator->user_data);
+    assert(block);
+
+    char *temp = block + old_offset;
+
+    // The allocator may have moved us somewhere with a different alignment, so slide everything over.
+    const size_t new_offset = cvector_offset_for_block(block, alignment);
+
+    if (new_offset != old_offset)
+    {
+        char *moved = block + new_offset;
+        memmove(moved, temp, HEADER_SIZE + (cvector_size(temp) * cvector_element_size(temp)));
+        ((cvector_header *)moved)->block_offset = (uint32_t)new_offset;
+        temp = moved;
+    }
+
     cvector_set_capacity(temp, new_capacity);
 
     *vec = temp;
@@ -379,7 +948,7 @@ void cvector_grow(char **vec, size_t new_capacity)
  * @param vec - the vector
  * @return void
  */
-void cvector_shrink_to_fit(char **vec)
+static inline void cvector_shrink_to_fit(char **vec)
 {
     assert(*vec);
 
@@ -394,7 +963,7 @@ void cvector_shrink_to_fit(char **vec)
  * @param index - index of an element in the vector.
  * @return the element at the specified index in the vector.
  */
-char *cvector_get(char *vec, size_t index)
+static inline char *cvector_get(char *vec, size_t index)
 {
     assert(vec);
 
@@ -408,14 +977,26 @@ char *cvector_get(char *vec, size_t index)
     }
 }
 
+/**
+ * @brief cvector_data - returns a pointer to the first element's memory, even if the vector is empty.
+ * All the elements are contiguous from here. It's invalidated by anything that reallocates.
+ * @param vec - the vector
+ * @return the element memory
+ */
+static inline char *cvector_data(char *vec)
+{
+    assert(vec);
+
+    return vec + HEADER_SIZE;
+}
+
 /**
  * Overwrite the memory of an index.
  */
-void cvector_set(char *vec, size_t index, void *fortran_data)
+static inline void cvector_set(char *vec, size_t index, void *fortran_data)
 {
     // Safety implemented in Fortran.
 
-    size_t current_size = cvector_size(vec);
     const size_t element_size = cvector_element_size(vec);
     memcpy(vec + HEADER_SIZE + (element_size * index), fortran_data, element_size);
 }
@@ -424,7 +1005,7 @@ void cvector_set(char *vec, size_t index, void *fortran_data)
  * @brief cvector_front - returns a reference to the first element in the vector. Unlike member cvector_begin, which returns an iterator to this same element, this function returns a direct reference.
  * @return a reference to the first element in the vector container.
  */
-char *cvector_front(char *vec)
+static inline char *cvector_front(char *vec)
 {
     assert(vec);
     if (cvector_size(vec) > 0)
@@ -441,7 +1022,7 @@ char *cvector_front(char *vec)
  * @brief cvector_back - returns a reference to the last element in the vector.Unlike member cvector_end, which returns an iterator just past this element, this function returns a direct reference.
  * @return a reference to the last element in the vector.
  */
-char *cvector_back(char *vec)
+static inline char *cvector_back(char *vec)
 {
     assert(vec);
     if (cvector_size(vec) > 0)
@@ -461,31 +1042,115 @@ char *cvector_back(char *vec)
  * @param value - the value to initialize new elements with
  * @return void
  */
-void cvector_resize(char **vec, size_t new_size, char *value)
+static inline void cvector_resize(char **vec, size_t new_size, char *value)
 {
     assert(vec);
 
-    size_t old_size = ((cvector_header *)*vec)->size;
+    const size_t old_size = ((cvector_header *)*vec)->size;
 
     if (new_size > old_size)
     {
         cvector_reserve(vec, new_size);
-        cvector_set_size(*vec, 0);
 
-        while (old_size < new_size)
-        {
-            cvector_push_back(vec, value);
-            old_size++;
-        }
+        const size_t element_size = cvector_element_size(*vec);
+
+        cvector_repeat(*vec + HEADER_SIZE + (old_size * element_size), value, element_size, new_size - old_size);
     }
-    else
+
+    // Shrinking just forgets the tail. The caller cleans it up first.
+    cvector_set_size(*vec, new_size);
+}
+
+/**
+ * @brief cvector_atomic_reserve - atomically reserves count slots from a shared counter
+ * Every caller gets a distinct range, no locking required.
+ * @param counter - the shared slot counter
+ * @param count - the number of slots to reserve
+ * @return the first reserved slot
+ */
+static inline size_t cvector_atomic_reserve(size_t *counter, size_t count)
+{
+    assert(counter);
+
+    return __atomic_fetch_add(counter, count, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief cvector_atomic_load - reads a shared counter written with cvector_atomic_publish
+ * Everything written before the matching publish is visible after this returns.
+ * @param counter - the shared counter
+ * @return the current value of the counter
+ */
+static inline size_t cvector_atomic_load(size_t *counter)
+{
+    assert(counter);
+
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief cvector_atomic_publish - makes a reserved range [first, first + count) visible to readers
+ * Ranges are published in the order they were reserved, so a reader never sees a
+ * slot that hasn't been written yet. This waits for any earlier ranges to be published first.
+ * After a short spin it yields, so a writer that got preempted can still finish.
+ * @param published - the shared published counter
+ * @param first - the first slot of the range, as returned by cvector_atomic_reserve
+ * @param count - the number of slots in the range
+ * @return void
+ */
+static inline void cvector_atomic_publish(size_t *published, size_t first, size_t count)
+{
+    assert(published);
+
+    size_t spins = 0;
+
+    while (__atomic_load_n(published, __ATOMIC_ACQUIRE) != first)
     {
-        while (new_size < old_size)
+        if (++spins < 64)
         {
-            cvector_pop_back(*vec);
-            old_size--;
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+        else
+        {
+            sched_yield();
         }
     }
+
+    __atomic_store_n(published, first + count, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief cvector_enable_stats - starts counting grows, copies, shifts, and the rest for a vector
+ * The counts start at 0, and are freed with the vector. Turning it on twice does nothing.
+ * Clones share the counts until one of them copies, then that one starts its own.
+ * @param vec - the vector
+ * @param name - what cvector_stats_dump calls it, null terminated, or NULL
+ * @return void
+ */
+static inline void cvector_enable_stats(char *vec, const char *name)
+{
+    assert(vec);
+
+    if (((cvector_header *)vec)->stats)
+    {
+        return;
+    }
+
+    ((cvector_header *)vec)->stats = cvector_stats_create(name, cvector_element_size(vec), cvector_capacity(vec));
+}
+
+/**
+ * @brief cvector_stats_of - gets a vector's counters
+ * @param vec - the vector
+ * @return the counters, or NULL if stats are off
+ */
+static inline cvector_stats *cvector_stats_of(char *vec)
+{
+    assert(vec);
+
+    return ((cvector_header *)vec)->stats;
 }
 
 #endif /* CVECTOR_H_ */
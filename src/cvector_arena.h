@@ -0,0 +1,252 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * A bump arena allocator for cvector, by jordan4ibanez.
+ *
+ * Every vector created with the arena's allocator lives in the arena's chunks.
+ * Freeing a single vector is (almost) free, and resetting the arena releases
+ * every vector in it at once.
+ *
+ * An arena is not thread safe. Use one per thread.
+ */
+
+#ifndef CVECTOR_ARENA_H_
+#define CVECTOR_ARENA_H_
+
+#include <stdlib.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cvector.h"
+
+// Every allocation is aligned to this.
+#define CVECTOR_ARENA_ALIGNMENT 16
+
+// Forward declaration.
+typedef struct cvector_arena cvector_arena;
+typedef struct cvector_arena_chunk cvector_arena_chunk;
+
+static inline cvector_arena *cvector_arena_init(size_t chunk_size);
+static inline void cvector_arena_free(cvector_arena *arena);
+static inline void cvector_arena_reset(cvector_arena *arena);
+static inline const cvector_allocator *cvector_arena_allocator(cvector_arena *arena);
+static inline size_t cvector_arena_used(cvector_arena *arena);
+
+struct cvector_arena_chunk
+{
+    cvector_arena_chunk *previous;
+    size_t capacity;
+    size_t used;
+    // Keeps the memory after this aligned.
+    size_t padding;
+};
+
+struct cvector_arena
+{
+    // Must be first, the allocator's user_data points back at the arena.
+    cvector_allocator allocator;
+    cvector_arena_chunk *current;
+    size_t chunk_size;
+    // Bytes handed out over every chunk.
+    size_t total_used;
+    // The most recent allocation can be grown and freed in place.
+    char *last_allocation;
+};
+
+// Cache this.
+const static size_t CHUNK_HEADER_SIZE = sizeof(cvector_arena_chunk);
+
+/**
+ * @brief cvector_arena_round_up - For internal use, rounds a size up to the arena alignment
+ * @internal
+ */
+static inline size_t cvector_arena_round_up(size_t size)
+{
+    return (size + (CVECTOR_ARENA_ALIGNMENT - 1)) & ~(size_t)(CVECTOR_ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief cvector_arena_new_chunk - For internal use, starts a new chunk that can hold at least size bytes
+ * @internal
+ */
+static inline void cvector_arena_new_chunk(cvector_arena *arena, size_t size)
+{
+    const size_t capacity = size > arena->chunk_size ? size : arena->chunk_size;
+
+    cvector_arena_chunk *chunk = malloc(CHUNK_HEADER_SIZE + capacity);
+    assert(chunk);
+
+    chunk->previous = arena->current;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+
+    arena->current = chunk;
+}
+
+static inline void *cvector_arena_allocate(size_t size, void *user_data)
+{
+    cvector_arena *arena = user_data;
+    size = cvector_arena_round_up(size);
+
+    if (!arena->current || arena->current->capacity - arena->current->used < size)
+    {
+        cvector_arena_new_chunk(arena, size);
+    }
+
+    char *memory = (char *)arena->current + CHUNK_HEADER_SIZE + arena->current->used;
+
+    arena->current->used += size;
+    arena->total_used += size;
+    arena->last_allocation = memory;
+
+    return memory;
+}
+
+static inline void *cvector_arena_reallocate(void *memory, size_t old_size, size_t new_size, void *user_data)
+{
+    cvector_arena *arena = user_data;
+    old_size = cvector_arena_round_up(old_size);
+    new_size = cvector_arena_round_up(new_size);
+
+    // The last allocation can simply be bumped, if it still fits.
+    if (memory == arena->last_allocation)
+    {
+        cvector_arena_chunk *chunk = arena->current;
+        const size_t start = chunk->used - old_size;
+
+        if (chunk->capacity - start >= new_size)
+        {
+            chunk->used = start + new_size;
+            arena->total_used = (arena->total_used - old_size) + new_size;
+            return memory;
+        }
+    }
+    else if (new_size <= old_size)
+    {
+        return memory;
+    }
+
+    char *new_memory = cvector_arena_allocate(new_size, arena);
+
+    memcpy(new_memory, memory, old_size < new_size ? old_size : new_size);
+
+    return new_memory;
+}
+
+static inline void cvector_arena_deallocate(void *memory, size_t size, void *user_data)
+{
+    cvector_arena *arena = user_data;
+
+    // Only the last allocation can be given back. Everything else waits for a reset.
+    if (memory == arena->last_allocation)
+    {
+        size = cvector_arena_round_up(size);
+        arena->current->used -= size;
+        arena->total_used -= size;
+        arena->last_allocation = NULL;
+    }
+}
+
+/**
+ * @brief cvector_arena_init - Initialize an arena.
+ * @param chunk_size - the size in bytes of each chunk the arena grabs from malloc
+ * @return the arena
+ */
+static inline cvector_arena *cvector_arena_init(size_t chunk_size)
+{
+    cvector_arena *arena = calloc(1, sizeof(cvector_arena));
+    assert(arena);
+
+    arena->allocator.allocate = cvector_arena_allocate;
+    arena->allocator.reallocate = cvector_arena_reallocate;
+    arena->allocator.free = cvector_arena_deallocate;
+    arena->allocator.user_data = arena;
+    arena->chunk_size = cvector_arena_round_up(chunk_size ? chunk_size : 4096);
+
+    return arena;
+}
+
+/**
+ * @brief cvector_arena_allocator - gets the allocator to hand to cvector_init
+ * @param arena - the arena
+ * @return the allocator
+ */
+static inline const cvector_allocator *cvector_arena_allocator(cvector_arena *arena)
+{
+    assert(arena);
+
+    return &arena->allocator;
+}
+
+/**
+ * @brief cvector_arena_used - gets the number of bytes currently handed out by the arena
+ * @param arena - the arena
+ * @return the byte count
+ */
+static inline size_t cvector_arena_used(cvector_arena *arena)
+{
+    assert(arena);
+
+    return arena->total_used;
+}
+
+/**
+ * @brief cvector_arena_reset - releases every vector in the arena at once
+ * Every vector allocated from the arena is invalid after this.
+ * If the last round needed more than one chunk, they're merged into one big chunk,
+ * so the next round of the same size fits in a single chunk.
+ * @param arena - the arena
+ * @return void
+ */
+static inline void cvector_arena_reset(cvector_arena *arena)
+{
+    assert(arena);
+
+    cvector_arena_chunk *chunk = arena->current;
+
+    if (chunk && chunk->previous)
+    {
+        size_t total_capacity = 0;
+
+        while (chunk)
+        {
+            cvector_arena_chunk *previous = chunk->previous;
+            total_capacity += chunk->capacity;
+            free(chunk);
+            chunk = previous;
+        }
+
+        arena->current = NULL;
+        cvector_arena_new_chunk(arena, total_capacity);
+    }
+    else if (chunk)
+    {
+        chunk->used = 0;
+    }
+
+    arena->total_used = 0;
+    arena->last_allocation = NULL;
+}
+
+/**
+ * @brief cvector_arena_free - frees the arena and every vector in it
+ * @param arena - the arena
+ * @return void
+ */
+static inline void cvector_arena_free(cvector_arena *arena)
+{
+    assert(arena);
+
+    cvector_arena_chunk *chunk = arena->current;
+
+    while (chunk)
+    {
+        cvector_arena_chunk *previous = chunk->previous;
+        free(chunk);
+        chunk = previous;
+    }
+
+    free(arena);
+}
+
+#endif /* CVECTOR_ARENA_H_ */
@@ -0,0 +1,409 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * A ring buffer deque, and a bounded single producer/single consumer ring, by jordan4ibanez.
+ *
+ * The deque keeps a head offset into wraparound storage, so pushing and popping
+ * at either end is O(1). Nothing is ever shifted. The capacity is always a power of 2,
+ * so wrapping around is a mask instead of a division.
+ *
+ * The SPSC ring never grows. One thread pushes, one thread pops, and neither ever locks.
+ * The head and tail live on their own cache lines so the two threads don't fight over them.
+ */
+
+#ifndef CVECTOR_DEQUE_H_
+#define CVECTOR_DEQUE_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cvector.h"
+
+// Forward declaration.
+typedef struct cvector_deque cvector_deque;
+typedef struct cvector_ring cvector_ring;
+
+static inline cvector_deque *cvector_deque_init(size_t capacity, size_t element_size);
+static inline void cvector_deque_free(cvector_deque *deque);
+static inline void cvector_deque_push_back(cvector_deque *deque, const char *value);
+static inline void cvector_deque_push_front(cvector_deque *deque, const char *value);
+static inline void cvector_deque_pop_back(cvector_deque *deque, char *out);
+static inline void cvector_deque_pop_front(cvector_deque *deque, char *out);
+static inline char *cvector_deque_get(cvector_deque *deque, size_t index);
+static inline size_t cvector_deque_size(cvector_deque *deque);
+static inline size_t cvector_deque_capacity(cvector_deque *deque);
+static inline void cvector_deque_clear(cvector_deque *deque);
+static inline cvector_ring *cvector_ring_init(size_t capacity, size_t element_size);
+static inline void cvector_ring_free(cvector_ring *ring);
+static inline bool cvector_ring_try_push(cvector_ring *ring, const char *value);
+static inline bool cvector_ring_try_pop(cvector_ring *ring, char *out);
+static inline size_t cvector_ring_size(cvector_ring *ring);
+static inline size_t cvector_ring_capacity(cvector_ring *ring);
+
+struct cvector_deque
+{
+    char *data;
+    // Physical index of the front element.
+    size_t head;
+    size_t size;
+    // Always a power of 2, or 0.
+    size_t capacity;
+    size_t element_size;
+};
+
+struct cvector_ring
+{
+    char *data;
+    size_t capacity;
+    size_t mask;
+    size_t element_size;
+    char padding_0[32];
+    // Only the consumer writes this. It only ever counts up.
+    size_t head;
+    char padding_1[56];
+    // Only the producer writes this. It only ever counts up.
+    size_t tail;
+    char padding_2[56];
+};
+
+/**
+ * @brief cvector_round_up_power_of_2 - For internal use, the smallest power of 2 >= value
+ * @internal
+ */
+static inline size_t cvector_round_up_power_of_2(size_t value)
+{
+    size_t power = 1;
+
+    while (power < value)
+    {
+        power <<= 1;
+    }
+
+    return power;
+}
+
+/**
+ * @brief cvector_deque_slot - For internal use, where the element at a logical index lives
+ * @internal
+ */
+static inline char *cvector_deque_slot(cvector_deque *deque, size_t index)
+{
+    return deque->data + (((deque->head + index) & (deque->capacity - 1)) * deque->element_size);
+}
+
+/**
+ * @brief cvector_deque_grow - For internal use, doubles the storage and unwraps it so head is 0
+ * @internal
+ */
+static inline void cvector_deque_grow(cvector_deque *deque)
+{
+    const size_t new_capacity = deque->capacity ? deque->capacity << 1 : 4;
+    char *data = malloc(new_capacity * deque->element_size);
+    assert(data);
+
+    if (deque->size > 0)
+    {
+        // At most two runs: head to the end of the storage, then the start of the storage.
+        const size_t first_run = deque->capacity - deque->head < deque->size ? deque->capacity - deque->head : deque->size;
+
+        memcpy(data, deque->data + (deque->head * deque->element_size), first_run * deque->element_size);
+        memcpy(data + (first_run * deque->element_size), deque->data, (deque->size - first_run) * deque->element_size);
+    }
+
+    free(deque->data);
+
+    deque->data = data;
+    deque->head = 0;
+    deque->capacity = new_capacity;
+}
+
+/**
+ * @brief cvector_deque_init - Initialize a deque.
+ * @param capacity - the initial capacity, rounded up to a power of 2
+ * @param element_size - the size of each element
+ * @return the deque
+ */
+static inline cvector_deque *cvector_deque_init(size_t capacity, size_t element_size)
+{
+    cvector_deque *deque = calloc(1, sizeof(cvector_deque));
+    assert(deque);
+
+    deque->element_size = element_size;
+
+    if (capacity > 0)
+    {
+        deque->capacity = cvector_round_up_power_of_2(capacity);
+        deque->data = malloc(deque->capacity * element_size);
+        assert(deque->data);
+    }
+
+    return deque;
+}
+
+/**
+ * @brief cvector_deque_free - frees the deque
+ * @param deque - the deque
+ * @return void
+ */
+static inline void cvector_deque_free(cvector_deque *deque)
+{
+    if (!deque)
+    {
+        return;
+    }
+
+    free(deque->data);
+    free(deque);
+}
+
+/**
+ * @brief cvector_deque_push_back - adds an element to the back
+ * @param deque - the deque
+ * @param value - the element, element_size bytes
+ * @return void
+ */
+static inline void cvector_deque_push_back(cvector_deque *deque, const char *value)
+{
+    assert(deque);
+
+    if (deque->size == deque->capacity)
+    {
+        cvector_deque_grow(deque);
+    }
+
+    memcpy(cvector_deque_slot(deque, deque->size), value, deque->element_size);
+
+    deque->size++;
+}
+
+/**
+ * @brief cvector_deque_push_front - adds an element to the front
+ * @param deque - the deque
+ * @param value - the element, element_size bytes
+ * @return void
+ */
+static inline void cvector_deque_push_front(cvector_deque *deque, const char *value)
+{
+    assert(deque);
+
+    if (deque->size == deque->capacity)
+    {
+        cvector_deque_grow(deque);
+    }
+
+    deque->head = (deque->head - 1) & (deque->capacity - 1);
+
+    memcpy(deque->data + (deque->head * deque->element_size), value, deque->element_size);
+
+    deque->size++;
+}
+
+/**
+ * @brief cvector_deque_pop_back - removes the back element
+ * @param deque - the deque
+ * @param out - where the element goes, or NULL to drop it
+ * @return void
+ */
+static inline void cvector_deque_pop_back(cvector_deque *deque, char *out)
+{
+    assert(deque);
+    assert(deque->size > 0);
+
+    deque->size--;
+
+    if (out)
+    {
+        memcpy(out, cvector_deque_slot(deque, deque->size), deque->element_size);
+    }
+}
+
+/**
+ * @brief cvector_deque_pop_front - removes the front element
+ * @param deque - the deque
+ * @param out - where the element goes, or NULL to drop it
+ * @return void
+ */
+static inline void cvector_deque_pop_front(cvector_deque *deque, char *out)
+{
+    assert(deque);
+    assert(deque->size > 0);
+
+    if (out)
+    {
+        memcpy(out, deque->data + (deque->head * deque->element_size), deque->element_size);
+    }
+
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    deque->size--;
+}
+
+/**
+ * @brief cvector_deque_get - gets the element at an index, 0 is the front
+ * @param deque - the deque
+ * @param index - the index
+ * @return the element, NULL if it's out of bounds
+ */
+static inline char *cvector_deque_get(cvector_deque *deque, size_t index)
+{
+    assert(deque);
+
+    if (index >= deque->size)
+    {
+        return NULL;
+    }
+
+    return cvector_deque_slot(deque, index);
+}
+
+/**
+ * @brief cvector_deque_size - gets the number of elements
+ * @param deque - the deque
+ * @return the size
+ */
+static inline size_t cvector_deque_size(cvector_deque *deque)
+{
+    assert(deque);
+
+    return deque->size;
+}
+
+/**
+ * @brief cvector_deque_capacity - gets how many elements fit before it grows
+ * @param deque - the deque
+ * @return the capacity
+ */
+static inline size_t cvector_deque_capacity(cvector_deque *deque)
+{
+    assert(deque);
+
+    return deque->capacity;
+}
+
+/**
+ * @brief cvector_deque_clear - forgets every element, keeps the storage
+ * @param deque - the deque
+ * @return void
+ */
+static inline void cvector_deque_clear(cvector_deque *deque)
+{
+    assert(deque);
+
+    deque->head = 0;
+    deque->size = 0;
+}
+
+/**
+ * @brief cvector_ring_init - Initialize an SPSC ring.
+ * @param capacity - how many elements it holds, rounded up to a power of 2
+ * @param element_size - the size of each element
+ * @return the ring
+ */
+static inline cvector_ring *cvector_ring_init(size_t capacity, size_t element_size)
+{
+    assert(capacity > 0);
+
+    // Cache line aligned, so the padding actually splits head and tail.
+    cvector_ring *ring = aligned_alloc(64, sizeof(cvector_ring));
+    assert(ring);
+    memset(ring, 0, sizeof(cvector_ring));
+
+    ring->capacity = cvector_round_up_power_of_2(capacity);
+    ring->mask = ring->capacity - 1;
+    ring->element_size = element_size;
+    ring->data = malloc(ring->capacity * element_size);
+    assert(ring->data);
+
+    return ring;
+}
+
+/**
+ * @brief cvector_ring_free - frees the ring
+ * @param ring - the ring
+ * @return void
+ */
+static inline void cvector_ring_free(cvector_ring *ring)
+{
+    if (!ring)
+    {
+        return;
+    }
+
+    free(ring->data);
+    free(ring);
+}
+
+/**
+ * @brief cvector_ring_try_push - the producer adds an element, if there's room
+ * @param ring - the ring
+ * @param value - the element, element_size bytes
+ * @return if it was pushed
+ */
+static inline bool cvector_ring_try_push(cvector_ring *ring, const char *value)
+{
+    const size_t tail = ring->tail;
+    const size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (tail - head == ring->capacity)
+    {
+        return false;
+    }
+
+    memcpy(ring->data + ((tail & ring->mask) * ring->element_size), value, ring->element_size);
+
+    // The element has to land before the consumer can see the new tail.
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * @brief cvector_ring_try_pop - the consumer takes an element, if there is one
+ * @param ring - the ring
+ * @param out - where the element goes, element_size bytes
+ * @return if it popped one
+ */
+static inline bool cvector_ring_try_pop(cvector_ring *ring, char *out)
+{
+    const size_t head = ring->head;
+    const size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    memcpy(out, ring->data + ((head & ring->mask) * ring->element_size), ring->element_size);
+
+    // Done reading it before the producer can reuse the slot.
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * @brief cvector_ring_size - gets how many elements are waiting
+ * Only a snapshot if the other thread is working.
+ * @param ring - the ring
+ * @return the size
+ */
+static inline size_t cvector_ring_size(cvector_ring *ring)
+{
+    const size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    return tail - head;
+}
+
+/**
+ * @brief cvector_ring_capacity - gets how many elements it holds
+ * @param ring - the ring
+ * @return the capacity
+ */
+static inline size_t cvector_ring_capacity(cvector_ring *ring)
+{
+    return ring->capacity;
+}
+
+#endif /* CVECTOR_DEQUE_H_ */
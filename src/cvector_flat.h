@@ -0,0 +1,205 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * The bulk merge behind flat_set and flat_map, by jordan4ibanez.
+ *
+ * The keys are one sorted run, followed by a pending run of new keys in the order they came in.
+ * One call sorts the pending run, merges it into the sorted one, and drops the duplicates.
+ * When a key shows up more than once, the newest one wins.
+ *
+ * It works on a permutation of indices, so the keys (and the values that go with them)
+ * are only moved once, at the very end, no matter how big they are.
+ * Nothing is freed here. The dropped elements end up after the kept ones,
+ * so the caller can clean them up and cut them off.
+ */
+
+#ifndef CVECTOR_FLAT_H_
+#define CVECTOR_FLAT_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cvector_sort.h"
+
+// Runs this short are insertion sorted before the merge passes start.
+#define CVECTOR_FLAT_RUN 16
+
+static inline size_t cvector_flat_merge(char *keys, size_t key_size, char *values, size_t value_size, size_t count,
+                                        size_t sorted_count, cvector_compare_func compare);
+
+/**
+ * @brief cvector_flat_merge_runs - For internal use, stable merges two sorted runs of indices into out
+ * On a tie, the left run goes first.
+ * @internal
+ */
+static inline void cvector_flat_merge_runs(const char *keys, size_t key_size, const size_t *left, size_t left_count,
+                                           const size_t *right, size_t right_count, size_t *out,
+                                           cvector_compare_func compare)
+{
+    size_t l = 0;
+    size_t r = 0;
+
+    while (l < left_count && r < right_count)
+    {
+        if (compare(keys + (right[r] * key_size), keys + (left[l] * key_size)) < 0)
+        {
+            *out++ = right[r++];
+        }
+        else
+        {
+            *out++ = left[l++];
+        }
+    }
+
+    memcpy(out, left + l, (left_count - l) * sizeof(size_t));
+    out += left_count - l;
+    memcpy(out, right + r, (right_count - r) * sizeof(size_t));
+}
+
+/**
+ * @brief cvector_flat_sort_order - For internal use, stable sorts count indices by the keys they point at
+ * Insertion sorts short runs, then merges them bottom up. scratch must hold count indices.
+ * The result always ends up back in order.
+ * @internal
+ */
+static inline void cvector_flat_sort_order(const char *keys, size_t key_size, size_t *order, size_t *scratch,
+                                           size_t count, cvector_compare_func compare)
+{
+    for (size_t first = 0; first < count; first += CVECTOR_FLAT_RUN)
+    {
+        const size_t last = (first + CVECTOR_FLAT_RUN) < count ? (first + CVECTOR_FLAT_RUN) : count;
+
+        for (size_t i = first + 1; i < last; i++)
+        {
+            const size_t index = order[i];
+            size_t j = i;
+
+            // Strictly less, so equal keys keep their order.
+            while (j > first && compare(keys + (index * key_size), keys + (order[j - 1] * key_size)) < 0)
+            {
+                order[j] = order[j - 1];
+                j--;
+            }
+
+            order[j] = index;
+        }
+    }
+
+    size_t *from = order;
+    size_t *to = scratch;
+
+    for (size_t width = CVECTOR_FLAT_RUN; width < count; width *= 2)
+    {
+        for (size_t first = 0; first < count; first += 2 * width)
+        {
+            const size_t middle = (first + width) < count ? (first + width) : count;
+            const size_t last = (first + (2 * width)) < count ? (first + (2 * width)) : count;
+
+            cvector_flat_merge_runs(keys, key_size, from + first, middle - first, from + middle, last - middle, to + first,
+                                    compare);
+        }
+
+        size_t *swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if (from != order)
+    {
+        memcpy(order, from, count * sizeof(size_t));
+    }
+}
+
+/**
+ * @brief cvector_flat_gather - For internal use, rearranges count elements into the order of the indices
+ * @internal
+ */
+static inline void cvector_flat_gather(char *elements, size_t element_size, const size_t *order, size_t count)
+{
+    char *staging = malloc(count * element_size);
+    assert(staging);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        memcpy(staging + (i * element_size), elements + (order[i] * element_size), element_size);
+    }
+
+    memcpy(elements, staging, count * element_size);
+
+    free(staging);
+}
+
+/**
+ * @brief cvector_flat_merge - sorts the pending keys, merges them into the sorted ones, and drops duplicates
+ * Elements 0 to sorted_count must already be sorted with no duplicates.
+ * Afterwards, the kept keys are sorted at the front, and the dropped ones follow them.
+ * @param keys - the first key
+ * @param key_size - the size of a key
+ * @param values - the first value, moved right along with its key, or NULL
+ * @param value_size - the size of a value
+ * @param count - the number of keys, sorted and pending
+ * @param sorted_count - how many of them are already sorted
+ * @param compare - the comparator for the keys
+ * @return the number of keys kept
+ */
+static inline size_t cvector_flat_merge(char *keys, size_t key_size, char *values, size_t value_size, size_t count,
+                                        size_t sorted_count, cvector_compare_func compare)
+{
+    assert(keys);
+    assert(compare);
+    assert(sorted_count <= count);
+
+    if (sorted_count == count)
+    {
+        return count;
+    }
+
+    size_t *order = malloc(count * sizeof(size_t));
+    size_t *scratch = malloc(count * sizeof(size_t));
+    assert(order);
+    assert(scratch);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+
+    const size_t pending = count - sorted_count;
+
+    cvector_flat_sort_order(keys, key_size, order + sorted_count, scratch, pending, compare);
+
+    // Ties take the sorted run first, so every group of equal keys is oldest to newest.
+    cvector_flat_merge_runs(keys, key_size, order, sorted_count, order + sorted_count, pending, scratch, compare);
+
+    // The newest of each group stays. The rest go to the back, in the same pass.
+    size_t kept = 0;
+    size_t dropped = count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i + 1 < count && compare(keys + (scratch[i] * key_size), keys + (scratch[i + 1] * key_size)) == 0)
+        {
+            order[--dropped] = scratch[i];
+        }
+        else
+        {
+            order[kept++] = scratch[i];
+        }
+    }
+
+    cvector_flat_gather(keys, key_size, order, count);
+
+    if (values)
+    {
+        cvector_flat_gather(values, value_size, order, count);
+    }
+
+    free(order);
+    free(scratch);
+
+    return kept;
+}
+
+#endif /* CVECTOR_FLAT_H_ */
@@ -0,0 +1,410 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * Saving, loading, and memory mapping cvectors, by jordan4ibanez.
+ *
+ * The header and the elements are already one contiguous block, so a file is just:
+ *   the preamble (64 bytes) | a cleaned up copy of the header (64 bytes) | the elements
+ * Saving is one writev, and loading reads the elements straight into the vector.
+ *
+ * Mapping a file gives back a vector whose elements are the page cache itself.
+ * Nothing is copied, so a 30 GB file is ready as soon as it's mapped.
+ * The mapping is private and read only. Destroying the vector unmaps it.
+ *
+ * Files are written in the byte order of the machine that saved them.
+ * Loading a file from the other byte order fails instead of handing back garbage.
+ */
+
+#ifndef CVECTOR_IO_H_
+#define CVECTOR_IO_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "cvector.h"
+
+#define CVECTOR_FILE_VERSION 1
+#define CVECTOR_FILE_BYTE_ORDER 0x0102030405060708ULL
+
+/**
+ * What save, load, and map_readonly give back.
+ */
+typedef enum cvector_io_status
+{
+    CVECTOR_IO_OK = 0,
+    // The file couldn't be opened or created.
+    CVECTOR_IO_OPEN_FAILED = 1,
+    // A read, write, or mmap failed, or the file ended early.
+    CVECTOR_IO_TRANSFER_FAILED = 2,
+    // It's not a vector file, or it's from another version or byte order.
+    CVECTOR_IO_BAD_FILE = 3,
+    // The file's elements aren't the same size as the vector's.
+    CVECTOR_IO_ELEMENT_SIZE_MISMATCH = 4,
+} cvector_io_status;
+
+// Forward declaration.
+typedef struct cvector_file_preamble cvector_file_preamble;
+
+static inline size_t cvector_save(char *vec, const char *path);
+static inline size_t cvector_load(char **vec, const char *path);
+static inline size_t cvector_map_readonly(const char *path, char **vec);
+static inline bool cvector_is_mapped(char *vec);
+
+/**
+ * The first 64 bytes of every vector file.
+ */
+struct cvector_file_preamble
+{
+    char magic[8];
+    uint64_t version;
+    uint64_t header_size;
+    // Reads back as something else on a machine with the other byte order.
+    uint64_t byte_order;
+    char padding[32];
+};
+
+// Cache this.
+const static size_t FILE_PREAMBLE_SIZE = sizeof(cvector_file_preamble);
+
+static const char CVECTOR_FILE_MAGIC[8] = {'F', 'V', 'E', 'C', 'T', 'O', 'R', '\0'};
+
+/**
+ * @brief cvector_io_write_all - For internal use, writev until everything is out
+ * One writev can stop early, and Linux never moves more than about 2 GB per call.
+ * @internal
+ */
+static inline bool cvector_io_write_all(int fd, struct iovec *iov, int count)
+{
+    while (count > 0)
+    {
+        const ssize_t written = writev(fd, iov, count);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        // Skip what went out, and pick up partway through the iovec it stopped in.
+        size_t remaining = (size_t)written;
+
+        while (count > 0 && remaining >= iov->iov_len)
+        {
+            remaining -= iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief cvector_io_read_all - For internal use, read until size bytes are in
+ * @internal
+ */
+static inline bool cvector_io_read_all(int fd, char *buffer, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t got = read(fd, buffer, size);
+
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        // The file ended early.
+        if (got == 0)
+        {
+            return false;
+        }
+
+        buffer += got;
+        size -= (size_t)got;
+    }
+
+    return true;
+}
+
+/**
+ * @brief cvector_io_check - For internal use, checks the preamble and header of a file
+ * @internal
+ */
+static inline bool cvector_io_check(const cvector_file_preamble *preamble, const cvector_header *header)
+{
+    return memcmp(preamble->magic, CVECTOR_FILE_MAGIC, sizeof(CVECTOR_FILE_MAGIC)) == 0 &&
+           preamble->version == CVECTOR_FILE_VERSION &&
+           preamble->header_size == HEADER_SIZE &&
+           preamble->byte_order == CVECTOR_FILE_BYTE_ORDER &&
+           header->element_size > 0;
+}
+
+/**
+ * The bytes are the page cache, so there's nothing to allocate.
+ * These only exist so a mapped vector that somehow gets written to fails loudly.
+ */
+static inline void *cvector_file_allocate(size_t size, void *user_data)
+{
+    (void)size;
+    (void)user_data;
+
+    return NULL;
+}
+
+static inline void *cvector_file_reallocate(void *memory, size_t old_size, size_t new_size, void *user_data)
+{
+    (void)memory;
+    (void)old_size;
+    (void)new_size;
+    (void)user_data;
+
+    return NULL;
+}
+
+/**
+ * The block starts right after the preamble, and runs to the end of the file.
+ */
+static inline void cvector_file_deallocate(void *memory, size_t size, void *user_data)
+{
+    (void)user_data;
+
+    munmap((char *)memory - FILE_PREAMBLE_SIZE, FILE_PREAMBLE_SIZE + size);
+}
+
+static const cvector_allocator cvector_file_allocator = {
+    cvector_file_allocate,
+    cvector_file_reallocate,
+    cvector_file_deallocate,
+    NULL,
+};
+
+/**
+ * @brief cvector_save - writes the vector to a file, replacing it
+ * @param vec - the vector
+ * @param path - where to write it, null terminated
+ * @return a cvector_io_status
+ */
+static inline size_t cvector_save(char *vec, const char *path)
+{
+    assert(vec);
+    assert(path);
+
+    cvector_file_preamble preamble;
+    memset(&preamble, 0, sizeof(preamble));
+    memcpy(preamble.magic, CVECTOR_FILE_MAGIC, sizeof(CVECTOR_FILE_MAGIC));
+    preamble.version = CVECTOR_FILE_VERSION;
+    preamble.header_size = HEADER_SIZE;
+    preamble.byte_order = CVECTOR_FILE_BYTE_ORDER;
+
+    // Pointers and offsets mean nothing in another process, so only the shape goes to disk.
+    cvector_header header;
+    memset(&header, 0, sizeof(header));
+    header.size = cvector_size(vec);
+    header.capacity = header.size;
+    header.element_size = cvector_element_size(vec);
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+    {
+        return CVECTOR_IO_OPEN_FAILED;
+    }
+
+    struct iovec iov[3] = {
+        {&preamble, FILE_PREAMBLE_SIZE},
+        {&header, HEADER_SIZE},
+        {vec + HEADER_SIZE, header.size * header.element_size},
+    };
+
+    const bool written = cvector_io_write_all(fd, iov, 3);
+
+    // Close can be where a full disk finally shows up.
+    if (close(fd) != 0 || !written)
+    {
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    return CVECTOR_IO_OK;
+}
+
+/**
+ * @brief cvector_io_load_fd - For internal use, cvector_load once the file is open
+ * @internal
+ */
+static inline size_t cvector_io_load_fd(int fd, char **vec)
+{
+    cvector_file_preamble preamble;
+    cvector_header header;
+
+    if (!cvector_io_read_all(fd, (char *)&preamble, sizeof(preamble)) || !cvector_io_read_all(fd, (char *)&header, sizeof(header)))
+    {
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    if (!cvector_io_check(&preamble, &header))
+    {
+        return CVECTOR_IO_BAD_FILE;
+    }
+
+    if (header.element_size != cvector_element_size(*vec))
+    {
+        return CVECTOR_IO_ELEMENT_SIZE_MISMATCH;
+    }
+
+    cvector_reserve(vec, header.size);
+
+    // Straight into the vector, no staging buffer.
+    if (!cvector_io_read_all(fd, *vec + HEADER_SIZE, header.size * header.element_size))
+    {
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    cvector_set_size(*vec, header.size);
+
+    return CVECTOR_IO_OK;
+}
+
+/**
+ * @brief cvector_load - replaces the elements of the vector with the ones in a file
+ * The vector keeps its allocator, alignment, and growth policy.
+ * If the load fails, the vector is left empty.
+ * @param vec - a reference to the vector, it can move if it has to grow
+ * @param path - the file, null terminated
+ * @return a cvector_io_status
+ */
+static inline size_t cvector_load(char **vec, const char *path)
+{
+    assert(vec);
+    assert(*vec);
+    assert(path);
+
+    cvector_clear(*vec);
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return CVECTOR_IO_OPEN_FAILED;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const size_t status = cvector_io_load_fd(fd, vec);
+
+    close(fd);
+
+    return status;
+}
+
+/**
+ * @brief cvector_map_readonly - maps a saved file as a read only vector, without copying it
+ * Free it with cvector_free like any other vector, and the file is unmapped.
+ * @param path - the file, null terminated
+ * @param vec - where the vector goes, NULL if it fails
+ * @return a cvector_io_status
+ */
+static inline size_t cvector_map_readonly(const char *path, char **vec)
+{
+    assert(path);
+    assert(vec);
+
+    *vec = NULL;
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return CVECTOR_IO_OPEN_FAILED;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    const size_t file_size = (size_t)info.st_size;
+
+    if (file_size < FILE_PREAMBLE_SIZE + HEADER_SIZE)
+    {
+        close(fd);
+        return CVECTOR_IO_BAD_FILE;
+    }
+
+    // Private, so fixing up the header below never reaches the file.
+    char *mapping = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps the file alive on its own.
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    cvector_header *header = (cvector_header *)(mapping + FILE_PREAMBLE_SIZE);
+
+    if (!cvector_io_check((const cvector_file_preamble *)mapping, header) ||
+        file_size != FILE_PREAMBLE_SIZE + HEADER_SIZE + (header->size * header->element_size))
+    {
+        munmap(mapping, file_size);
+        return CVECTOR_IO_BAD_FILE;
+    }
+
+    // It's a normal vector now, and freeing it unmaps the file.
+    header->capacity = header->size;
+    header->allocator = &cvector_file_allocator;
+    header->alignment = 0;
+    header->block_offset = 0;
+    header->growth_policy = CVECTOR_GROWTH_DOUBLE;
+    header->growth_amount = 0;
+    header->reference_count = 1;
+    header->stats = NULL;
+
+    // Anything that writes to it now faults, instead of quietly copying pages.
+    mprotect(mapping, file_size, PROT_READ);
+
+    *vec = (char *)header;
+
+    return CVECTOR_IO_OK;
+}
+
+/**
+ * @brief cvector_is_mapped - checks if a vector came from cvector_map_readonly
+ * @param vec - the vector
+ * @return if it's a read only mapping
+ */
+static inline bool cvector_is_mapped(char *vec)
+{
+    assert(vec);
+
+    return cvector_allocator_of(vec) == &cvector_file_allocator;
+}
+
+#endif /* CVECTOR_IO_H_ */
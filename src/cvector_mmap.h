@@ -0,0 +1,216 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * An mmap backed storage mode for cvector, by jordan4ibanez.
+ *
+ * Every vector created with this allocator reserves a big virtual range up front.
+ * The kernel only commits the pages that get touched, so growing just walks into
+ * the reservation. Nothing is copied and the elements never move, which keeps the
+ * pointers from get() valid across push_back. Shrinking hands the tail pages back
+ * with madvise(MADV_DONTNEED).
+ *
+ * Only when a vector outgrows its whole reservation does it move to a bigger one.
+ */
+
+#ifndef CVECTOR_MMAP_H_
+#define CVECTOR_MMAP_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "cvector.h"
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+// Forward declaration.
+typedef struct cvector_mmap_storage cvector_mmap_storage;
+typedef struct cvector_mmap_region cvector_mmap_region;
+
+static inline cvector_mmap_storage *cvector_mmap_init(size_t reserve_bytes, bool huge_pages);
+static inline void cvector_mmap_free(cvector_mmap_storage *storage);
+static inline const cvector_allocator *cvector_mmap_allocator(cvector_mmap_storage *storage);
+
+struct cvector_mmap_storage
+{
+    // Must be first, the allocator's user_data points back at the storage.
+    cvector_allocator allocator;
+    // How much virtual memory each vector reserves.
+    size_t reserve_bytes;
+    bool huge_pages;
+};
+
+/**
+ * Sits at the start of every mapping, in front of the block cvector sees.
+ */
+struct cvector_mmap_region
+{
+    // The length of the whole mapping.
+    size_t reserved;
+    // Keeps the block after this 64 byte aligned.
+    char padding[56];
+};
+
+// Cache this.
+const static size_t REGION_HEADER_SIZE = sizeof(cvector_mmap_region);
+
+/**
+ * @brief cvector_mmap_page_round_up - For internal use, rounds a size up to the page size
+ * @internal
+ */
+static inline size_t cvector_mmap_page_round_up(size_t size)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    return (size + (page - 1)) & ~(page - 1);
+}
+
+/**
+ * @brief cvector_mmap_region_of - For internal use, gets the mapping a block lives in
+ * @internal
+ */
+static inline cvector_mmap_region *cvector_mmap_region_of(void *memory)
+{
+    return (cvector_mmap_region *)((char *)memory - REGION_HEADER_SIZE);
+}
+
+/**
+ * @brief cvector_mmap_reserve - For internal use, maps a new region that can hold at least size bytes
+ * @internal
+ */
+static inline void *cvector_mmap_reserve(size_t size, size_t minimum_reserve, bool huge_pages)
+{
+    size_t reserved = cvector_mmap_page_round_up(REGION_HEADER_SIZE + size);
+
+    if (reserved < minimum_reserve)
+    {
+        reserved = minimum_reserve;
+    }
+
+    void *mapping = mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (huge_pages)
+    {
+        // Only a hint. If the kernel doesn't do transparent huge pages, we get normal ones.
+        madvise(mapping, reserved, MADV_HUGEPAGE);
+    }
+#endif
+
+    cvector_mmap_region *region = mapping;
+    region->reserved = reserved;
+
+    return (char *)mapping + REGION_HEADER_SIZE;
+}
+
+static inline void *cvector_mmap_allocate(size_t size, void *user_data)
+{
+    cvector_mmap_storage *storage = user_data;
+
+    return cvector_mmap_reserve(size, storage->reserve_bytes, storage->huge_pages);
+}
+
+static inline void cvector_mmap_deallocate(void *memory, size_t size, void *user_data)
+{
+    (void)size;
+    (void)user_data;
+
+    cvector_mmap_region *region = cvector_mmap_region_of(memory);
+
+    munmap(region, region->reserved);
+}
+
+static inline void *cvector_mmap_reallocate(void *memory, size_t old_size, size_t new_size, void *user_data)
+{
+    cvector_mmap_region *region = cvector_mmap_region_of(memory);
+
+    // Still inside the reservation, nothing moves.
+    if (REGION_HEADER_SIZE + new_size <= region->reserved)
+    {
+        if (new_size < old_size)
+        {
+            // Give the pages past the new end back to the kernel.
+            // They read back as zeroes if the vector grows into them again.
+            const size_t keep = cvector_mmap_page_round_up(REGION_HEADER_SIZE + new_size);
+            const size_t used = cvector_mmap_page_round_up(REGION_HEADER_SIZE + old_size);
+
+            if (used > keep)
+            {
+                madvise((char *)region + keep, used - keep, MADV_DONTNEED);
+            }
+        }
+
+        return memory;
+    }
+
+    // Outgrew the whole reservation. Move to one that's at least twice as big.
+    cvector_mmap_storage *storage = user_data;
+    void *new_memory = cvector_mmap_reserve(new_size, region->reserved << 1, storage->huge_pages);
+
+    if (!new_memory)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, old_size);
+
+    cvector_mmap_deallocate(memory, old_size, storage);
+
+    return new_memory;
+}
+
+/**
+ * @brief cvector_mmap_init - Initialize an mmap storage mode.
+ * @param reserve_bytes - how much virtual memory each vector reserves up front
+ * @param huge_pages - ask the kernel to back the vectors with transparent huge pages
+ * @return the storage
+ */
+static inline cvector_mmap_storage *cvector_mmap_init(size_t reserve_bytes, bool huge_pages)
+{
+    cvector_mmap_storage *storage = calloc(1, sizeof(cvector_mmap_storage));
+    assert(storage);
+
+    storage->allocator.allocate = cvector_mmap_allocate;
+    storage->allocator.reallocate = cvector_mmap_reallocate;
+    storage->allocator.free = cvector_mmap_deallocate;
+    storage->allocator.user_data = storage;
+    storage->reserve_bytes = cvector_mmap_page_round_up(reserve_bytes);
+    storage->huge_pages = huge_pages;
+
+    return storage;
+}
+
+/**
+ * @brief cvector_mmap_allocator - gets the allocator to hand to cvector_init
+ * @param storage - the storage
+ * @return the allocator
+ */
+static inline const cvector_allocator *cvector_mmap_allocator(cvector_mmap_storage *storage)
+{
+    assert(storage);
+
+    return &storage->allocator;
+}
+
+/**
+ * @brief cvector_mmap_free - frees the storage mode
+ * Every vector made with it must be freed first, they still point at it.
+ * @param storage - the storage
+ * @return void
+ */
+static inline void cvector_mmap_free(cvector_mmap_storage *storage)
+{
+    free(storage);
+}
+
+#endif /* CVECTOR_MMAP_H_ */
@@ -0,0 +1,415 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * The thread pool behind cvector_parallel.h, by jordan4ibanez.
+ *
+ * This is the only translation unit that has the pool, so there's only ever one.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cvector.h"
+#include "cvector_parallel.h"
+
+struct cvector_parallel_job
+{
+    char *input;
+    char *output;
+    size_t count;
+    size_t input_element_size;
+    size_t output_element_size;
+    size_t chunk_size;
+    size_t chunk_count;
+    // Atomic. The next chunk someone should take.
+    size_t next_chunk;
+    cvector_span_func span_func;
+    cvector_transform_func transform_func;
+    cvector_reduce_func reduce_func;
+    // One accumulator per chunk, for reduce.
+    char *partials;
+    size_t result_size;
+    void *user_data;
+};
+
+struct cvector_thread_pool
+{
+    pthread_t *threads;
+    size_t thread_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    // Bumped for every job, so the workers know there's something new.
+    size_t generation;
+    // Workers still on the current job.
+    size_t busy;
+    bool stopping;
+    cvector_parallel_job *job;
+};
+
+static cvector_thread_pool *cvector_pool = NULL;
+static size_t cvector_pool_requested_threads = 0;
+// Only one job at a time, and guards starting the pool.
+static pthread_mutex_t cvector_pool_submit = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief cvector_parallel_run_chunks - For internal use, takes chunks off the job until they're gone
+ * @internal
+ */
+static void cvector_parallel_run_chunks(cvector_parallel_job *job)
+{
+    while (true)
+    {
+        const size_t chunk = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED);
+
+        if (chunk >= job->chunk_count)
+        {
+            return;
+        }
+
+        const size_t first = chunk * job->chunk_size;
+        const size_t remaining = job->count - first;
+        const size_t count = remaining < job->chunk_size ? remaining : job->chunk_size;
+        char *input = job->input + (first * job->input_element_size);
+
+        if (job->span_func)
+        {
+            job->span_func(input, count, job->user_data);
+        }
+        else if (job->transform_func)
+        {
+            job->transform_func(input, job->output + (first * job->output_element_size), count, job->user_data);
+        }
+        else
+        {
+            job->reduce_func(input, count, job->partials + (chunk * job->result_size), job->user_data);
+        }
+    }
+}
+
+/**
+ * @brief cvector_pool_worker - For internal use, a pool thread
+ * @internal
+ */
+static void *cvector_pool_worker(void *argument)
+{
+    cvector_thread_pool *pool = argument;
+    size_t seen_generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (true)
+    {
+        while (!pool->stopping && pool->generation == seen_generation)
+        {
+            pthread_cond_wait(&pool->work_ready, &pool->mutex);
+        }
+
+        if (pool->stopping)
+        {
+            break;
+        }
+
+        seen_generation = pool->generation;
+        cvector_parallel_job *job = pool->job;
+
+        pthread_mutex_unlock(&pool->mutex);
+
+        cvector_parallel_run_chunks(job);
+
+        pthread_mutex_lock(&pool->mutex);
+
+        pool->busy--;
+
+        if (pool->busy == 0)
+        {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief cvector_pool_create - For internal use, starts thread_count - 1 workers, the caller is the last one
+ * @internal
+ */
+static cvector_thread_pool *cvector_pool_create(size_t thread_count)
+{
+    cvector_thread_pool *pool = calloc(1, sizeof(cvector_thread_pool));
+    assert(pool);
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    pool->thread_count = thread_count - 1;
+
+    if (pool->thread_count > 0)
+    {
+        pool->threads = malloc(pool->thread_count * sizeof(pthread_t));
+        assert(pool->threads);
+    }
+
+    for (size_t i = 0; i < pool->thread_count; i++)
+    {
+        int status = pthread_create(&pool->threads[i], NULL, cvector_pool_worker, pool);
+        assert(status == 0);
+        (void)status;
+    }
+
+    return pool;
+}
+
+/**
+ * @brief cvector_pool_free - For internal use, stops and joins every worker
+ * @internal
+ */
+static void cvector_pool_free(cvector_thread_pool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 0; i < pool->thread_count; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->mutex);
+
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * @brief cvector_pool_default_threads - For internal use, the number of cores
+ * @internal
+ */
+static size_t cvector_pool_default_threads()
+{
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cores > 0 ? (size_t)cores : 1;
+}
+
+/**
+ * @brief cvector_pool_submit_job - For internal use, runs a job on the pool and waits for it
+ * @internal
+ */
+static void cvector_pool_submit_job(cvector_parallel_job *job)
+{
+    pthread_mutex_lock(&cvector_pool_submit);
+
+    if (!cvector_pool)
+    {
+        cvector_pool = cvector_pool_create(cvector_pool_requested_threads ? cvector_pool_requested_threads : cvector_pool_default_threads());
+    }
+
+    cvector_thread_pool *pool = cvector_pool;
+
+    // Not worth waking anyone up for a single chunk.
+    if (job->chunk_count > 1 && pool->thread_count > 0)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        pool->job = job;
+        pool->busy = pool->thread_count;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->work_ready);
+        pthread_mutex_unlock(&pool->mutex);
+
+        cvector_parallel_run_chunks(job);
+
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->busy > 0)
+        {
+            pthread_cond_wait(&pool->work_done, &pool->mutex);
+        }
+        pool->job = NULL;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    else
+    {
+        cvector_parallel_run_chunks(job);
+    }
+
+    pthread_mutex_unlock(&cvector_pool_submit);
+}
+
+/**
+ * @brief cvector_parallel_job_init - For internal use, cuts a vector up into chunks
+ * @internal
+ */
+static cvector_parallel_job cvector_parallel_job_init(char *vec, size_t chunk_size, void *user_data)
+{
+    cvector_parallel_job job;
+    memset(&job, 0, sizeof(job));
+
+    job.input = vec + HEADER_SIZE;
+    job.count = cvector_size(vec);
+    job.input_element_size = cvector_element_size(vec);
+    job.user_data = user_data;
+
+    if (chunk_size == 0)
+    {
+        const size_t threads = cvector_parallel_thread_count();
+
+        chunk_size = job.count / (threads * CVECTOR_PARALLEL_CHUNKS_PER_THREAD);
+
+        if (chunk_size == 0)
+        {
+            chunk_size = 1;
+        }
+    }
+
+    job.chunk_size = chunk_size;
+    job.chunk_count = (job.count + (chunk_size - 1)) / chunk_size;
+
+    return job;
+}
+
+/**
+ * @brief cvector_parallel_set_thread_count - sets how many threads parallel jobs use, counting the caller
+ * 0 goes back to one per core. No job can be running.
+ * @param thread_count - the number of threads
+ * @return void
+ */
+void cvector_parallel_set_thread_count(size_t thread_count)
+{
+    pthread_mutex_lock(&cvector_pool_submit);
+
+    if (cvector_pool)
+    {
+        cvector_pool_free(cvector_pool);
+        cvector_pool = NULL;
+    }
+
+    cvector_pool_requested_threads = thread_count;
+
+    pthread_mutex_unlock(&cvector_pool_submit);
+}
+
+/**
+ * @brief cvector_parallel_thread_count - gets how many threads parallel jobs use, counting the caller
+ * @return the number of threads
+ */
+size_t cvector_parallel_thread_count()
+{
+    return cvector_pool_requested_threads ? cvector_pool_requested_threads : cvector_pool_default_threads();
+}
+
+/**
+ * @brief cvector_parallel_for_each - calls func on every chunk of the vector, in parallel
+ * @param vec - the vector
+ * @param chunk_size - elements per chunk, 0 picks one
+ * @param func - gets each (base, count) span
+ * @param user_data - handed to func
+ * @return void
+ */
+void cvector_parallel_for_each(char *vec, size_t chunk_size, cvector_span_func func, void *user_data)
+{
+    assert(vec);
+    assert(func);
+
+    cvector_parallel_job job = cvector_parallel_job_init(vec, chunk_size, user_data);
+
+    if (job.count == 0)
+    {
+        return;
+    }
+
+    job.span_func = func;
+
+    cvector_pool_submit_job(&job);
+}
+
+/**
+ * @brief cvector_parallel_transform - calls func on every chunk, with the matching chunk of output
+ * The output is made the same size as the vector first. Its old elements are forgotten, not cleaned up.
+ * @param vec - the vector
+ * @param output - the output vector, any element size
+ * @param chunk_size - elements per chunk, 0 picks one
+ * @param func - gets each (input, output, count) span
+ * @param user_data - handed to func
+ * @return void
+ */
+void cvector_parallel_transform(char *vec, char **output, size_t chunk_size, cvector_transform_func func, void *user_data)
+{
+    assert(vec);
+    assert(output && *output);
+    assert(func);
+
+    cvector_parallel_job job = cvector_parallel_job_init(vec, chunk_size, user_data);
+
+    cvector_reserve(output, job.count);
+    cvector_set_size(*output, job.count);
+
+    if (job.count == 0)
+    {
+        return;
+    }
+
+    job.transform_func = func;
+    job.output = *output + HEADER_SIZE;
+    job.output_element_size = cvector_element_size(*output);
+
+    cvector_pool_submit_job(&job);
+}
+
+/**
+ * @brief cvector_parallel_reduce - reduces the vector, in parallel
+ * Every chunk gets its own accumulator, starting as a copy of init.
+ * So init has to be the identity of your operation, like 0 for a sum, or 1 for a product.
+ * Then the accumulators are combined into result one at a time, in order,
+ * so the answer is the same every run for a given chunk_size.
+ * @param vec - the vector
+ * @param chunk_size - elements per chunk, 0 picks one
+ * @param func - folds a (base, count) span into an accumulator
+ * @param combine - folds one accumulator into another
+ * @param init - the starting accumulator, result_size bytes
+ * @param result - where the answer goes, result_size bytes
+ * @param result_size - the size of the accumulator
+ * @param user_data - handed to func and combine
+ * @return void
+ */
+void cvector_parallel_reduce(char *vec, size_t chunk_size, cvector_reduce_func func, cvector_combine_func combine,
+                             const char *init, char *result, size_t result_size, void *user_data)
+{
+    assert(vec);
+    assert(func);
+    assert(combine);
+
+    cvector_parallel_job job = cvector_parallel_job_init(vec, chunk_size, user_data);
+
+    memcpy(result, init, result_size);
+
+    if (job.count == 0)
+    {
+        return;
+    }
+
+    job.reduce_func = func;
+    job.result_size = result_size;
+    job.partials = malloc(job.chunk_count * result_size);
+    assert(job.partials);
+
+    cvector_repeat(job.partials, init, result_size, job.chunk_count);
+
+    cvector_pool_submit_job(&job);
+
+    for (size_t i = 0; i < job.chunk_count; i++)
+    {
+        combine(result, job.partials + (i * result_size), user_data);
+    }
+
+    free(job.partials);
+}
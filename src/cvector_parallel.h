@@ -0,0 +1,50 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * Parallel for_each, transform, and reduce over cvector, by jordan4ibanez.
+ *
+ * The payload is cut into chunks of chunk_size elements, and a pool of pthreads
+ * (plus the calling thread) grabs chunks off an atomic counter until they're gone.
+ * Each chunk is handed over as a (base pointer, count) span, so the user's code
+ * loops over plain contiguous memory.
+ *
+ * The pool is started the first time it's needed, with one thread per core.
+ * One parallel job runs at a time. Calls from other threads wait their turn.
+ *
+ * Don't start a parallel job from inside one, it will deadlock.
+ *
+ * The pool is global, so it lives in cvector_parallel.c, and every translation unit shares it.
+ */
+
+#ifndef CVECTOR_PARALLEL_H_
+#define CVECTOR_PARALLEL_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cvector.h"
+
+// When chunk_size is 0, each thread gets about this many chunks, so uneven work still balances.
+#define CVECTOR_PARALLEL_CHUNKS_PER_THREAD 4
+
+typedef void (*cvector_span_func)(char *base, size_t count, void *user_data);
+typedef void (*cvector_transform_func)(char *input, char *output, size_t count, void *user_data);
+typedef void (*cvector_reduce_func)(char *base, size_t count, char *accumulator, void *user_data);
+typedef void (*cvector_combine_func)(char *accumulator, char *partial, void *user_data);
+
+// Forward declaration.
+typedef struct cvector_thread_pool cvector_thread_pool;
+typedef struct cvector_parallel_job cvector_parallel_job;
+
+void cvector_parallel_set_thread_count(size_t thread_count);
+size_t cvector_parallel_thread_count();
+void cvector_parallel_for_each(char *vec, size_t chunk_size, cvector_span_func func, void *user_data);
+void cvector_parallel_transform(char *vec, char **output, size_t chunk_size, cvector_transform_func func, void *user_data);
+void cvector_parallel_reduce(char *vec, size_t chunk_size, cvector_reduce_func func, cvector_combine_func combine,
+                             const char *init, char *result, size_t result_size, void *user_data);
+
+#endif /* CVECTOR_PARALLEL_H_ */
@@ -0,0 +1,303 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * Linear search, count, and fill kernels for cvector, by jordan4ibanez.
+ *
+ * Elements are compared bytewise, like memcmp. So for reals, -0.0 is not 0.0,
+ * and a NaN matches a NaN with the same bits.
+ *
+ * Element sizes 1, 2, 4, 8, and 16 get kernels that work on whole integers,
+ * written so the compiler can vectorize them. Find checks a block at a time
+ * with no early exit inside the block, so the hot loop has no branches to stop it.
+ * Everything else falls back to memcmp/memcpy per element.
+ */
+
+#ifndef CVECTOR_SEARCH_H_
+#define CVECTOR_SEARCH_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cvector.h"
+
+// How many elements find checks before it branches.
+#define CVECTOR_SEARCH_BLOCK 16
+
+static inline size_t cvector_find(char *vec, size_t first, const char *value);
+static inline size_t cvector_count(char *vec, const char *value);
+static inline bool cvector_contains(char *vec, const char *value);
+static inline void cvector_fill(char *vec, size_t first, size_t count, const char *value);
+
+/**
+ * A 16 byte element, as two halves.
+ */
+typedef struct cvector_search_u128
+{
+    uint64_t low;
+    uint64_t high;
+} cvector_search_u128;
+
+/**
+ * These generate the find, count, and fill kernels for one integer width.
+ * Every allocator we ship hands out blocks aligned to at least 16 bytes, and
+ * the header is a multiple of 16, so elements of these sizes are naturally aligned.
+ */
+#define CVECTOR_SEARCH_KERNELS(NAME, TYPE)                                                   \
+    static inline size_t cvector_find_##NAME(const char *data, size_t count, const char *value)     \
+    {                                                                                        \
+        const TYPE *elements = (const TYPE *)data;                                           \
+        TYPE key;                                                                            \
+        memcpy(&key, value, sizeof(TYPE));                                                   \
+                                                                                             \
+        size_t i = 0;                                                                        \
+                                                                                             \
+        for (; i + CVECTOR_SEARCH_BLOCK <= count; i += CVECTOR_SEARCH_BLOCK)                 \
+        {                                                                                    \
+            int hit = 0;                                                                     \
+            for (size_t j = 0; j < CVECTOR_SEARCH_BLOCK; j++)                                \
+            {                                                                                \
+                hit |= elements[i + j] == key;                                               \
+            }                                                                                \
+            if (hit)                                                                         \
+            {                                                                                \
+                break;                                                                       \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        for (; i < count; i++)                                                               \
+        {                                                                                    \
+            if (elements[i] == key)                                                          \
+            {                                                                                \
+                return i;                                                                    \
+            }                                                                                \
+        }                                                                                    \
+                                                                                             \
+        return count;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    static inline size_t cvector_count_##NAME(const char *data, size_t count, const char *value)    \
+    {                                                                                        \
+        const TYPE *elements = (const TYPE *)data;                                           \
+        TYPE key;                                                                            \
+        memcpy(&key, value, sizeof(TYPE));                                                   \
+                                                                                             \
+        size_t total = 0;                                                                    \
+                                                                                             \
+        for (size_t i = 0; i < count; i++)                                                   \
+        {                                                                                    \
+            total += elements[i] == key;                                                     \
+        }                                                                                    \
+                                                                                             \
+        return total;                                                                        \
+    }                                                                                        \
+                                                                                             \
+    static inline void cvector_fill_##NAME(char *data, size_t count, const char *value)             \
+    {                                                                                        \
+        TYPE *elements = (TYPE *)data;                                                       \
+        TYPE key;                                                                            \
+        memcpy(&key, value, sizeof(TYPE));                                                   \
+                                                                                             \
+        for (size_t i = 0; i < count; i++)                                                   \
+        {                                                                                    \
+            elements[i] = key;                                                               \
+        }                                                                                    \
+    }
+
+CVECTOR_SEARCH_KERNELS(u8, uint8_t)
+CVECTOR_SEARCH_KERNELS(u16, uint16_t)
+CVECTOR_SEARCH_KERNELS(u32, uint32_t)
+CVECTOR_SEARCH_KERNELS(u64, uint64_t)
+
+/**
+ * @brief cvector_find_u128 - For internal use, find for 16 byte elements
+ * @internal
+ */
+static inline size_t cvector_find_u128(const char *data, size_t count, const char *value)
+{
+    const cvector_search_u128 *elements = (const cvector_search_u128 *)data;
+    cvector_search_u128 key;
+    memcpy(&key, value, sizeof(key));
+
+    size_t i = 0;
+
+    for (; i + CVECTOR_SEARCH_BLOCK <= count; i += CVECTOR_SEARCH_BLOCK)
+    {
+        int hit = 0;
+        for (size_t j = 0; j < CVECTOR_SEARCH_BLOCK; j++)
+        {
+            hit |= (elements[i + j].low == key.low) & (elements[i + j].high == key.high);
+        }
+        if (hit)
+        {
+            break;
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        if (elements[i].low == key.low && elements[i].high == key.high)
+        {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief cvector_count_u128 - For internal use, count for 16 byte elements
+ * @internal
+ */
+static inline size_t cvector_count_u128(const char *data, size_t count, const char *value)
+{
+    const cvector_search_u128 *elements = (const cvector_search_u128 *)data;
+    cvector_search_u128 key;
+    memcpy(&key, value, sizeof(key));
+
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        total += (elements[i].low == key.low) & (elements[i].high == key.high);
+    }
+
+    return total;
+}
+
+/**
+ * @brief cvector_find - finds the first element, from first on, with the same bytes as value
+ * @param vec - the vector
+ * @param first - index to start searching from
+ * @param value - the element to look for, element_size bytes
+ * @return the index of the element, or cvector_size(vec) if it's not there
+ */
+static inline size_t cvector_find(char *vec, size_t first, const char *value)
+{
+    assert(vec);
+    assert(value);
+
+    const size_t size = cvector_size(vec);
+    const size_t element_size = cvector_element_size(vec);
+
+    if (first >= size)
+    {
+        return size;
+    }
+
+    const char *data = vec + HEADER_SIZE + (first * element_size);
+    const size_t count = size - first;
+
+    switch (element_size)
+    {
+    case 1:
+        return first + cvector_find_u8(data, count, value);
+    case 2:
+        return first + cvector_find_u16(data, count, value);
+    case 4:
+        return first + cvector_find_u32(data, count, value);
+    case 8:
+        return first + cvector_find_u64(data, count, value);
+    case 16:
+        return first + cvector_find_u128(data, count, value);
+    default:
+        for (size_t i = 0; i < count; i++)
+        {
+            if (memcmp(data + (i * element_size), value, element_size) == 0)
+            {
+                return first + i;
+            }
+        }
+        return size;
+    }
+}
+
+/**
+ * @brief cvector_count - counts the elements with the same bytes as value
+ * @param vec - the vector
+ * @param value - the element to look for, element_size bytes
+ * @return the number of matching elements
+ */
+static inline size_t cvector_count(char *vec, const char *value)
+{
+    assert(vec);
+    assert(value);
+
+    const size_t size = cvector_size(vec);
+    const size_t element_size = cvector_element_size(vec);
+    const char *data = vec + HEADER_SIZE;
+
+    switch (element_size)
+    {
+    case 1:
+        return cvector_count_u8(data, size, value);
+    case 2:
+        return cvector_count_u16(data, size, value);
+    case 4:
+        return cvector_count_u32(data, size, value);
+    case 8:
+        return cvector_count_u64(data, size, value);
+    case 16:
+        return cvector_count_u128(data, size, value);
+    default:
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            total += memcmp(data + (i * element_size), value, element_size) == 0;
+        }
+        return total;
+    }
+    }
+}
+
+/**
+ * @brief cvector_contains - checks if any element has the same bytes as value
+ * @param vec - the vector
+ * @param value - the element to look for, element_size bytes
+ * @return if it's in there
+ */
+static inline bool cvector_contains(char *vec, const char *value)
+{
+    return cvector_find(vec, 0, value) < cvector_size(vec);
+}
+
+/**
+ * @brief cvector_fill - overwrites count elements, from first on, with value
+ * @param vec - the vector
+ * @param first - index of the first element to overwrite
+ * @param count - how many elements to overwrite
+ * @param value - the element to fill with, element_size bytes
+ * @return void
+ */
+static inline void cvector_fill(char *vec, size_t first, size_t count, const char *value)
+{
+    assert(vec);
+    assert(value);
+    assert(first + count <= cvector_size(vec));
+
+    const size_t element_size = cvector_element_size(vec);
+    char *data = vec + HEADER_SIZE + (first * element_size);
+
+    switch (element_size)
+    {
+    case 1:
+        cvector_fill_u8(data, count, value);
+        break;
+    case 2:
+        cvector_fill_u16(data, count, value);
+        break;
+    case 4:
+        cvector_fill_u32(data, count, value);
+        break;
+    case 8:
+        cvector_fill_u64(data, count, value);
+        break;
+    default:
+        cvector_repeat(data, value, element_size, count);
+        break;
+    }
+}
+
+#endif /* CVECTOR_SEARCH_H_ */
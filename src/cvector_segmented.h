@@ -0,0 +1,276 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * An append only vector for concurrent use, by jordan4ibanez.
+ *
+ * Elements live in geometrically sized segments. Segment k holds
+ * (first_segment_capacity << k) elements, so growing only ever adds a
+ * new segment. Existing elements are never moved and their addresses stay
+ * valid for the whole life of the vector, even while other threads push.
+ */
+
+#ifndef CVECTOR_SEGMENTED_H_
+#define CVECTOR_SEGMENTED_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cvector.h"
+
+// With a first segment of 1 element, this can still hold 2^48 - 1 elements.
+#define CVECTOR_SEGMENT_COUNT 48
+
+// Keeps the hot counters on their own cache lines.
+#define CVECTOR_CACHE_LINE 64
+
+// Forward declaration.
+typedef struct cvector_segmented cvector_segmented;
+
+static inline cvector_segmented *cvector_segmented_init(size_t first_segment_capacity, size_t element_size);
+static inline void cvector_segmented_free(cvector_segmented *vec);
+static inline size_t cvector_segmented_size(cvector_segmented *vec);
+static inline size_t cvector_segmented_capacity(cvector_segmented *vec);
+static inline size_t cvector_segmented_element_size(cvector_segmented *vec);
+static inline size_t cvector_segmented_push_back(cvector_segmented *vec, char *value);
+static inline size_t cvector_segmented_push_back_array(cvector_segmented *vec, char *values, size_t count);
+static inline char *cvector_segmented_get(cvector_segmented *vec, size_t index);
+static inline char *cvector_segmented_slot(cvector_segmented *vec, size_t index);
+static inline char *cvector_segmented_get_segment(cvector_segmented *vec, size_t segment);
+
+struct cvector_segmented
+{
+    // Slots handed out to writers.
+    size_t reserved;
+    char reserved_padding[CVECTOR_CACHE_LINE - sizeof(size_t)];
+    // Slots that have been written and can be read.
+    size_t published;
+    char published_padding[CVECTOR_CACHE_LINE - sizeof(size_t)];
+    size_t element_size;
+    // Always a power of 2.
+    size_t first_segment_capacity;
+    size_t first_segment_shift;
+    char *segments[CVECTOR_SEGMENT_COUNT];
+};
+
+/**
+ * @brief cvector_segmented_init - Initialize an append only vector.
+ * @param first_segment_capacity - the number of elements in the first segment, rounded up to a power of 2
+ * @param element_size - the size of the elements
+ * @return the vector
+ */
+static inline cvector_segmented *cvector_segmented_init(size_t first_segment_capacity, size_t element_size)
+{
+    cvector_segmented *vec = calloc(1, sizeof(cvector_segmented));
+    assert(vec);
+
+    size_t shift = 0;
+
+    while (((size_t)1 << shift) < first_segment_capacity)
+    {
+        shift++;
+    }
+
+    vec->element_size = element_size;
+    vec->first_segment_capacity = (size_t)1 << shift;
+    vec->first_segment_shift = shift;
+
+    return vec;
+}
+
+/**
+ * @brief cvector_segmented_free - frees all memory associated with the vector
+ * No other thread may be using the vector.
+ * @param vec - the vector
+ * @return void
+ */
+static inline void cvector_segmented_free(cvector_segmented *vec)
+{
+    assert(vec);
+
+    for (size_t i = 0; i < CVECTOR_SEGMENT_COUNT; i++)
+    {
+        free(vec->segments[i]);
+    }
+
+    free(vec);
+}
+
+/**
+ * @brief cvector_segmented_size - gets the number of readable elements in the vector
+ * @param vec - the vector
+ * @return the size as a size_t
+ */
+static inline size_t cvector_segmented_size(cvector_segmented *vec)
+{
+    assert(vec);
+
+    return cvector_atomic_load(&vec->published);
+}
+
+/**
+ * @brief cvector_segmented_capacity - gets the number of elements the allocated segments can hold
+ * @param vec - the vector
+ * @return the capacity as a size_t
+ */
+static inline size_t cvector_segmented_capacity(cvector_segmented *vec)
+{
+    assert(vec);
+
+    size_t capacity = 0;
+
+    for (size_t i = 0; i < CVECTOR_SEGMENT_COUNT; i++)
+    {
+        if (!__atomic_load_n(&vec->segments[i], __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+        capacity += vec->first_segment_capacity << i;
+    }
+
+    return capacity;
+}
+
+/**
+ * @brief cvector_segmented_element_size - gets the size of the elements
+ * @param vec - the vector
+ * @return the size as a size_t
+ */
+static inline size_t cvector_segmented_element_size(cvector_segmented *vec)
+{
+    assert(vec);
+
+    return vec->element_size;
+}
+
+/**
+ * @brief cvector_segmented_get_segment - For internal use, gets a segment, allocating it if needed
+ * If two threads race to allocate the same segment, the loser frees its copy.
+ * @param vec - the vector
+ * @param segment - the segment number
+ * @return the segment memory
+ * @internal
+ */
+static inline char *cvector_segmented_get_segment(cvector_segmented *vec, size_t segment)
+{
+    assert(segment < CVECTOR_SEGMENT_COUNT);
+
+    char *memory = __atomic_load_n(&vec->segments[segment], __ATOMIC_ACQUIRE);
+
+    if (memory)
+    {
+        return memory;
+    }
+
+    char *new_memory = malloc((vec->first_segment_capacity << segment) * vec->element_size);
+    assert(new_memory);
+
+    char *expected = NULL;
+
+    if (__atomic_compare_exchange_n(&vec->segments[segment], &expected, new_memory, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        return new_memory;
+    }
+
+    // Somebody else beat us to it.
+    free(new_memory);
+
+    return expected;
+}
+
+/**
+ * @brief cvector_segmented_slot - For internal use, gets the address of a slot, allocating its segment if needed
+ * @param vec - the vector
+ * @param index - the slot index
+ * @return the slot address
+ * @internal
+ */
+static inline char *cvector_segmented_slot(cvector_segmented *vec, size_t index)
+{
+    // Shifting by the first segment size turns this into: segment = floor(log2(j)).
+    const size_t j = (index >> vec->first_segment_shift) + 1;
+    const size_t segment = (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll(j);
+    const size_t segment_start = vec->first_segment_capacity * (((size_t)1 << segment) - 1);
+
+    char *memory = cvector_segmented_get_segment(vec, segment);
+
+    return memory + ((index - segment_start) * vec->element_size);
+}
+
+/**
+ * @brief cvector_segmented_push_back - adds an element to the end of the vector
+ * Safe to call from any number of threads at once.
+ * @param vec - the vector
+ * @param value - the value to add
+ * @return the index the element was stored at
+ */
+static inline size_t cvector_segmented_push_back(cvector_segmented *vec, char *value)
+{
+    return cvector_segmented_push_back_array(vec, value, 1);
+}
+
+/**
+ * @brief cvector_segmented_push_back_array - adds count contiguous elements to the end of the vector
+ * Safe to call from any number of threads at once. The elements always get consecutive indices.
+ * They're only consecutive in memory within one segment. A range that crosses into the next
+ * segment is split between the two, so the first element's slot is not a base pointer for them all.
+ * @param vec - the vector
+ * @param values - pointer to the first of the contiguous elements to add
+ * @param count - the number of elements to add
+ * @return the index the first element was stored at
+ */
+static inline size_t cvector_segmented_push_back_array(cvector_segmented *vec, char *values, size_t count)
+{
+    assert(vec);
+
+    const size_t first = cvector_atomic_reserve(&vec->reserved, count);
+
+    size_t index = first;
+    size_t remaining = count;
+
+    // A range can span more than one segment.
+    while (remaining > 0)
+    {
+        const size_t j = (index >> vec->first_segment_shift) + 1;
+        const size_t segment = (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll(j);
+        const size_t segment_end = vec->first_segment_capacity * (((size_t)1 << (segment + 1)) - 1);
+        size_t chunk = segment_end - index;
+
+        if (chunk > remaining)
+        {
+            chunk = remaining;
+        }
+
+        memcpy(cvector_segmented_slot(vec, index), values, chunk * vec->element_size);
+
+        values += chunk * vec->element_size;
+        index += chunk;
+        remaining -= chunk;
+    }
+
+    cvector_atomic_publish(&vec->published, first, count);
+
+    return first;
+}
+
+/**
+ * @brief cvector_segmented_get - returns a reference to the element at index in the vector.
+ * The address stays valid until the vector is freed.
+ * @param vec - the vector
+ * @param index - index of an element in the vector.
+ * @return the element at the specified index, or NULL if it's not published yet
+ */
+static inline char *cvector_segmented_get(cvector_segmented *vec, size_t index)
+{
+    assert(vec);
+
+    if (index >= cvector_segmented_size(vec))
+    {
+        return NULL;
+    }
+
+    return cvector_segmented_slot(vec, index);
+}
+
+#endif /* CVECTOR_SEGMENTED_H_ */
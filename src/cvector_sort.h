@@ -0,0 +1,530 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * Sorting and binary search for cvector, by jordan4ibanez.
+ *
+ * cvector_sort is an introsort over raw element_size records, with a user comparator.
+ * Quicksort with a median of 3 pivot, insertion sort on small ranges, and heapsort
+ * if the recursion gets too deep, so it's never worse than n log n.
+ *
+ * cvector_radix_sort is an LSD radix sort for 4 and 8 byte integers and reals.
+ * The bits are flipped around so plain unsigned order is the numeric order.
+ * Passes where every element has the same byte are skipped.
+ */
+
+#ifndef CVECTOR_SORT_H_
+#define CVECTOR_SORT_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include "cvector.h"
+
+// Ranges this small are insertion sorted.
+#define CVECTOR_SORT_INSERTION_THRESHOLD 16
+// Elements up to this size are swapped through the stack.
+#define CVECTOR_SORT_STACK_ELEMENT 256
+
+/**
+ * Returns < 0 if a goes before b, 0 if they're equal, > 0 if a goes after b.
+ */
+typedef int (*cvector_compare_func)(const void *a, const void *b);
+
+/**
+ * How cvector_radix_sort reads the bits of each element.
+ */
+enum cvector_radix_kind
+{
+    CVECTOR_RADIX_SIGNED = 0,
+    CVECTOR_RADIX_UNSIGNED = 1,
+    // IEEE 754. -NaN sorts first, NaN sorts last.
+    CVECTOR_RADIX_REAL = 2,
+};
+
+static inline void cvector_sort(char *vec, cvector_compare_func compare);
+static inline size_t cvector_lower_bound(char *vec, const char *value, cvector_compare_func compare);
+static inline void cvector_radix_sort(char *vec, size_t kind);
+static inline size_t cvector_radix_lower_bound(char *vec, const char *value, size_t kind);
+
+/**
+ * @brief cvector_sort_swap - For internal use, swaps two elements through temp
+ * @internal
+ */
+static inline void cvector_sort_swap(char *a, char *b, char *temp, size_t element_size)
+{
+    memcpy(temp, a, element_size);
+    memcpy(a, b, element_size);
+    memcpy(b, temp, element_size);
+}
+
+/**
+ * @brief cvector_insertion_sort - For internal use, insertion sorts count elements
+ * @internal
+ */
+static inline void cvector_insertion_sort(char *data, size_t count, size_t element_size, cvector_compare_func compare,
+                                          char *temp)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        char *current = data + (i * element_size);
+
+        // Already in place, leave it.
+        if (compare(current - element_size, current) <= 0)
+        {
+            continue;
+        }
+
+        memcpy(temp, current, element_size);
+
+        size_t j = i;
+
+        while (j > 0 && compare(data + ((j - 1) * element_size), temp) > 0)
+        {
+            j--;
+        }
+
+        // Shift the whole run up by one in a single move.
+        memmove(data + ((j + 1) * element_size), data + (j * element_size), (i - j) * element_size);
+        memcpy(data + (j * element_size), temp, element_size);
+    }
+}
+
+/**
+ * @brief cvector_sift_down - For internal use, heapsort's sift down
+ * @internal
+ */
+static inline void cvector_sift_down(char *data, size_t root, size_t count, size_t element_size,
+                                     cvector_compare_func compare, char *temp)
+{
+    while (true)
+    {
+        size_t child = (root * 2) + 1;
+
+        if (child >= count)
+        {
+            return;
+        }
+
+        if (child + 1 < count && compare(data + (child * element_size), data + ((child + 1) * element_size)) < 0)
+        {
+            child++;
+        }
+
+        if (compare(data + (root * element_size), data + (child * element_size)) >= 0)
+        {
+            return;
+        }
+
+        cvector_sort_swap(data + (root * element_size), data + (child * element_size), temp, element_size);
+
+        root = child;
+    }
+}
+
+/**
+ * @brief cvector_heap_sort - For internal use, the fallback when quicksort goes too deep
+ * @internal
+ */
+static inline void cvector_heap_sort(char *data, size_t count, size_t element_size, cvector_compare_func compare,
+                                     char *temp)
+{
+    for (size_t i = count / 2; i > 0; i--)
+    {
+        cvector_sift_down(data, i - 1, count, element_size, compare, temp);
+    }
+
+    for (size_t end = count - 1; end > 0; end--)
+    {
+        cvector_sort_swap(data, data + (end * element_size), temp, element_size);
+        cvector_sift_down(data, 0, end, element_size, compare, temp);
+    }
+}
+
+/**
+ * @brief cvector_introsort - For internal use, sorts count elements
+ * Recurses into the smaller side and loops on the bigger one, so the stack stays at log n.
+ * @internal
+ */
+static inline void cvector_introsort(char *data, size_t count, size_t element_size, cvector_compare_func compare,
+                                     char *temp, size_t depth)
+{
+    while (count > CVECTOR_SORT_INSERTION_THRESHOLD)
+    {
+        if (depth == 0)
+        {
+            cvector_heap_sort(data, count, element_size, compare, temp);
+            return;
+        }
+
+        depth--;
+
+        // Median of 3, and it leaves the first and last as sentinels.
+        char *first = data;
+        char *middle = data + ((count / 2) * element_size);
+        char *last = data + ((count - 1) * element_size);
+
+        if (compare(middle, first) < 0)
+        {
+            cvector_sort_swap(middle, first, temp, element_size);
+        }
+        if (compare(last, middle) < 0)
+        {
+            cvector_sort_swap(last, middle, temp, element_size);
+            if (compare(middle, first) < 0)
+            {
+                cvector_sort_swap(middle, first, temp, element_size);
+            }
+        }
+
+        // Park the pivot right before the end.
+        char *pivot = last - element_size;
+        cvector_sort_swap(middle, pivot, temp, element_size);
+
+        // Hoare partition.
+        size_t i = 0;
+        size_t j = count - 2;
+
+        while (true)
+        {
+            while (compare(data + ((++i) * element_size), pivot) < 0)
+            {
+            }
+            while (compare(pivot, data + ((--j) * element_size)) < 0)
+            {
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            cvector_sort_swap(data + (i * element_size), data + (j * element_size), temp, element_size);
+        }
+
+        // The pivot goes to where it belongs.
+        cvector_sort_swap(data + (i * element_size), pivot, temp, element_size);
+
+        const size_t left_count = i;
+        const size_t right_count = count - i - 1;
+        char *right = data + ((i + 1) * element_size);
+
+        if (left_count < right_count)
+        {
+            cvector_introsort(data, left_count, element_size, compare, temp, depth);
+            data = right;
+            count = right_count;
+        }
+        else
+        {
+            cvector_introsort(right, right_count, element_size, compare, temp, depth);
+            count = left_count;
+        }
+    }
+
+    cvector_insertion_sort(data, count, element_size, compare, temp);
+}
+
+/**
+ * @brief cvector_sort - sorts the vector in place
+ * Not stable, equal elements can end up in any order.
+ * @param vec - the vector
+ * @param compare - the comparator
+ * @return void
+ */
+static inline void cvector_sort(char *vec, cvector_compare_func compare)
+{
+    assert(vec);
+    assert(compare);
+
+    const size_t size = cvector_size(vec);
+    const size_t element_size = cvector_element_size(vec);
+
+    if (size < 2)
+    {
+        return;
+    }
+
+    char stack_temp[CVECTOR_SORT_STACK_ELEMENT];
+    char *temp = element_size <= CVECTOR_SORT_STACK_ELEMENT ? stack_temp : malloc(element_size);
+    assert(temp);
+
+    // 2 * log2(n) levels of quicksort before it gives up and heapsorts.
+    size_t depth = 0;
+    for (size_t n = size; n > 1; n >>= 1)
+    {
+        depth += 2;
+    }
+
+    cvector_introsort(vec + HEADER_SIZE, size, element_size, compare, temp, depth);
+
+    if (temp != stack_temp)
+    {
+        free(temp);
+    }
+}
+
+/**
+ * @brief cvector_lower_bound - binary searches a sorted vector
+ * The vector must be sorted with the same comparator.
+ * @param vec - the vector
+ * @param value - the element to look for, element_size bytes
+ * @param compare - the comparator
+ * @return the index of the first element that isn't before value, cvector_size(vec) if they all are
+ */
+static inline size_t cvector_lower_bound(char *vec, const char *value, cvector_compare_func compare)
+{
+    assert(vec);
+    assert(compare);
+
+    const size_t element_size = cvector_element_size(vec);
+    const char *data = vec + HEADER_SIZE;
+    size_t first = 0;
+    size_t count = cvector_size(vec);
+
+    while (count > 0)
+    {
+        const size_t half = count / 2;
+
+        if (compare(data + ((first + half) * element_size), value) < 0)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+/**
+ * @brief cvector_radix_key_32 - For internal use, flips the bits so unsigned order is numeric order
+ * @internal
+ */
+static inline uint32_t cvector_radix_key_32(uint32_t bits, size_t kind)
+{
+    switch (kind)
+    {
+    case CVECTOR_RADIX_SIGNED:
+        return bits ^ 0x80000000u;
+    case CVECTOR_RADIX_REAL:
+        // Negative reals go backwards, so flip all of them. Positive ones just need the sign.
+        return (bits & 0x80000000u) ? ~bits : (bits ^ 0x80000000u);
+    default:
+        return bits;
+    }
+}
+
+/**
+ * @brief cvector_radix_key_64 - For internal use, flips the bits so unsigned order is numeric order
+ * @internal
+ */
+static inline uint64_t cvector_radix_key_64(uint64_t bits, size_t kind)
+{
+    switch (kind)
+    {
+    case CVECTOR_RADIX_SIGNED:
+        return bits ^ 0x8000000000000000ull;
+    case CVECTOR_RADIX_REAL:
+        return (bits & 0x8000000000000000ull) ? ~bits : (bits ^ 0x8000000000000000ull);
+    default:
+        return bits;
+    }
+}
+
+/**
+ * @brief cvector_radix_unkey_32 - For internal use, undoes cvector_radix_key_32
+ * @internal
+ */
+static inline uint32_t cvector_radix_unkey_32(uint32_t key, size_t kind)
+{
+    switch (kind)
+    {
+    case CVECTOR_RADIX_SIGNED:
+        return key ^ 0x80000000u;
+    case CVECTOR_RADIX_REAL:
+        return (key & 0x80000000u) ? (key ^ 0x80000000u) : ~key;
+    default:
+        return key;
+    }
+}
+
+/**
+ * @brief cvector_radix_unkey_64 - For internal use, undoes cvector_radix_key_64
+ * @internal
+ */
+static inline uint64_t cvector_radix_unkey_64(uint64_t key, size_t kind)
+{
+    switch (kind)
+    {
+    case CVECTOR_RADIX_SIGNED:
+        return key ^ 0x8000000000000000ull;
+    case CVECTOR_RADIX_REAL:
+        return (key & 0x8000000000000000ull) ? (key ^ 0x8000000000000000ull) : ~key;
+    default:
+        return key;
+    }
+}
+
+/**
+ * These generate the radix sort for one width.
+ * The keys are sorted in flipped form and flipped back at the end, so each pass is a plain byte scatter.
+ */
+#define CVECTOR_RADIX_SORT(BITS)                                                          \
+    static void cvector_radix_sort_##BITS(uint##BITS##_t *data, size_t count, size_t kind) \
+    {                                                                                     \
+        uint##BITS##_t *scratch = malloc(count * sizeof(uint##BITS##_t));                 \
+        assert(scratch);                                                                  \
+                                                                                          \
+        for (size_t i = 0; i < count; i++)                                                \
+        {                                                                                 \
+            data[i] = cvector_radix_key_##BITS(data[i], kind);                            \
+        }                                                                                 \
+                                                                                          \
+        uint##BITS##_t *from = data;                                                      \
+        uint##BITS##_t *to = scratch;                                                     \
+                                                                                          \
+        for (size_t shift = 0; shift < BITS; shift += 8)                                  \
+        {                                                                                 \
+            size_t histogram[256] = {0};                                                  \
+                                                                                          \
+            for (size_t i = 0; i < count; i++)                                            \
+            {                                                                             \
+                histogram[(from[i] >> shift) & 0xff]++;                                   \
+            }                                                                             \
+                                                                                          \
+            /* Every element has the same byte here, this pass wouldn't move anything. */ \
+            if (histogram[(from[0] >> shift) & 0xff] == count)                            \
+            {                                                                             \
+                continue;                                                                 \
+            }                                                                             \
+                                                                                          \
+            size_t offset = 0;                                                            \
+            for (size_t b = 0; b < 256; b++)                                              \
+            {                                                                             \
+                const size_t bucket = histogram[b];                                       \
+                histogram[b] = offset;                                                    \
+                offset += bucket;                                                         \
+            }                                                                             \
+                                                                                          \
+            for (size_t i = 0; i < count; i++)                                            \
+            {                                                                             \
+                to[histogram[(from[i] >> shift) & 0xff]++] = from[i];                     \
+            }                                                                             \
+                                                                                          \
+            uint##BITS##_t *swap = from;                                                  \
+            from = to;                                                                    \
+            to = swap;                                                                    \
+        }                                                                                 \
+                                                                                          \
+        /* Flipping the keys back is the last pass over the data anyway. */               \
+        for (size_t i = 0; i < count; i++)                                                \
+        {                                                                                 \
+            data[i] = cvector_radix_unkey_##BITS(from[i], kind);                          \
+        }                                                                                 \
+                                                                                          \
+        free(scratch);                                                                    \
+    }
+
+CVECTOR_RADIX_SORT(32)
+CVECTOR_RADIX_SORT(64)
+
+/**
+ * @brief cvector_radix_sort - sorts a vector of 4 or 8 byte numbers in place
+ * @param vec - the vector
+ * @param kind - one of cvector_radix_kind
+ * @return void
+ */
+static inline void cvector_radix_sort(char *vec, size_t kind)
+{
+    assert(vec);
+    assert(kind <= CVECTOR_RADIX_REAL);
+
+    const size_t size = cvector_size(vec);
+
+    if (size < 2)
+    {
+        return;
+    }
+
+    switch (cvector_element_size(vec))
+    {
+    case 4:
+        cvector_radix_sort_32((uint32_t *)(vec + HEADER_SIZE), size, kind);
+        break;
+    case 8:
+        cvector_radix_sort_64((uint64_t *)(vec + HEADER_SIZE), size, kind);
+        break;
+    default:
+        assert(0 && "radix sort only works on 4 and 8 byte elements");
+        break;
+    }
+}
+
+/**
+ * @brief cvector_radix_lower_bound - binary searches a vector sorted by cvector_radix_sort
+ * @param vec - the vector
+ * @param value - the number to look for
+ * @param kind - one of cvector_radix_kind, the same one it was sorted with
+ * @return the index of the first element that isn't less than value, cvector_size(vec) if they all are
+ */
+static inline size_t cvector_radix_lower_bound(char *vec, const char *value, size_t kind)
+{
+    assert(vec);
+
+    const size_t element_size = cvector_element_size(vec);
+    const char *data = vec + HEADER_SIZE;
+    size_t first = 0;
+    size_t count = cvector_size(vec);
+
+    assert(element_size == 4 || element_size == 8);
+
+    if (element_size == 4)
+    {
+        uint32_t bits;
+        memcpy(&bits, value, 4);
+        const uint32_t key = cvector_radix_key_32(bits, kind);
+
+        while (count > 0)
+        {
+            const size_t half = count / 2;
+
+            if (cvector_radix_key_32(((const uint32_t *)data)[first + half], kind) < key)
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+    }
+    else
+    {
+        uint64_t bits;
+        memcpy(&bits, value, 8);
+        const uint64_t key = cvector_radix_key_64(bits, kind);
+
+        while (count > 0)
+        {
+            const size_t half = count / 2;
+
+            if (cvector_radix_key_64(((const uint64_t *)data)[first + half], kind) < key)
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+    }
+
+    return first;
+}
+
+#endif /* CVECTOR_SORT_H_ */
@@ -0,0 +1,112 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * The global registry behind cvector_stats.h, by jordan4ibanez.
+ *
+ * This is the only translation unit that has the registry, so cvector_stats_dump sees every record.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include "cvector_stats.h"
+
+static pthread_mutex_t cvector_stats_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static cvector_stats *cvector_stats_registry = NULL;
+
+/**
+ * @brief cvector_stats_create - makes a new record, and adds it to the registry
+ * @param name - what the dump calls it, null terminated, or NULL
+ * @param element_size - the size of the vector's elements
+ * @param capacity - the vector's capacity right now
+ * @return the record
+ */
+cvector_stats *cvector_stats_create(const char *name, size_t element_size, size_t capacity)
+{
+    cvector_stats *stats = calloc(1, sizeof(cvector_stats));
+    assert(stats);
+
+    stats->element_size = element_size;
+    stats->counters.peak_capacity = capacity;
+
+    if (name)
+    {
+        strncpy(stats->name, name, CVECTOR_STATS_NAME_LENGTH - 1);
+    }
+
+    pthread_mutex_lock(&cvector_stats_registry_mutex);
+
+    stats->next = cvector_stats_registry;
+    if (cvector_stats_registry)
+    {
+        cvector_stats_registry->previous = stats;
+    }
+    cvector_stats_registry = stats;
+
+    pthread_mutex_unlock(&cvector_stats_registry_mutex);
+
+    return stats;
+}
+
+/**
+ * @brief cvector_stats_destroy - takes a record out of the registry, and frees it
+ * @param stats - the record
+ * @return void
+ */
+void cvector_stats_destroy(cvector_stats *stats)
+{
+    assert(stats);
+
+    pthread_mutex_lock(&cvector_stats_registry_mutex);
+
+    if (stats->previous)
+    {
+        stats->previous->next = stats->next;
+    }
+    else
+    {
+        cvector_stats_registry = stats->next;
+    }
+
+    if (stats->next)
+    {
+        stats->next->previous = stats->previous;
+    }
+
+    pthread_mutex_unlock(&cvector_stats_registry_mutex);
+
+    free(stats);
+}
+
+/**
+ * @brief cvector_stats_dump - prints every live record, one line each
+ * The counts are read without stopping the vectors, so a vector in use can be a little behind.
+ * @param stream - where to print it
+ * @return void
+ */
+void cvector_stats_dump(FILE *stream)
+{
+    assert(stream);
+
+    pthread_mutex_lock(&cvector_stats_registry_mutex);
+
+    fprintf(stream, "%-24s %12s %10s %16s %16s %12s %14s %16s\n", "vector", "element_size", "grows", "bytes_copied",
+            "memmove_bytes", "gc_calls", "peak_capacity", "lock_wait_ns");
+
+    for (cvector_stats *stats = cvector_stats_registry; stats; stats = stats->next)
+    {
+        const cvector_stats_counters *c = &stats->counters;
+
+        fprintf(stream, "%-24s %12zu %10" PRIu64 " %16" PRIu64 " %16" PRIu64 " %12" PRIu64 " %14" PRIu64 " %16" PRIu64 "\n",
+                stats->name[0] ? stats->name : "(unnamed)", stats->element_size, c->grows, c->bytes_copied,
+                c->memmove_bytes, c->gc_calls, c->peak_capacity,
+                __atomic_load_n(&c->lock_wait_nanoseconds, __ATOMIC_RELAXED));
+    }
+
+    fflush(stream);
+
+    pthread_mutex_unlock(&cvector_stats_registry_mutex);
+}
@@ -0,0 +1,134 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * Optional counters for cvectors, by jordan4ibanez.
+ *
+ * A vector with stats turned on carries a pointer to one of these in its header.
+ * Everything else leaves the pointer NULL, and pays one well predicted branch on
+ * the paths that already reallocate or memmove. Nothing on push_back's fast path changes.
+ *
+ * Every live record is in one global registry, so cvector_stats_dump can list them all.
+ * That's how you find the vectors that keep growing and need a reserve.
+ * The registry lives in cvector_stats.c, so every translation unit shares it.
+ */
+
+#ifndef CVECTOR_STATS_H_
+#define CVECTOR_STATS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#define CVECTOR_STATS_NAME_LENGTH 64
+
+// Forward declaration.
+typedef struct cvector_stats cvector_stats;
+typedef struct cvector_stats_counters cvector_stats_counters;
+
+cvector_stats *cvector_stats_create(const char *name, size_t element_size, size_t capacity);
+void cvector_stats_destroy(cvector_stats *stats);
+static inline void cvector_stats_record_grow(cvector_stats *stats, size_t bytes_copied, size_t new_capacity);
+static inline void cvector_stats_record_memmove(cvector_stats *stats, size_t bytes);
+static inline void cvector_stats_record_gc_calls(cvector_stats *stats, size_t count);
+static inline void cvector_stats_record_lock_wait(cvector_stats *stats, uint64_t nanoseconds);
+static inline uint64_t cvector_stats_clock();
+void cvector_stats_dump(FILE *stream);
+
+/**
+ * The numbers themselves. This is what gets handed to Fortran.
+ */
+struct cvector_stats_counters
+{
+    // How many times it reallocated to make room.
+    uint64_t grows;
+    // Bytes the reallocations had to carry over. (The most realloc might have copied)
+    uint64_t bytes_copied;
+    // Bytes shifted by insert and remove.
+    uint64_t memmove_bytes;
+    // Elements the GC ran on.
+    uint64_t gc_calls;
+    // The most elements it ever had room for.
+    uint64_t peak_capacity;
+    // Time threads spent waiting on a concurrent_vec's lock.
+    uint64_t lock_wait_nanoseconds;
+};
+
+struct cvector_stats
+{
+    cvector_stats_counters counters;
+    size_t element_size;
+    char name[CVECTOR_STATS_NAME_LENGTH];
+    // The registry.
+    cvector_stats *previous;
+    cvector_stats *next;
+};
+
+/**
+ * @brief cvector_stats_record_grow - counts a reallocation
+ * @param stats - the record
+ * @param bytes_copied - the bytes in use that the reallocation had to keep
+ * @param new_capacity - the capacity after it
+ * @return void
+ */
+static inline void cvector_stats_record_grow(cvector_stats *stats, size_t bytes_copied, size_t new_capacity)
+{
+    stats->counters.grows++;
+    stats->counters.bytes_copied += bytes_copied;
+
+    if (new_capacity > stats->counters.peak_capacity)
+    {
+        stats->counters.peak_capacity = new_capacity;
+    }
+}
+
+/**
+ * @brief cvector_stats_record_memmove - counts bytes shifted by an insert or remove
+ * @param stats - the record
+ * @param bytes - how many bytes moved
+ * @return void
+ */
+static inline void cvector_stats_record_memmove(cvector_stats *stats, size_t bytes)
+{
+    stats->counters.memmove_bytes += bytes;
+}
+
+/**
+ * @brief cvector_stats_record_gc_calls - counts elements the GC ran on
+ * @param stats - the record
+ * @param count - how many elements
+ * @return void
+ */
+static inline void cvector_stats_record_gc_calls(cvector_stats *stats, size_t count)
+{
+    stats->counters.gc_calls += count;
+}
+
+/**
+ * @brief cvector_stats_record_lock_wait - counts time spent waiting for a lock
+ * Readers of a rwlock wait at the same time, so this one is atomic.
+ * @param stats - the record
+ * @param nanoseconds - how long it waited
+ * @return void
+ */
+static inline void cvector_stats_record_lock_wait(cvector_stats *stats, uint64_t nanoseconds)
+{
+    __atomic_add_fetch(&stats->counters.lock_wait_nanoseconds, nanoseconds, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief cvector_stats_clock - a monotonic clock, for timing lock waits
+ * @return nanoseconds since some fixed point
+ */
+static inline uint64_t cvector_stats_clock()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+#endif /* CVECTOR_STATS_H_ */
@@ -0,0 +1,544 @@
+/*
+ * License: The MIT License (MIT)
+ *
+ * Streaming cvectors to and from disk a chunk at a time, by jordan4ibanez.
+ *
+ * For element streams that are bigger than RAM. Memory use is fixed by the chunk size,
+ * no matter how long the stream is.
+ *
+ * The writer fills a cvector buffer, and writes it out each time it's full.
+ * The header is written last, so the file is the same format cvector_save makes.
+ * That means cvector_load and cvector_map_readonly can open it too.
+ *
+ * The reader is double buffered. While you work on one chunk, a background thread
+ * is already reading the next one into the other buffer.
+ */
+
+#ifndef CVECTOR_STREAM_H_
+#define CVECTOR_STREAM_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <string.h>
+#include <pthread.h>
+#include "cvector.h"
+#include "cvector_io.h"
+
+// Forward declaration.
+typedef struct cvector_stream_writer cvector_stream_writer;
+typedef struct cvector_stream_reader cvector_stream_reader;
+
+static inline size_t cvector_stream_writer_open(const char *path, size_t element_size, size_t chunk_elements,
+                                                cvector_stream_writer **writer);
+static inline void cvector_stream_writer_push_back(cvector_stream_writer *writer, const char *value);
+static inline void cvector_stream_writer_push_back_array(cvector_stream_writer *writer, const char *values,
+                                                         size_t count);
+static inline size_t cvector_stream_writer_size(cvector_stream_writer *writer);
+static inline size_t cvector_stream_writer_close(cvector_stream_writer *writer);
+static inline size_t cvector_stream_reader_open(const char *path, size_t element_size, size_t chunk_elements,
+                                                cvector_stream_reader **reader);
+static inline bool cvector_stream_reader_next(cvector_stream_reader *reader, char **chunk, size_t *count);
+static inline size_t cvector_stream_reader_size(cvector_stream_reader *reader);
+static inline size_t cvector_stream_reader_status(cvector_stream_reader *reader);
+static inline void cvector_stream_reader_close(cvector_stream_reader *reader);
+
+struct cvector_stream_writer
+{
+    int fd;
+    // A cvector. Once it's full, it's written out and cleared.
+    char *buffer;
+    size_t chunk_elements;
+    // Every element pushed, including the ones still in the buffer.
+    size_t total;
+    // The first error, if there was one. Pushing after an error does nothing.
+    size_t status;
+};
+
+struct cvector_stream_reader
+{
+    int fd;
+    size_t element_size;
+    size_t chunk_elements;
+    // The number of elements in the file.
+    size_t total;
+    // The next element the background thread should read.
+    size_t next_to_read;
+    // Two cvectors. The caller has buffers[front], the background thread fills the other one.
+    char *buffers[2];
+    size_t front;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    // A read is queued or running.
+    bool pending;
+    bool stop;
+    size_t status;
+};
+
+/**
+ * @brief cvector_stream_pread_all - For internal use, pread until size bytes are in
+ * @internal
+ */
+static inline bool cvector_stream_pread_all(int fd, char *buffer, size_t size, size_t offset)
+{
+    while (size > 0)
+    {
+        const ssize_t got = pread(fd, buffer, size, (off_t)offset);
+
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        // The file ended early.
+        if (got == 0)
+        {
+            return false;
+        }
+
+        buffer += got;
+        offset += (size_t)got;
+        size -= (size_t)got;
+    }
+
+    return true;
+}
+
+/**
+ * @brief cvector_stream_writer_flush - For internal use, writes out the buffer and clears it
+ * @internal
+ */
+static inline void cvector_stream_writer_flush(cvector_stream_writer *writer)
+{
+    const size_t size = cvector_size(writer->buffer);
+
+    if (size == 0 || writer->status != CVECTOR_IO_OK)
+    {
+        cvector_clear(writer->buffer);
+        return;
+    }
+
+    struct iovec iov = {writer->buffer + HEADER_SIZE, size * cvector_element_size(writer->buffer)};
+
+    if (!cvector_io_write_all(writer->fd, &iov, 1))
+    {
+        writer->status = CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    cvector_clear(writer->buffer);
+}
+
+/**
+ * @brief cvector_stream_writer_open - creates a file to stream elements into, replacing it
+ * @param path - the file, null terminated
+ * @param element_size - the size of each element
+ * @param chunk_elements - how many elements to buffer before each write
+ * @param writer - where the writer goes, NULL if it fails
+ * @return a cvector_io_status
+ */
+static inline size_t cvector_stream_writer_open(const char *path, size_t element_size, size_t chunk_elements,
+                                                cvector_stream_writer **writer)
+{
+    assert(path);
+    assert(element_size > 0);
+    assert(chunk_elements > 0);
+    assert(writer);
+
+    *writer = NULL;
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd < 0)
+    {
+        return CVECTOR_IO_OPEN_FAILED;
+    }
+
+    // Leave room for the preamble and the header. They're written at close, once the size is known.
+    if (lseek(fd, (off_t)(FILE_PREAMBLE_SIZE + HEADER_SIZE), SEEK_SET) < 0)
+    {
+        close(fd);
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    cvector_stream_writer *new_writer = calloc(1, sizeof(cvector_stream_writer));
+    assert(new_writer);
+
+    new_writer->fd = fd;
+    new_writer->buffer = cvector_init(chunk_elements, element_size, NULL, 0);
+    new_writer->chunk_elements = chunk_elements;
+    new_writer->status = CVECTOR_IO_OK;
+
+    *writer = new_writer;
+
+    return CVECTOR_IO_OK;
+}
+
+/**
+ * @brief cvector_stream_writer_push_back - adds an element to the end of the stream
+ * @param writer - the writer
+ * @param value - the element, element_size bytes
+ * @return void
+ */
+static inline void cvector_stream_writer_push_back(cvector_stream_writer *writer, const char *value)
+{
+    assert(writer);
+
+    cvector_push_back(&writer->buffer, (char *)value);
+    writer->total++;
+
+    if (cvector_size(writer->buffer) == writer->chunk_elements)
+    {
+        cvector_stream_writer_flush(writer);
+    }
+}
+
+/**
+ * @brief cvector_stream_writer_push_back_array - adds count contiguous elements to the end of the stream
+ * @param writer - the writer
+ * @param values - the elements
+ * @param count - how many elements
+ * @return void
+ */
+static inline void cvector_stream_writer_push_back_array(cvector_stream_writer *writer, const char *values,
+                                                         size_t count)
+{
+    assert(writer);
+
+    const size_t element_size = cvector_element_size(writer->buffer);
+
+    writer->total += count;
+
+    while (count > 0)
+    {
+        // Top up the buffer as far as it goes, one chunk at a time.
+        const size_t room = writer->chunk_elements - cvector_size(writer->buffer);
+        const size_t take = count < room ? count : room;
+
+        cvector_push_back_array(&writer->buffer, (char *)values, take);
+
+        if (cvector_size(writer->buffer) == writer->chunk_elements)
+        {
+            cvector_stream_writer_flush(writer);
+        }
+
+        values += take * element_size;
+        count -= take;
+    }
+}
+
+/**
+ * @brief cvector_stream_writer_size - gets how many elements have been pushed
+ * @param writer - the writer
+ * @return the size
+ */
+static inline size_t cvector_stream_writer_size(cvector_stream_writer *writer)
+{
+    assert(writer);
+
+    return writer->total;
+}
+
+/**
+ * @brief cvector_stream_writer_close - writes out what's left, finishes the file, and frees the writer
+ * @param writer - the writer
+ * @return a cvector_io_status, the first error the writer ran into
+ */
+static inline size_t cvector_stream_writer_close(cvector_stream_writer *writer)
+{
+    assert(writer);
+
+    cvector_stream_writer_flush(writer);
+
+    size_t status = writer->status;
+
+    if (status == CVECTOR_IO_OK)
+    {
+        cvector_file_preamble preamble;
+        memset(&preamble, 0, sizeof(preamble));
+        memcpy(preamble.magic, CVECTOR_FILE_MAGIC, sizeof(CVECTOR_FILE_MAGIC));
+        preamble.version = CVECTOR_FILE_VERSION;
+        preamble.header_size = HEADER_SIZE;
+        preamble.byte_order = CVECTOR_FILE_BYTE_ORDER;
+
+        cvector_header header;
+        memset(&header, 0, sizeof(header));
+        header.size = writer->total;
+        header.capacity = writer->total;
+        header.element_size = cvector_element_size(writer->buffer);
+
+        struct iovec iov[2] = {
+            {&preamble, FILE_PREAMBLE_SIZE},
+            {&header, HEADER_SIZE},
+        };
+
+        if (lseek(writer->fd, 0, SEEK_SET) < 0 || !cvector_io_write_all(writer->fd, iov, 2))
+        {
+            status = CVECTOR_IO_TRANSFER_FAILED;
+        }
+    }
+
+    if (close(writer->fd) != 0 && status == CVECTOR_IO_OK)
+    {
+        status = CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    cvector_free(writer->buffer);
+    free(writer);
+
+    return status;
+}
+
+/**
+ * @brief cvector_stream_reader_fill - For internal use, reads the next chunk into the back buffer
+ * Runs on the background thread, without the mutex.
+ * @internal
+ */
+static inline void cvector_stream_reader_fill(cvector_stream_reader *reader, char *buffer, size_t first)
+{
+    const size_t remaining = reader->total - first;
+    const size_t count = remaining < reader->chunk_elements ? remaining : reader->chunk_elements;
+    const size_t offset = FILE_PREAMBLE_SIZE + HEADER_SIZE + (first * reader->element_size);
+
+    if (cvector_stream_pread_all(reader->fd, buffer + HEADER_SIZE, count * reader->element_size, offset))
+    {
+        cvector_set_size(buffer, count);
+    }
+    else
+    {
+        cvector_set_size(buffer, 0);
+
+        pthread_mutex_lock(&reader->mutex);
+        reader->status = CVECTOR_IO_TRANSFER_FAILED;
+        pthread_mutex_unlock(&reader->mutex);
+    }
+}
+
+/**
+ * @brief cvector_stream_reader_worker - For internal use, the prefetch thread
+ * @internal
+ */
+static inline void *cvector_stream_reader_worker(void *argument)
+{
+    cvector_stream_reader *reader = argument;
+
+    pthread_mutex_lock(&reader->mutex);
+
+    while (true)
+    {
+        while (!reader->pending && !reader->stop)
+        {
+            pthread_cond_wait(&reader->wake, &reader->mutex);
+        }
+
+        if (reader->stop)
+        {
+            break;
+        }
+
+        char *buffer = reader->buffers[reader->front ^ 1];
+        const size_t first = reader->next_to_read;
+
+        pthread_mutex_unlock(&reader->mutex);
+
+        cvector_stream_reader_fill(reader, buffer, first);
+
+        pthread_mutex_lock(&reader->mutex);
+
+        reader->next_to_read = first + cvector_size(buffer);
+        reader->pending = false;
+        pthread_cond_broadcast(&reader->wake);
+    }
+
+    pthread_mutex_unlock(&reader->mutex);
+
+    return NULL;
+}
+
+/**
+ * @brief cvector_stream_reader_open - opens a file written by a stream writer or cvector_save
+ * The first chunk starts reading right away.
+ * @param path - the file, null terminated
+ * @param element_size - the size of each element, it must match the file
+ * @param chunk_elements - how many elements each chunk holds
+ * @param reader - where the reader goes, NULL if it fails
+ * @return a cvector_io_status
+ */
+static inline size_t cvector_stream_reader_open(const char *path, size_t element_size, size_t chunk_elements,
+                                                cvector_stream_reader **reader)
+{
+    assert(path);
+    assert(element_size > 0);
+    assert(chunk_elements > 0);
+    assert(reader);
+
+    *reader = NULL;
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return CVECTOR_IO_OPEN_FAILED;
+    }
+
+    cvector_file_preamble preamble;
+    cvector_header header;
+
+    if (!cvector_stream_pread_all(fd, (char *)&preamble, sizeof(preamble), 0) ||
+        !cvector_stream_pread_all(fd, (char *)&header, sizeof(header), FILE_PREAMBLE_SIZE))
+    {
+        close(fd);
+        return CVECTOR_IO_TRANSFER_FAILED;
+    }
+
+    if (!cvector_io_check(&preamble, &header))
+    {
+        close(fd);
+        return CVECTOR_IO_BAD_FILE;
+    }
+
+    if (header.element_size != element_size)
+    {
+        close(fd);
+        return CVECTOR_IO_ELEMENT_SIZE_MISMATCH;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    cvector_stream_reader *new_reader = calloc(1, sizeof(cvector_stream_reader));
+    assert(new_reader);
+
+    new_reader->fd = fd;
+    new_reader->element_size = element_size;
+    new_reader->chunk_elements = chunk_elements;
+    new_reader->total = header.size;
+    new_reader->buffers[0] = cvector_init(chunk_elements, element_size, NULL, 0);
+    new_reader->buffers[1] = cvector_init(chunk_elements, element_size, NULL, 0);
+    new_reader->status = CVECTOR_IO_OK;
+
+    pthread_mutex_init(&new_reader->mutex, NULL);
+    pthread_cond_init(&new_reader->wake, NULL);
+
+    // Queue the first chunk before the thread even starts.
+    new_reader->pending = header.size > 0;
+
+    const int error = pthread_create(&new_reader->thread, NULL, cvector_stream_reader_worker, new_reader);
+    assert(error == 0);
+    (void)error;
+
+    *reader = new_reader;
+
+    return CVECTOR_IO_OK;
+}
+
+/**
+ * @brief cvector_stream_reader_next - hands over the next chunk, and starts reading the one after it
+ * @param reader - the reader
+ * @param chunk - where the chunk's first element goes. It's good until the next call.
+ * @param count - how many elements the chunk has
+ * @return false once the stream is done, or if a read failed (see cvector_stream_reader_status)
+ */
+static inline bool cvector_stream_reader_next(cvector_stream_reader *reader, char **chunk, size_t *count)
+{
+    assert(reader);
+    assert(chunk);
+    assert(count);
+
+    *chunk = NULL;
+    *count = 0;
+
+    pthread_mutex_lock(&reader->mutex);
+
+    while (reader->pending)
+    {
+        pthread_cond_wait(&reader->wake, &reader->mutex);
+    }
+
+    char *ready = reader->buffers[reader->front ^ 1];
+
+    if (reader->status != CVECTOR_IO_OK || cvector_size(ready) == 0)
+    {
+        pthread_mutex_unlock(&reader->mutex);
+        return false;
+    }
+
+    // The caller is done with the old front, so it becomes the next back buffer.
+    reader->front ^= 1;
+    cvector_set_size(reader->buffers[reader->front ^ 1], 0);
+
+    if (reader->next_to_read < reader->total)
+    {
+        reader->pending = true;
+        pthread_cond_broadcast(&reader->wake);
+    }
+
+    pthread_mutex_unlock(&reader->mutex);
+
+    *chunk = ready + HEADER_SIZE;
+    *count = cvector_size(ready);
+
+    return true;
+}
+
+/**
+ * @brief cvector_stream_reader_size - gets the number of elements in the whole stream
+ * @param reader - the reader
+ * @return the size
+ */
+static inline size_t cvector_stream_reader_size(cvector_stream_reader *reader)
+{
+    assert(reader);
+
+    return reader->total;
+}
+
+/**
+ * @brief cvector_stream_reader_status - gets the first error the reader ran into
+ * @param reader - the reader
+ * @return a cvector_io_status
+ */
+static inline size_t cvector_stream_reader_status(cvector_stream_reader *reader)
+{
+    assert(reader);
+
+    pthread_mutex_lock(&reader->mutex);
+    const size_t status = reader->status;
+    pthread_mutex_unlock(&reader->mutex);
+
+    return status;
+}
+
+/**
+ * @brief cvector_stream_reader_close - stops the prefetch thread, and frees the reader
+ * @param reader - the reader
+ * @return void
+ */
+static inline void cvector_stream_reader_close(cvector_stream_reader *reader)
+{
+    assert(reader);
+
+    pthread_mutex_lock(&reader->mutex);
+    reader->stop = true;
+    pthread_cond_broadcast(&reader->wake);
+    pthread_mutex_unlock(&reader->mutex);
+
+    pthread_join(reader->thread, NULL);
+
+    pthread_mutex_destroy(&reader->mutex);
+    pthread_cond_destroy(&reader->wake);
+
+    close(reader->fd);
+
+    cvector_free(reader->buffers[0]);
+    cvector_free(reader->buffers[1]);
+    free(reader);
+}
+
+#endif /* CVECTOR_STREAM_H_ */
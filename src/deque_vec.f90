@@ -0,0 +1,315 @@
+module deque_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  implicit none
+
+
+  private
+
+
+  public :: deque_vec
+  public :: new_deque_vec
+
+
+  !* A double ended queue.
+  !*
+  !* push_back, push_front, pop_back, and pop_front are all O(1).
+  !* The elements live in a ring, so popping the front never shifts anything.
+  !* Index 1 is always the front, and size() is always the back.
+  !*
+  !! The elements are not contiguous once the ring wraps around, so there is no data_ptr().
+  !! Pointers from get() are only good until the next push.
+  type :: deque_vec
+    private
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => deque_vector_destroy
+    procedure :: get => deque_vector_get
+    procedure :: front => deque_vector_front
+    procedure :: back => deque_vector_back
+    procedure :: is_empty => deque_vector_is_empty
+    procedure :: size => deque_vector_size
+    procedure :: capacity => deque_vector_capacity
+    procedure :: push_back => deque_vector_push_back
+    procedure :: push_front => deque_vector_push_front
+    procedure :: pop_back => deque_vector_pop_back
+    procedure :: pop_front => deque_vector_pop_front
+    procedure :: pop_back_into => deque_vector_pop_back_into
+    procedure :: pop_front_into => deque_vector_pop_front_into
+    procedure :: clear => deque_vector_clear
+  end type deque_vec
+
+
+contains
+
+
+  !* Create a new deque.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* initial_size is the starting capacity. It's rounded up to a power of 2.
+  function new_deque_vec(size_of_type, initial_size, optional_gc_func) result(v)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, initial_size
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(deque_vec) :: v
+
+    ! This will automatically clean your memory upon deletion.
+    if (present(optional_gc_func)) then
+      v%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    v%data = internal_new_deque_vector(initial_size, size_of_type)
+
+    v%size_of_type = size_of_type
+  end function new_deque_vec
+
+
+  !* Destroy all components of the deque. Elements and underlying C memory.
+  subroutine deque_vector_destroy(this)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call run_gc(this, 1_8, this%size())
+
+    call internal_destroy_deque_vector(this%data)
+
+    this%data = c_null_ptr
+    this%size_of_type = 0
+  end subroutine deque_vector_destroy
+
+
+  !* Get an element at an index in the deque. 1 is the front.
+  function deque_vector_get(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    if (index < 1) then
+      error stop "[Vector] Error: Went out of bounds."
+    end if
+
+    raw_c_pointer = internal_deque_vector_get(this%data, index)
+
+    if (.not. c_associated(raw_c_pointer)) then
+      error stop "[Vector] Error: Went out of bounds."
+    end if
+  end function deque_vector_get
+
+
+  !* Get the front element of the deque.
+  function deque_vector_front(this) result(raw_c_pointer)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = this%get(1_8)
+  end function deque_vector_front
+
+
+  !* Get the back element of the deque.
+  function deque_vector_back(this) result(raw_c_pointer)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = this%get(this%size())
+  end function deque_vector_back
+
+
+  !* Check if the deque is empty.
+  function deque_vector_is_empty(this) result(empty)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    if (.not. c_associated(this%data)) then
+      empty = .true.
+    else
+      empty = internal_deque_vector_size(this%data) == 0
+    end if
+  end function deque_vector_is_empty
+
+
+  !* Get the number of elements in the deque.
+  function deque_vector_size(this) result(size)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    size = internal_deque_vector_size(this%data)
+  end function deque_vector_size
+
+
+  !* Get the total allocated size (in elements) of the deque.
+  function deque_vector_capacity(this) result(cap)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    integer(c_size_t) :: cap
+
+    cap = internal_deque_vector_capacity(this%data)
+  end function deque_vector_capacity
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element to the back of the deque.
+  subroutine deque_vector_push_back(this, fortran_data)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_deque_vector_push_back(this%data, black_magic)
+  end subroutine deque_vector_push_back
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element to the front of the deque.
+  subroutine deque_vector_push_front(this, fortran_data)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_deque_vector_push_front(this%data, black_magic)
+  end subroutine deque_vector_push_front
+
+
+  !* Remove the back element of the deque.
+  !* This will call the GC on the element.
+  subroutine deque_vector_pop_back(this)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    !? If it's empty, popping can corrupt the memory.
+    if (this%is_empty()) then
+      return
+    end if
+
+    size = this%size()
+
+    call run_gc(this, size, size)
+
+    call internal_deque_vector_pop_back(this%data, c_null_ptr)
+  end subroutine deque_vector_pop_back
+
+
+  !* Remove the front element of the deque.
+  !* This will call the GC on the element.
+  subroutine deque_vector_pop_front(this)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+
+    !? If it's empty, popping can corrupt the memory.
+    if (this%is_empty()) then
+      return
+    end if
+
+    call run_gc(this, 1_8, 1_8)
+
+    call internal_deque_vector_pop_front(this%data, c_null_ptr)
+  end subroutine deque_vector_pop_front
+
+
+  !* Move the back element of the deque out into out, and remove it.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* out must be the same type as the elements.
+  subroutine deque_vector_pop_back_into(this, out)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    if (this%is_empty()) then
+      error stop "[Vector] Error: Can't pop from an empty vector."
+    end if
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call internal_deque_vector_pop_back(this%data, black_magic)
+  end subroutine deque_vector_pop_back_into
+
+
+  !* Move the front element of the deque out into out, and remove it.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* out must be the same type as the elements.
+  subroutine deque_vector_pop_front_into(this, out)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    if (this%is_empty()) then
+      error stop "[Vector] Error: Can't pop from an empty vector."
+    end if
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call internal_deque_vector_pop_front(this%data, black_magic)
+  end subroutine deque_vector_pop_front_into
+
+
+  !* Remove every element. The GC function will run on each element.
+  !* The capacity is kept.
+  subroutine deque_vector_clear(this)
+    implicit none
+
+    class(deque_vec), intent(inout) :: this
+
+    call run_gc(this, 1_8, this%size())
+
+    call internal_deque_vector_clear(this%data)
+  end subroutine deque_vector_clear
+
+
+!? BEGIN INTERNAL ONLY ==============================================
+
+
+  subroutine run_gc(this, min, max)
+    implicit none
+
+    type(deque_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: min, max
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_size_t) :: i
+
+    ! No GC function was assigned to the vector.
+    if (.not. c_associated(this%gc_func)) then
+      return
+    end if
+
+    call c_f_procpointer(this%gc_func, optional_gc)
+
+    do i = min, max
+      call optional_gc(internal_deque_vector_get(this%data, i))
+    end do
+  end subroutine run_gc
+
+end module deque_vector
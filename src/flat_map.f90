@@ -0,0 +1,353 @@
+module flat_map_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector
+  implicit none
+
+
+  private
+
+
+  public :: flat_map
+  public :: new_flat_map
+
+
+  !* A map from keys to values, kept sorted by key.
+  !*
+  !* The keys live in one contiguous vec, and the values in another, in the same order.
+  !* So a lookup binary searches nothing but keys, and the values stay out of the cache until you want one.
+  !* There are no nodes, so millions of small entries cost what the keys and values cost, and not much more.
+  !*
+  !* Inserts are batched. They're appended as they come, and the next lookup (or commit)
+  !* sorts them, merges them in, and drops the duplicates, all in one pass.
+  !* So insert a lot, then look up a lot. Mixing them one at a time sorts on every lookup.
+  !*
+  !* If the same key is inserted more than once, the newest entry wins, and the GCs run on the rest.
+  type :: flat_map
+    private
+    type(vec) :: keys
+    type(vec) :: values
+    ! Entries 1 to sorted_count are sorted with no duplicates. The rest are pending.
+    integer(c_size_t) :: sorted_count = 0
+    integer(c_size_t) :: key_size = 0
+    integer(c_size_t) :: value_size = 0
+    procedure(vec_compare_blueprint), pointer, nopass :: compare_func => null()
+  contains
+    procedure :: destroy => flat_map_destroy
+    procedure :: insert => flat_map_insert
+    procedure :: insert_array => flat_map_insert_array
+    procedure :: commit => flat_map_commit
+    procedure :: get => flat_map_get
+    procedure :: contains => flat_map_contains
+    procedure :: find => flat_map_find
+    procedure :: lower_bound => flat_map_lower_bound
+    procedure :: remove => flat_map_remove
+    procedure :: key_at => flat_map_key_at
+    procedure :: value_at => flat_map_value_at
+    procedure :: keys_ptr => flat_map_keys_ptr
+    procedure :: values_ptr => flat_map_values_ptr
+    procedure :: is_empty => flat_map_is_empty
+    procedure :: size => flat_map_size
+    procedure :: reserve => flat_map_reserve
+    procedure :: clear => flat_map_clear
+  end type flat_map
+
+
+contains
+
+
+  !* Create a new flat map.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* compare_func orders the keys, and decides which ones are the same. (See vec_compare_blueprint)
+  !* The keys and the values each get their own GC.
+  function new_flat_map(key_size, value_size, compare_func, initial_size, optional_key_gc_func, optional_value_gc_func) &
+      result(m)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: key_size, value_size, initial_size
+    procedure(vec_compare_blueprint) :: compare_func
+    procedure(vec_gc_blueprint), optional :: optional_key_gc_func, optional_value_gc_func
+    type(flat_map) :: m
+
+    m%keys = new_vec(key_size, initial_size, optional_key_gc_func)
+    m%values = new_vec(value_size, initial_size, optional_value_gc_func)
+
+    m%key_size = key_size
+    m%value_size = value_size
+    m%compare_func => compare_func
+  end function new_flat_map
+
+
+  !* Destroy all components of the map. Keys, values, and underlying C memory.
+  subroutine flat_map_destroy(this)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+
+    call this%keys%destroy()
+    call this%values%destroy()
+
+    this%sorted_count = 0
+    this%key_size = 0
+    this%value_size = 0
+    this%compare_func => null()
+  end subroutine flat_map_destroy
+
+
+  !* Uses memcpy under the hood.
+  !* Insert a key and its value. It's pending until the next lookup or commit.
+  !* If the key is already in the map, this value replaces the old one then.
+  subroutine flat_map_insert(this, key, value)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), intent(in), target :: key, value
+
+    call this%keys%push_back(key)
+    call this%values%push_back(value)
+  end subroutine flat_map_insert
+
+
+  !* Uses a single memcpy under the hood, for each array.
+  !* Insert contiguous Fortran arrays of keys and their values, in any order.
+  !* They're pending until the next lookup or commit.
+  subroutine flat_map_insert_array(this, keys, values)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), dimension(:), intent(in), target, contiguous :: keys, values
+
+    if (size(keys) /= size(values)) then
+      error stop "[Vector] Error: A flat_map needs one value for every key."
+    end if
+
+    call this%keys%push_back_array(keys)
+    call this%values%push_back_array(values)
+  end subroutine flat_map_insert_array
+
+
+  !* Sort the pending entries, merge them in, and drop the duplicate keys.
+  !* Every lookup does this for you. Call it yourself to choose when the cost is paid.
+  subroutine flat_map_commit(this)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    integer(c_size_t) :: count, kept
+
+    count = this%keys%size()
+
+    if (this%sorted_count == count) then
+      return
+    end if
+
+    kept = internal_vector_flat_merge(this%keys%data_ptr(), this%key_size, this%values%data_ptr(), this%value_size, count, &
+      this%sorted_count, c_funloc(this%compare_func))
+
+    ! The replaced entries were moved to the back. This runs the GCs on them.
+    if (kept < count) then
+      call this%keys%remove_range(kept + 1, count)
+      call this%values%remove_range(kept + 1, count)
+    end if
+
+    this%sorted_count = kept
+  end subroutine flat_map_commit
+
+
+  !* Get the value for a key. Returns c_null_ptr if it's not in the map.
+  !! The pointer is only good until the next insert or remove.
+  function flat_map_get(this, key) result(raw_c_pointer)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), intent(in), target :: key
+    type(c_ptr) :: raw_c_pointer
+    integer(c_size_t) :: index
+
+    index = this%find(key)
+
+    if (index == 0) then
+      raw_c_pointer = c_null_ptr
+      return
+    end if
+
+    raw_c_pointer = this%values%get(index)
+  end function flat_map_get
+
+
+  !* Check if a key is in the map.
+  function flat_map_contains(this, key) result(found)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), intent(in), target :: key
+    logical(c_bool) :: found
+
+    found = this%find(key) /= 0
+  end function flat_map_contains
+
+
+  !* Get the index of a key in the map. Returns 0 if it's not in there.
+  !* Use it with key_at() and value_at().
+  function flat_map_find(this, key) result(index)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), intent(in), target :: key
+    integer(c_size_t) :: index
+
+    call this%commit()
+
+    index = this%keys%binary_search(key, this%compare_func)
+  end function flat_map_find
+
+
+  !* Get the index of the first key that doesn't go before key.
+  !* If every key goes before it, this is size() + 1.
+  !* Walk from here with key_at() and value_at() for a range query.
+  function flat_map_lower_bound(this, key) result(index)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), intent(in), target :: key
+    integer(c_size_t) :: index
+
+    call this%commit()
+
+    index = this%keys%lower_bound(key, this%compare_func)
+  end function flat_map_lower_bound
+
+
+  !* Remove a key and its value from the map. This will run the GCs.
+  !* Nothing happens if it's not in there.
+  subroutine flat_map_remove(this, key)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    class(*), intent(in), target :: key
+    integer(c_size_t) :: index
+
+    index = this%find(key)
+
+    if (index == 0) then
+      return
+    end if
+
+    call this%keys%remove(index)
+    call this%values%remove(index)
+
+    this%sorted_count = this%sorted_count - 1
+  end subroutine flat_map_remove
+
+
+  !* Get the key at an index in the map. They're in sorted order.
+  !! The pointer is only good until the next insert or remove.
+  function flat_map_key_at(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    call this%commit()
+
+    raw_c_pointer = this%keys%get(index)
+  end function flat_map_key_at
+
+
+  !* Get the value at an index in the map. It goes with key_at(index).
+  !! The pointer is only good until the next insert or remove.
+  function flat_map_value_at(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    call this%commit()
+
+    raw_c_pointer = this%values%get(index)
+  end function flat_map_value_at
+
+
+  !* Get a pointer to the first key. The keys are contiguous and sorted.
+  !! This is invalidated by the next insert or remove.
+  function flat_map_keys_ptr(this) result(raw_c_pointer)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    call this%commit()
+
+    raw_c_pointer = this%keys%data_ptr()
+  end function flat_map_keys_ptr
+
+
+  !* Get a pointer to the first value. The values are contiguous, in the same order as the keys.
+  !! This is invalidated by the next insert or remove.
+  function flat_map_values_ptr(this) result(raw_c_pointer)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    call this%commit()
+
+    raw_c_pointer = this%values%data_ptr()
+  end function flat_map_values_ptr
+
+
+  !* Check if the map is empty.
+  function flat_map_is_empty(this) result(empty)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    empty = this%keys%is_empty()
+  end function flat_map_is_empty
+
+
+  !* Get the number of entries in the map.
+  !* The pending entries are merged first, so duplicate keys are never counted.
+  function flat_map_size(this) result(size)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    call this%commit()
+
+    size = this%keys%size()
+  end function flat_map_size
+
+
+  !* Make room for at least new_capacity entries, sorted and pending together.
+  subroutine flat_map_reserve(this, new_capacity)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_capacity
+
+    call this%keys%reserve(new_capacity)
+    call this%values%reserve(new_capacity)
+  end subroutine flat_map_reserve
+
+
+  !* Remove every entry, pending ones too.
+  !* The GC functions will run on each key and value.
+  subroutine flat_map_clear(this)
+    implicit none
+
+    class(flat_map), intent(inout) :: this
+
+    call this%keys%clear()
+    call this%values%clear()
+
+    this%sorted_count = 0
+  end subroutine flat_map_clear
+
+
+end module flat_map_vector
@@ -0,0 +1,281 @@
+module flat_set_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector
+  implicit none
+
+
+  private
+
+
+  public :: flat_set
+  public :: new_flat_set
+
+
+  !* A set of keys, kept sorted in one contiguous vec.
+  !*
+  !* Lookups are a binary search, and walking it is a plain loop over sorted keys.
+  !* There are no nodes, so millions of small keys cost what the keys cost, and not much more.
+  !*
+  !* Inserts are batched. They're appended as they come, and the next lookup (or commit)
+  !* sorts them, merges them in, and drops the duplicates, all in one pass.
+  !* So insert a lot, then look up a lot. Mixing them one at a time sorts on every lookup.
+  !*
+  !* If the same key is inserted more than once, the newest one is kept, and the GC runs on the rest.
+  type :: flat_set
+    private
+    type(vec) :: keys
+    ! Keys 1 to sorted_count are sorted with no duplicates. The rest are pending.
+    integer(c_size_t) :: sorted_count = 0
+    integer(c_size_t) :: size_of_type = 0
+    procedure(vec_compare_blueprint), pointer, nopass :: compare_func => null()
+  contains
+    procedure :: destroy => flat_set_destroy
+    procedure :: insert => flat_set_insert
+    procedure :: insert_array => flat_set_insert_array
+    procedure :: commit => flat_set_commit
+    procedure :: contains => flat_set_contains
+    procedure :: find => flat_set_find
+    procedure :: lower_bound => flat_set_lower_bound
+    procedure :: remove => flat_set_remove
+    procedure :: get => flat_set_get
+    procedure :: data_ptr => flat_set_data_ptr
+    procedure :: is_empty => flat_set_is_empty
+    procedure :: size => flat_set_size
+    procedure :: reserve => flat_set_reserve
+    procedure :: clear => flat_set_clear
+  end type flat_set
+
+
+contains
+
+
+  !* Create a new flat set.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* compare_func orders the keys, and decides which ones are the same. (See vec_compare_blueprint)
+  function new_flat_set(size_of_type, compare_func, initial_size, optional_gc_func) result(s)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, initial_size
+    procedure(vec_compare_blueprint) :: compare_func
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(flat_set) :: s
+
+    s%keys = new_vec(size_of_type, initial_size, optional_gc_func)
+
+    s%size_of_type = size_of_type
+    s%compare_func => compare_func
+  end function new_flat_set
+
+
+  !* Destroy all components of the set. Keys and underlying C memory.
+  subroutine flat_set_destroy(this)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+
+    call this%keys%destroy()
+
+    this%sorted_count = 0
+    this%size_of_type = 0
+    this%compare_func => null()
+  end subroutine flat_set_destroy
+
+
+  !* Uses memcpy under the hood.
+  !* Insert a key. It's pending until the next lookup or commit.
+  subroutine flat_set_insert(this, key)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    class(*), intent(in), target :: key
+
+    call this%keys%push_back(key)
+  end subroutine flat_set_insert
+
+
+  !* Uses a single memcpy under the hood.
+  !* Insert a whole contiguous Fortran array of keys, in any order. They're pending until the next lookup or commit.
+  subroutine flat_set_insert_array(this, keys)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    class(*), dimension(:), intent(in), target, contiguous :: keys
+
+    call this%keys%push_back_array(keys)
+  end subroutine flat_set_insert_array
+
+
+  !* Sort the pending keys, merge them in, and drop the duplicates.
+  !* Every lookup does this for you. Call it yourself to choose when the cost is paid.
+  subroutine flat_set_commit(this)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    integer(c_size_t) :: count, kept
+
+    count = this%keys%size()
+
+    if (this%sorted_count == count) then
+      return
+    end if
+
+    kept = internal_vector_flat_merge(this%keys%data_ptr(), this%size_of_type, c_null_ptr, 0_c_size_t, count, &
+      this%sorted_count, c_funloc(this%compare_func))
+
+    ! The duplicates were moved to the back. This runs the GC on them.
+    if (kept < count) then
+      call this%keys%remove_range(kept + 1, count)
+    end if
+
+    this%sorted_count = kept
+  end subroutine flat_set_commit
+
+
+  !* Check if a key is in the set.
+  function flat_set_contains(this, key) result(found)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    class(*), intent(in), target :: key
+    logical(c_bool) :: found
+
+    found = this%find(key) /= 0
+  end function flat_set_contains
+
+
+  !* Get the index of a key in the set. Returns 0 if it's not in there.
+  function flat_set_find(this, key) result(index)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    class(*), intent(in), target :: key
+    integer(c_size_t) :: index
+
+    call this%commit()
+
+    index = this%keys%binary_search(key, this%compare_func)
+  end function flat_set_find
+
+
+  !* Get the index of the first key that doesn't go before key.
+  !* If every key goes before it, this is size() + 1.
+  function flat_set_lower_bound(this, key) result(index)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    class(*), intent(in), target :: key
+    integer(c_size_t) :: index
+
+    call this%commit()
+
+    index = this%keys%lower_bound(key, this%compare_func)
+  end function flat_set_lower_bound
+
+
+  !* Remove a key from the set. This will run the GC.
+  !* Nothing happens if it's not in there.
+  subroutine flat_set_remove(this, key)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    class(*), intent(in), target :: key
+    integer(c_size_t) :: index
+
+    index = this%find(key)
+
+    if (index == 0) then
+      return
+    end if
+
+    call this%keys%remove(index)
+
+    this%sorted_count = this%sorted_count - 1
+  end subroutine flat_set_remove
+
+
+  !* Get the key at an index in the set. They're in sorted order.
+  !! The pointer is only good until the next insert or remove.
+  function flat_set_get(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    call this%commit()
+
+    raw_c_pointer = this%keys%get(index)
+  end function flat_set_get
+
+
+  !* Get a pointer to the first key. The keys are contiguous and sorted, so:
+  !*
+  !* call c_f_pointer(s%data_ptr(), keys, [s%size()])
+  !*
+  !! This is invalidated by the next insert or remove.
+  function flat_set_data_ptr(this) result(raw_c_pointer)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    call this%commit()
+
+    raw_c_pointer = this%keys%data_ptr()
+  end function flat_set_data_ptr
+
+
+  !* Check if the set is empty.
+  function flat_set_is_empty(this) result(empty)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    empty = this%keys%is_empty()
+  end function flat_set_is_empty
+
+
+  !* Get the number of keys in the set.
+  !* The pending keys are merged first, so duplicates are never counted.
+  function flat_set_size(this) result(size)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    call this%commit()
+
+    size = this%keys%size()
+  end function flat_set_size
+
+
+  !* Make room for at least new_capacity keys, sorted and pending together.
+  subroutine flat_set_reserve(this, new_capacity)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_capacity
+
+    call this%keys%reserve(new_capacity)
+  end subroutine flat_set_reserve
+
+
+  !* Remove every key, pending ones too.
+  !* The GC function will run on each key.
+  subroutine flat_set_clear(this)
+    implicit none
+
+    class(flat_set), intent(inout) :: this
+
+    call this%keys%clear()
+
+    this%sorted_count = 0
+  end subroutine flat_set_clear
+
+
+end module flat_set_vector
@@ -2,13 +2,28 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include "cvector.h"
+#include "cvector_segmented.h"
+#include "cvector_arena.h"
+#include "cvector_mmap.h"
+#include "cvector_search.h"
+#include "cvector_sort.h"
+#include "cvector_parallel.h"
+#include "cvector_deque.h"
+#include "cvector_io.h"
+#include "cvector_stream.h"
+#include "cvector_flat.h"
+
+// Lets Fortran find elements on its own, without calling into C.
+const size_t VECTOR_HEADER_SIZE = sizeof(cvector_header);
 
 /**
  * @param data_size The size of the element you are using this vector for.
+ * @param allocator The allocator for the vector's memory. NULL uses the global allocator.
+ * @param alignment The power of 2 alignment of the first element. 0 leaves it to the allocator.
  */
-char *new_vector(size_t initial_size, size_t element_size)
+char *new_vector(size_t initial_size, size_t element_size, const cvector_allocator *allocator, size_t alignment)
 {
-  return cvector_init(initial_size, element_size);
+  return cvector_init(initial_size, element_size, allocator, alignment);
 }
 
 /**
@@ -27,6 +42,14 @@ char *vector_get(char *vec, size_t index)
   return cvector_get(vec, index - 1);
 }
 
+/**
+ * Get the start of the contiguous element memory.
+ */
+char *vector_data(char *vec)
+{
+  return cvector_data(vec);
+}
+
 /**
  * Set index of the vector.
  */
@@ -83,6 +106,14 @@ void vector_insert(char **vec, size_t index, char *fortran_data)
   cvector_insert(vec, index - 1, fortran_data);
 }
 
+/**
+ * Insert count contiguous elements into a index in the vector.
+ */
+void vector_insert_range(char **vec, size_t index, char *fortran_data, size_t count)
+{
+  cvector_insert_range(vec, index - 1, fortran_data, count);
+}
+
 /**
  * Remove an element at an index in the vector.
  */
@@ -91,6 +122,14 @@ void vector_remove(char *vec, size_t index)
   cvector_remove(vec, index - 1);
 }
 
+/**
+ * Remove all elements from first to last (inclusive) in the vector.
+ */
+void vector_remove_range(char *vec, size_t first, size_t last)
+{
+  cvector_remove_range(vec, first - 1, (last - first) + 1);
+}
+
 /**
  * Push an element to the back of the vector.
  */
@@ -99,6 +138,22 @@ void vector_push_back(char **vec, char *fortran_data)
   cvector_push_back(vec, fortran_data);
 }
 
+/**
+ * Push count contiguous elements to the back of the vector.
+ */
+void vector_push_back_array(char **vec, char *fortran_data, size_t count)
+{
+  cvector_push_back_array(vec, fortran_data, count);
+}
+
+/**
+ * Add count uninitialized elements to the back of the vector, and get the first one.
+ */
+char *vector_emplace_back(char **vec, size_t count)
+{
+  return cvector_emplace_back(vec, count);
+}
+
 /**
  * Removes the last element from the vector.
  */
@@ -107,6 +162,154 @@ void vector_pop_back(char *vec)
   cvector_pop_back(vec);
 }
 
+/**
+ * Move the element at index out of the vector, without cleaning it up.
+ */
+void vector_take(char *vec, size_t index, char *out)
+{
+  cvector_take(vec, index - 1, out);
+}
+
+/**
+ * Move the last element out of the vector, without cleaning it up.
+ */
+void vector_pop_back_into(char *vec, char *out)
+{
+  cvector_pop_back_into(vec, out);
+}
+
+/**
+ * Find the first element with the same bytes as value. 0 if it's not there.
+ */
+size_t vector_find(char *vec, char *value)
+{
+  const size_t index = cvector_find(vec, 0, value);
+
+  return index < cvector_size(vec) ? index + 1 : 0;
+}
+
+/**
+ * Count the elements with the same bytes as value.
+ */
+size_t vector_count(char *vec, char *value)
+{
+  return cvector_count(vec, value);
+}
+
+/**
+ * Check if any element has the same bytes as value.
+ */
+bool vector_contains(char *vec, char *value)
+{
+  return cvector_contains(vec, value);
+}
+
+/**
+ * Overwrite the elements first to last with value.
+ */
+void vector_fill(char *vec, size_t first, size_t last, char *value)
+{
+  cvector_fill(vec, first - 1, (last - first) + 1, value);
+}
+
+/**
+ * Sort the vector in place with a comparator.
+ */
+void vector_sort(char *vec, cvector_compare_func compare)
+{
+  cvector_sort(vec, compare);
+}
+
+/**
+ * Get the index of the first element that isn't before value, in a sorted vector.
+ * size + 1 if they all are.
+ */
+size_t vector_lower_bound(char *vec, char *value, cvector_compare_func compare)
+{
+  return cvector_lower_bound(vec, value, compare) + 1;
+}
+
+/**
+ * Find an element equal to value in a sorted vector. 0 if it's not there.
+ */
+size_t vector_binary_search(char *vec, char *value, cvector_compare_func compare)
+{
+  const size_t index = cvector_lower_bound(vec, value, compare);
+
+  if (index < cvector_size(vec) && compare(vec + HEADER_SIZE + (index * cvector_element_size(vec)), value) == 0)
+  {
+    return index + 1;
+  }
+
+  return 0;
+}
+
+/**
+ * Radix sort a vector of 4 or 8 byte numbers in place.
+ */
+void vector_radix_sort(char *vec, size_t kind)
+{
+  cvector_radix_sort(vec, kind);
+}
+
+/**
+ * Get the index of the first element that isn't less than value, in a radix sorted vector.
+ * size + 1 if they all are.
+ */
+size_t vector_radix_lower_bound(char *vec, char *value, size_t kind)
+{
+  return cvector_radix_lower_bound(vec, value, kind) + 1;
+}
+
+/**
+ * Find an element with the same bits as value in a radix sorted vector. 0 if it's not there.
+ */
+size_t vector_radix_binary_search(char *vec, char *value, size_t kind)
+{
+  const size_t index = cvector_radix_lower_bound(vec, value, kind);
+  const size_t element_size = cvector_element_size(vec);
+
+  if (index < cvector_size(vec) && memcmp(vec + HEADER_SIZE + (index * element_size), value, element_size) == 0)
+  {
+    return index + 1;
+  }
+
+  return 0;
+}
+
+/**
+ * Set how many threads parallel jobs use, counting the caller. 0 is one per core.
+ */
+void vector_parallel_set_thread_count(size_t thread_count)
+{
+  cvector_parallel_set_thread_count(thread_count);
+}
+
+/**
+ * Call func on every chunk of the vector, in parallel.
+ */
+void vector_parallel_for_each(char *vec, size_t chunk_size, cvector_span_func func, void *user_data)
+{
+  cvector_parallel_for_each(vec, chunk_size, func, user_data);
+}
+
+/**
+ * Call func on every chunk of the vector and the matching chunk of output, in parallel.
+ */
+void vector_parallel_transform(char *vec, char **output, size_t chunk_size, cvector_transform_func func, void *user_data)
+{
+  cvector_parallel_transform(vec, output, chunk_size, func, user_data);
+}
+
+/**
+ * Reduce the vector, in parallel.
+ */
+void vector_parallel_reduce(char *vec, size_t chunk_size, cvector_reduce_func func, cvector_combine_func combine,
+                            char *init, char *result, size_t result_size, void *user_data)
+{
+  cvector_parallel_reduce(vec, chunk_size, func, combine, init, result, result_size, user_data);
+}
+
 /**
  * Clone a vector.
  */
@@ -115,6 +318,212 @@ void vector_clone(char *from, char **to)
   cvector_clone(from, to);
 }
 
+/**
+ * Write a vector to a file.
+ */
+size_t vector_save(char *vec, const char *path)
+{
+  return cvector_save(vec, path);
+}
+
+/**
+ * Replace a vector's elements with the ones in a file.
+ */
+size_t vector_load(char **vec, const char *path)
+{
+  return cvector_load(vec, path);
+}
+
+/**
+ * Map a file as a read only vector.
+ */
+size_t vector_map_readonly(const char *path, char **vec)
+{
+  return cvector_map_readonly(path, vec);
+}
+
+/**
+ * Create a file to stream elements into.
+ */
+size_t new_vector_stream_writer(const char *path, size_t element_size, size_t chunk_size, cvector_stream_writer **writer)
+{
+  return cvector_stream_writer_open(path, element_size, chunk_size, writer);
+}
+
+/**
+ * Push an element onto the end of a stream.
+ */
+void vector_stream_writer_push_back(cvector_stream_writer *writer, char *fortran_data)
+{
+  cvector_stream_writer_push_back(writer, fortran_data);
+}
+
+/**
+ * Push count contiguous elements onto the end of a stream.
+ */
+void vector_stream_writer_push_back_array(cvector_stream_writer *writer, char *fortran_data, size_t count)
+{
+  cvector_stream_writer_push_back_array(writer, fortran_data, count);
+}
+
+/**
+ * Get how many elements have been pushed onto a stream.
+ */
+size_t vector_stream_writer_size(cvector_stream_writer *writer)
+{
+  return cvector_stream_writer_size(writer);
+}
+
+/**
+ * Finish the file, and free the writer.
+ */
+size_t destroy_vector_stream_writer(cvector_stream_writer *writer)
+{
+  return cvector_stream_writer_close(writer);
+}
+
+/**
+ * Open a file to stream elements out of.
+ */
+size_t new_vector_stream_reader(const char *path, size_t element_size, size_t chunk_size, cvector_stream_reader **reader)
+{
+  return cvector_stream_reader_open(path, element_size, chunk_size, reader);
+}
+
+/**
+ * Get the next chunk of a stream.
+ */
+bool vector_stream_reader_next(cvector_stream_reader *reader, char **chunk, size_t *count)
+{
+  return cvector_stream_reader_next(reader, chunk, count);
+}
+
+/**
+ * Get the number of elements in the whole stream.
+ */
+size_t vector_stream_reader_size(cvector_stream_reader *reader)
+{
+  return cvector_stream_reader_size(reader);
+}
+
+/**
+ * Get the first error a stream reader ran into.
+ */
+size_t vector_stream_reader_status(cvector_stream_reader *reader)
+{
+  return cvector_stream_reader_status(reader);
+}
+
+/**
+ * Free a stream reader.
+ */
+void destroy_vector_stream_reader(cvector_stream_reader *reader)
+{
+  cvector_stream_reader_close(reader);
+}
+
+/**
+ * Add an owner to a vector's memory, for copy on write.
+ */
+char *vector_share(char *vec)
+{
+  return cvector_share(vec);
+}
+
+/**
+ * Check if more than one owner has a vector's memory.
+ */
+bool vector_is_shared(char *vec)
+{
+  return cvector_is_shared(vec);
+}
+
+/**
+ * Give this owner a copy of its own, if the memory is shared.
+ */
+void vector_unshare(char **vec)
+{
+  cvector_unshare(vec);
+}
+
+/**
+ * Sort the pending keys of a flat set or map, merge them in, and move the duplicates to the back.
+ * Returns how many keys are kept.
+ */
+size_t vector_flat_merge(char *keys, size_t key_size, char *values, size_t value_size, size_t count, size_t sorted_count,
+                         cvector_compare_func compare)
+{
+  return cvector_flat_merge(keys, key_size, values, value_size, count, sorted_count, compare);
+}
+
+/**
+ * Start counting a vector's grows, copies, and shifts.
+ */
+void vector_enable_stats(char *vec, const char *name)
+{
+  cvector_enable_stats(vec, name[0] ? name : NULL);
+}
+
+/**
+ * Copy out a vector's counters. Gives back false if stats are off.
+ */
+bool vector_get_stats(char *vec, cvector_stats_counters *counters)
+{
+  const cvector_stats *stats = cvector_stats_of(vec);
+
+  if (!stats)
+  {
+    return false;
+  }
+
+  *counters = stats->counters;
+  counters->lock_wait_nanoseconds = __atomic_load_n(&stats->counters.lock_wait_nanoseconds, __ATOMIC_RELAXED);
+
+  return true;
+}
+
+/**
+ * Count elements the GC ran on, if stats are on.
+ */
+void vector_stats_record_gc_calls(char *vec, size_t count)
+{
+  cvector_stats *stats = cvector_stats_of(vec);
+
+  if (stats)
+  {
+    cvector_stats_record_gc_calls(stats, count);
+  }
+}
+
+/**
+ * Count time spent waiting for a lock, if stats are on.
+ */
+void vector_stats_record_lock_wait(char *vec, uint64_t nanoseconds)
+{
+  cvector_stats *stats = cvector_stats_of(vec);
+
+  if (stats)
+  {
+    cvector_stats_record_lock_wait(stats, nanoseconds);
+  }
+}
+
+/**
+ * A monotonic clock in nanoseconds, for timing lock waits.
+ */
+uint64_t vector_stats_clock()
+{
+  return cvector_stats_clock();
+}
+
+/**
+ * Print every vector that has stats on, to stdout.
+ */
+void vector_stats_dump()
+{
+  cvector_stats_dump(stdout);
+}
+
 /**
  * Swap one vector's contents with another's.
  */
@@ -131,6 +540,14 @@ void vector_reserve(char **vec, size_t new_capacity)
   cvector_reserve(vec, new_capacity);
 }
 
+/**
+ * Choose how the vector grows when it runs out of room.
+ */
+void vector_set_growth_policy(char *vec, size_t policy, size_t amount)
+{
+  cvector_set_growth_policy(vec, policy, amount);
+}
+
 /**
  * Resize a vector to a new size.
  *
@@ -140,3 +557,292 @@ void vector_resize(char **vec, size_t new_size, char *default_element)
 {
   cvector_resize(vec, new_size, default_element);
 }
+
+/**
+ * Create a new append only vector.
+ *
+ * @param first_segment_size The number of elements the first segment can hold.
+ */
+cvector_segmented *new_append_vector(size_t first_segment_size, size_t element_size)
+{
+  return cvector_segmented_init(first_segment_size, element_size);
+}
+
+/**
+ * Free the underlying memory of an append only vector.
+ */
+void destroy_append_vector(cvector_segmented *vec)
+{
+  cvector_segmented_free(vec);
+}
+
+/**
+ * Index into the append only vector.
+ */
+char *append_vector_get(cvector_segmented *vec, size_t index)
+{
+  return cvector_segmented_get(vec, index - 1);
+}
+
+/**
+ * Get the number of published elements in the append only vector.
+ */
+size_t append_vector_size(cvector_segmented *vec)
+{
+  return cvector_segmented_size(vec);
+}
+
+/**
+ * Get the capacity of the append only vector.
+ */
+size_t append_vector_capacity(cvector_segmented *vec)
+{
+  return cvector_segmented_capacity(vec);
+}
+
+/**
+ * Push an element to the back of the append only vector.
+ *
+ * Returns the index it was stored at.
+ */
+size_t append_vector_push_back(cvector_segmented *vec, char *fortran_data)
+{
+  return cvector_segmented_push_back(vec, fortran_data) + 1;
+}
+
+/**
+ * Push count contiguous elements to the back of the append only vector.
+ *
+ * Returns the index the first one was stored at.
+ */
+size_t append_vector_push_back_array(cvector_segmented *vec, char *fortran_data, size_t count)
+{
+  return cvector_segmented_push_back_array(vec, fortran_data, count) + 1;
+}
+
+/**
+ * Create a new deque.
+ */
+cvector_deque *new_deque_vector(size_t initial_size, size_t element_size)
+{
+  return cvector_deque_init(initial_size, element_size);
+}
+
+/**
+ * Free the underlying memory of a deque.
+ */
+void destroy_deque_vector(cvector_deque *deque)
+{
+  cvector_deque_free(deque);
+}
+
+/**
+ * Index into the deque. 1 is the front.
+ */
+char *deque_vector_get(cvector_deque *deque, size_t index)
+{
+  return cvector_deque_get(deque, index - 1);
+}
+
+/**
+ * Get the number of elements in the deque.
+ */
+size_t deque_vector_size(cvector_deque *deque)
+{
+  return cvector_deque_size(deque);
+}
+
+/**
+ * Get the capacity of the deque.
+ */
+size_t deque_vector_capacity(cvector_deque *deque)
+{
+  return cvector_deque_capacity(deque);
+}
+
+/**
+ * Push an element to the back of the deque.
+ */
+void deque_vector_push_back(cvector_deque *deque, char *fortran_data)
+{
+  cvector_deque_push_back(deque, fortran_data);
+}
+
+/**
+ * Push an element to the front of the deque.
+ */
+void deque_vector_push_front(cvector_deque *deque, char *fortran_data)
+{
+  cvector_deque_push_front(deque, fortran_data);
+}
+
+/**
+ * Pop the back element of the deque into out. out can be NULL.
+ */
+void deque_vector_pop_back(cvector_deque *deque, char *out)
+{
+  cvector_deque_pop_back(deque, out);
+}
+
+/**
+ * Pop the front element of the deque into out. out can be NULL.
+ */
+void deque_vector_pop_front(cvector_deque *deque, char *out)
+{
+  cvector_deque_pop_front(deque, out);
+}
+
+/**
+ * Clear the deque.
+ */
+void deque_vector_clear(cvector_deque *deque)
+{
+  cvector_deque_clear(deque);
+}
+
+/**
+ * Create a new single producer/single consumer ring.
+ */
+cvector_ring *new_spsc_ring(size_t capacity, size_t element_size)
+{
+  return cvector_ring_init(capacity, element_size);
+}
+
+/**
+ * Free the underlying memory of a ring.
+ */
+void destroy_spsc_ring(cvector_ring *ring)
+{
+  cvector_ring_free(ring);
+}
+
+/**
+ * Push an element into the ring, if there's room. Producer only.
+ */
+bool spsc_ring_try_push(cvector_ring *ring, char *fortran_data)
+{
+  return cvector_ring_try_push(ring, fortran_data);
+}
+
+/**
+ * Pop an element out of the ring, if there is one. Consumer only.
+ */
+bool spsc_ring_try_pop(cvector_ring *ring, char *out)
+{
+  return cvector_ring_try_pop(ring, out);
+}
+
+/**
+ * Get the number of elements waiting in the ring.
+ */
+size_t spsc_ring_size(cvector_ring *ring)
+{
+  return cvector_ring_size(ring);
+}
+
+/**
+ * Get the capacity of the ring.
+ */
+size_t spsc_ring_capacity(cvector_ring *ring)
+{
+  return cvector_ring_capacity(ring);
+}
+
+/**
+ * Create a new allocator table out of Fortran (or C) functions.
+ */
+cvector_allocator *new_vector_allocator(void *(*allocate)(size_t, void *),
+                                        void *(*reallocate)(void *, size_t, size_t, void *),
+                                        void (*free_func)(void *, size_t, void *),
+                                        void *user_data)
+{
+  cvector_allocator *allocator = malloc(sizeof(cvector_allocator));
+  assert(allocator);
+
+  allocator->allocate = allocate;
+  allocator->reallocate = reallocate;
+  allocator->free = free_func;
+  allocator->user_data = user_data;
+
+  return allocator;
+}
+
+/**
+ * Free an allocator table. No vector may still be using it.
+ */
+void destroy_vector_allocator(cvector_allocator *allocator)
+{
+  free(allocator);
+}
+
+/**
+ * Set the allocator vectors get when they're not given one. NULL goes back to malloc.
+ */
+void vector_set_global_allocator(const cvector_allocator *allocator)
+{
+  cvector_set_global_allocator(allocator);
+}
+
+/**
+ * Create a new bump arena.
+ */
+cvector_arena *new_vector_arena(size_t chunk_size)
+{
+  return cvector_arena_init(chunk_size);
+}
+
+/**
+ * Free the arena and every vector in it.
+ */
+void destroy_vector_arena(cvector_arena *arena)
+{
+  cvector_arena_free(arena);
+}
+
+/**
+ * Release every vector in the arena at once.
+ */
+void vector_arena_reset(cvector_arena *arena)
+{
+  cvector_arena_reset(arena);
+}
+
+/**
+ * Get the allocator of an arena, to hand to new_vector.
+ */
+const cvector_allocator *vector_arena_allocator(cvector_arena *arena)
+{
+  return cvector_arena_allocator(arena);
+}
+
+/**
+ * Get the number of bytes the arena has handed out.
+ */
+size_t vector_arena_used(cvector_arena *arena)
+{
+  return cvector_arena_used(arena);
+}
+
+/**
+ * Create a new mmap storage mode.
+ */
+cvector_mmap_storage *new_vector_mmap_storage(size_t reserve_bytes, bool huge_pages)
+{
+  return cvector_mmap_init(reserve_bytes, huge_pages);
+}
+
+/**
+ * Free an mmap storage mode. No vector may still be using it.
+ */
+void destroy_vector_mmap_storage(cvector_mmap_storage *storage)
+{
+  cvector_mmap_free(storage);
+}
+
+/**
+ * Get the allocator of an mmap storage mode, to hand to new_vector.
+ */
+const cvector_allocator *vector_mmap_storage_allocator(cvector_mmap_storage *storage)
+{
+  return cvector_mmap_allocator(storage);
+}
@@ -3,15 +3,67 @@ module fortran_vector_bindings
   implicit none
 
 
+  !* These match cvector_growth_policy in cvector.h.
+  !* Capacity * 2. (The default)
+  integer(c_size_t), parameter :: VEC_GROWTH_DOUBLE = 0
+  !* Capacity * 1.5.
+  integer(c_size_t), parameter :: VEC_GROWTH_FACTOR_1_5 = 1
+  !* Capacity + growth_amount.
+  integer(c_size_t), parameter :: VEC_GROWTH_CHUNK = 2
+  !* Capacity * 2, but never more than growth_amount elements at once.
+  integer(c_size_t), parameter :: VEC_GROWTH_CAPPED = 3
+
+
+  !* These match cvector_radix_kind in cvector_sort.h.
+  integer(c_size_t), parameter :: VEC_RADIX_SIGNED = 0
+  integer(c_size_t), parameter :: VEC_RADIX_UNSIGNED = 1
+  integer(c_size_t), parameter :: VEC_RADIX_REAL = 2
+
+
+  !* These match cvector_io_status in cvector_io.h.
+  integer(c_size_t), parameter :: VEC_IO_OK = 0
+  integer(c_size_t), parameter :: VEC_IO_OPEN_FAILED = 1
+  integer(c_size_t), parameter :: VEC_IO_TRANSFER_FAILED = 2
+  integer(c_size_t), parameter :: VEC_IO_BAD_FILE = 3
+  integer(c_size_t), parameter :: VEC_IO_ELEMENT_SIZE_MISMATCH = 4
+
+
+  !* What a vector with stats on has counted. This matches cvector_stats_counters in cvector_stats.h.
+  !* Get it from stats() on a vec or concurrent_vec.
+  type, bind(c) :: vec_stats
+    !* How many times it reallocated to make room.
+    integer(c_int64_t) :: grows = 0
+    !* Bytes the reallocations had to carry over. (The most realloc might have copied)
+    integer(c_int64_t) :: bytes_copied = 0
+    !* Bytes shifted by insert and remove.
+    integer(c_int64_t) :: memmove_bytes = 0
+    !* Elements the GC ran on.
+    integer(c_int64_t) :: gc_calls = 0
+    !* The most elements it ever had room for.
+    integer(c_int64_t) :: peak_capacity = 0
+    !* Time threads spent waiting on a concurrent_vec's lock.
+    integer(c_int64_t) :: lock_wait_nanoseconds = 0
+  end type vec_stats
+
+
+  !* The size of the C vector header. Element 1 always starts this many bytes after the vector pointer.
+  integer(c_size_t), bind(c, name = "VECTOR_HEADER_SIZE"), protected :: vector_header_size
+
+
   interface
 
 
     !* Create the new C vector memory.
-    function internal_new_vector(initial_size, element_size) result(vec_pointer) bind(c, name = "new_vector")
+    !* If allocator is null, the global allocator is used.
+    !* If alignment is 0, the elements are aligned however the allocator aligns them.
+    function internal_new_vector(initial_size, element_size, allocator, alignment) result(vec_pointer) &
+      bind(c, name = "new_vector")
       use, intrinsic :: iso_c_binding
       implicit none
 
       integer(c_size_t), intent(in), value :: initial_size, element_size
+      type(c_ptr), intent(in), value :: allocator
+      integer(c_size_t), intent(in), value :: alignment
       type(c_ptr) :: vec_pointer
     end function internal_new_vector
 
@@ -36,6 +88,16 @@ module fortran_vector_bindings
     end function internal_vector_get
 
 
+    !* Get the pointer to the start of the contiguous element memory.
+    function internal_vector_data(vec_pointer) result(void_pointer) bind(c, name = "vector_data")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_ptr) :: void_pointer
+    end function internal_vector_data
+
+
     !* Overwrite of an index into the vector.
     subroutine internal_vector_set(vec_pointer, index, fortran_data) bind(c, name = "vector_set")
       use, intrinsic :: iso_c_binding
@@ -108,6 +170,19 @@ module fortran_vector_bindings
     end subroutine internal_vector_insert
 
 
+    !* Insert count contiguous elements into an index of the array.
+    !* This will shift the vector forwards after the index only once.
+    subroutine internal_vector_insert_range(vec_pointer, index, fortran_data, count) bind(c, name = "vector_insert_range")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(inout) :: vec_pointer
+      integer(c_size_t), intent(in), value :: index
+      type(c_ptr), intent(in), value :: fortran_data
+      integer(c_size_t), intent(in), value :: count
+    end subroutine internal_vector_insert_range
+
+
     !* Remove an element from the vector at an index.
     !* This will shift the entire vector back after the index.
     subroutine internal_vector_remove(vec_pointer_pointer, index) bind(c, name = "vector_remove")
@@ -119,6 +194,17 @@ module fortran_vector_bindings
     end subroutine internal_vector_remove
 
 
+    !* Remove all elements from first to last (inclusive) in the vector.
+    !* This will shift the vector back after the range only once.
+    subroutine internal_vector_remove_range(vec_pointer, first, last) bind(c, name = "vector_remove_range")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: first, last
+    end subroutine internal_vector_remove_range
+
+
     !* Uses memcpy under the hood.
     !* Push an element to the back of the vector.
     subroutine internal_vector_push_back(vec_pointer, fortran_data) bind(c, name = "vector_push_back")
@@ -130,6 +216,30 @@ module fortran_vector_bindings
     end subroutine internal_vector_push_back
 
 
+    !* Uses a single memcpy under the hood.
+    !* Push count contiguous elements to the back of the vector.
+    subroutine internal_vector_push_back_array(vec_pointer, fortran_data, count) bind(c, name = "vector_push_back_array")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(inout) :: vec_pointer
+      type(c_ptr), intent(in), value :: fortran_data
+      integer(c_size_t), intent(in), value :: count
+    end subroutine internal_vector_push_back_array
+
+
+    !* Nothing is copied.
+    !* Add count uninitialized elements to the back of the vector, and get the first one.
+    function internal_vector_emplace_back(vec_pointer, count) result(raw_c_pointer) bind(c, name = "vector_emplace_back")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(inout) :: vec_pointer
+      integer(c_size_t), intent(in), value :: count
+      type(c_ptr) :: raw_c_pointer
+    end function internal_vector_emplace_back
+
+
     !* Removes the last element from the vector.
     subroutine internal_vector_pop_back(vec_pointer) bind(c, name = "vector_pop_back")
       use, intrinsic :: iso_c_binding
@@ -139,6 +249,185 @@ module fortran_vector_bindings
     end subroutine internal_vector_pop_back
 
 
+    !* Move the element at index out of the vector, without cleaning it up.
+    subroutine internal_vector_take(vec_pointer, index, out) bind(c, name = "vector_take")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: index
+      type(c_ptr), intent(in), value :: out
+    end subroutine internal_vector_take
+
+
+    !* Move the last element out of the vector, without cleaning it up.
+    subroutine internal_vector_pop_back_into(vec_pointer, out) bind(c, name = "vector_pop_back_into")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_ptr), intent(in), value :: out
+    end subroutine internal_vector_pop_back_into
+
+
+    !* Find the first element with the same bytes as value. 0 if it's not there.
+    function internal_vector_find(vec_pointer, value) result(index) bind(c, name = "vector_find")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      integer(c_size_t) :: index
+    end function internal_vector_find
+
+
+    !* Count the elements with the same bytes as value.
+    function internal_vector_count(vec_pointer, value) result(count) bind(c, name = "vector_count")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      integer(c_size_t) :: count
+    end function internal_vector_count
+
+
+    !* Check if any element has the same bytes as value.
+    function internal_vector_contains(vec_pointer, value) result(contains) bind(c, name = "vector_contains")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      logical(c_bool) :: contains
+    end function internal_vector_contains
+
+
+    !* Overwrite the elements first to last with value.
+    subroutine internal_vector_fill(vec_pointer, first, last, value) bind(c, name = "vector_fill")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: first, last
+      type(c_ptr), intent(in), value :: value
+    end subroutine internal_vector_fill
+
+
+    !* Sort a vector in place with a comparator.
+    subroutine internal_vector_sort(vec_pointer, compare_func) bind(c, name = "vector_sort")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_funptr), intent(in), value :: compare_func
+    end subroutine internal_vector_sort
+
+
+    !* Get the index of the first element that isn't before value, in a sorted vector.
+    function internal_vector_lower_bound(vec_pointer, value, compare_func) result(index) bind(c, name = "vector_lower_bound")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      type(c_funptr), intent(in), value :: compare_func
+      integer(c_size_t) :: index
+    end function internal_vector_lower_bound
+
+
+    !* Find an element equal to value in a sorted vector. 0 if it's not there.
+    function internal_vector_binary_search(vec_pointer, value, compare_func) result(index) &
+        bind(c, name = "vector_binary_search")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      type(c_funptr), intent(in), value :: compare_func
+      integer(c_size_t) :: index
+    end function internal_vector_binary_search
+
+
+    !* Radix sort a vector of 4 or 8 byte numbers in place.
+    subroutine internal_vector_radix_sort(vec_pointer, kind) bind(c, name = "vector_radix_sort")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: kind
+    end subroutine internal_vector_radix_sort
+
+
+    !* Get the index of the first element that isn't less than value, in a radix sorted vector.
+    function internal_vector_radix_lower_bound(vec_pointer, value, kind) result(index) bind(c, name = "vector_radix_lower_bound")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      integer(c_size_t), intent(in), value :: kind
+      integer(c_size_t) :: index
+    end function internal_vector_radix_lower_bound
+
+
+    !* Find an element with the same bits as value in a radix sorted vector. 0 if it's not there.
+    function internal_vector_radix_binary_search(vec_pointer, value, kind) result(index) &
+        bind(c, name = "vector_radix_binary_search")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer, value
+      integer(c_size_t), intent(in), value :: kind
+      integer(c_size_t) :: index
+    end function internal_vector_radix_binary_search
+
+
+    !* Set how many threads parallel jobs use, counting the caller. 0 is one per core.
+    subroutine internal_vector_parallel_set_thread_count(thread_count) bind(c, name = "vector_parallel_set_thread_count")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: thread_count
+    end subroutine internal_vector_parallel_set_thread_count
+
+
+    !* Call func on every chunk of the vector, in parallel.
+    subroutine internal_vector_parallel_for_each(vec_pointer, chunk_size, func, user_data) &
+        bind(c, name = "vector_parallel_for_each")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: chunk_size
+      type(c_funptr), intent(in), value :: func
+      type(c_ptr), intent(in), value :: user_data
+    end subroutine internal_vector_parallel_for_each
+
+
+    !* Call func on every chunk of the vector and the matching chunk of output, in parallel.
+    subroutine internal_vector_parallel_transform(vec_pointer, output_pointer, chunk_size, func, user_data) &
+        bind(c, name = "vector_parallel_transform")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_ptr), intent(inout) :: output_pointer
+      integer(c_size_t), intent(in), value :: chunk_size
+      type(c_funptr), intent(in), value :: func
+      type(c_ptr), intent(in), value :: user_data
+    end subroutine internal_vector_parallel_transform
+
+
+    !* Reduce the vector, in parallel.
+    subroutine internal_vector_parallel_reduce(vec_pointer, chunk_size, func, combine_func, init, result, result_size, &
+        user_data) bind(c, name = "vector_parallel_reduce")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: chunk_size
+      type(c_funptr), intent(in), value :: func, combine_func
+      type(c_ptr), intent(in), value :: init, result
+      integer(c_size_t), intent(in), value :: result_size
+      type(c_ptr), intent(in), value :: user_data
+    end subroutine internal_vector_parallel_reduce
+
+
     !* Request a vector to reallocate to the new capacity.
     subroutine internal_vector_reserve(vec_pointer, new_capacity) bind(c, name = "vector_reserve")
       use, intrinsic :: iso_c_binding
@@ -149,6 +438,16 @@ module fortran_vector_bindings
     end subroutine internal_vector_reserve
 
 
+    !* Choose how the vector grows when it runs out of room.
+    subroutine internal_vector_set_growth_policy(vec_pointer, policy, amount) bind(c, name = "vector_set_growth_policy")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: policy, amount
+    end subroutine internal_vector_set_growth_policy
+
+
     !* Resize a vector to a new size.
     !* Requires a new default element.
     subroutine internal_vector_resize(vec_pointer, new_size, default_fortran_data) bind(c, name = "vector_resize")
@@ -181,19 +480,781 @@ module fortran_vector_bindings
     end subroutine internal_vector_clone
 
 
-!? BEGIN FUNCTION BLUEPRINTS ==================================================
+    !* Add an owner to a vector's memory, for copy on write. Gives back the same pointer.
+    function internal_vector_share(vec_pointer) result(shared_pointer) bind(c, name = "vector_share")
+      use, intrinsic :: iso_c_binding
+      implicit none
 
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_ptr) :: shared_pointer
+    end function internal_vector_share
 
-    !* If your type uses pointers, I suggest you give your vector a GC.
-    !*
-    !* The raw_c_pointer is the element in the array. You'll be getting it
-    !* right before it's freed from C memory.
-    subroutine vec_gc_blueprint(raw_c_pointer)
+
+    !* Check if more than one owner has a vector's memory.
+    function internal_vector_is_shared(vec_pointer) result(shared) bind(c, name = "vector_is_shared")
       use, intrinsic :: iso_c_binding
       implicit none
 
-      type(c_ptr), intent(in), value :: raw_c_pointer
-    end subroutine vec_gc_blueprint
+      type(c_ptr), intent(in), value :: vec_pointer
+      logical(c_bool) :: shared
+    end function internal_vector_is_shared
+
+
+    !* Give this owner a copy of its own, if the memory is shared.
+    subroutine internal_vector_unshare(vec_pointer) bind(c, name = "vector_unshare")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(inout) :: vec_pointer
+    end subroutine internal_vector_unshare
+
+
+    !* Sort the pending keys of a flat set or map, merge them into the sorted ones, and drop duplicates.
+    !* The kept keys end up sorted at the front, the dropped ones after them. Values (if any) move with their keys.
+    !* Returns how many keys are kept.
+    function internal_vector_flat_merge(keys, key_size, values, value_size, count, sorted_count, compare_func) &
+      result(kept) bind(c, name = "vector_flat_merge")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: keys, values
+      integer(c_size_t), intent(in), value :: key_size, value_size, count, sorted_count
+      type(c_funptr), intent(in), value :: compare_func
+      integer(c_size_t) :: kept
+    end function internal_vector_flat_merge
+
+
+    !* Start counting a vector's grows, copies, and shifts.
+    !* An empty name leaves it unnamed.
+    subroutine internal_vector_enable_stats(vec_pointer, name) bind(c, name = "vector_enable_stats")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      character(kind = c_char), dimension(*), intent(in) :: name
+    end subroutine internal_vector_enable_stats
+
+
+    !* Copy out a vector's counters. Gives back .false. if stats are off.
+    function internal_vector_stats(vec_pointer, counters) result(enabled) bind(c, name = "vector_get_stats")
+      use, intrinsic :: iso_c_binding
+      import :: vec_stats
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(vec_stats), intent(inout) :: counters
+      logical(c_bool) :: enabled
+    end function internal_vector_stats
+
+
+    !* Count elements the GC ran on, if stats are on.
+    subroutine internal_vector_stats_record_gc_calls(vec_pointer, count) bind(c, name = "vector_stats_record_gc_calls")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: count
+    end subroutine internal_vector_stats_record_gc_calls
+
+
+    !* Count time spent waiting for a lock, if stats are on.
+    subroutine internal_vector_stats_record_lock_wait(vec_pointer, nanoseconds) bind(c, name = "vector_stats_record_lock_wait")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_int64_t), intent(in), value :: nanoseconds
+    end subroutine internal_vector_stats_record_lock_wait
+
+
+    !* A monotonic clock in nanoseconds, for timing lock waits.
+    function internal_vector_stats_clock() result(nanoseconds) bind(c, name = "vector_stats_clock")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_int64_t) :: nanoseconds
+    end function internal_vector_stats_clock
+
+
+    !* Print every vector that has stats on, to stdout.
+    subroutine internal_vector_stats_dump() bind(c, name = "vector_stats_dump")
+      use, intrinsic :: iso_c_binding
+      implicit none
+    end subroutine internal_vector_stats_dump
+
+
+    !* Create a new allocator table out of bind(c) functions.
+    function internal_new_vector_allocator(allocate_func, reallocate_func, free_func, user_data) result(allocator) &
+      bind(c, name = "new_vector_allocator")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_funptr), intent(in), value :: allocate_func, reallocate_func, free_func
+      type(c_ptr), intent(in), value :: user_data
+      type(c_ptr) :: allocator
+    end function internal_new_vector_allocator
+
+
+    !* Destroy an allocator table.
+    subroutine internal_destroy_vector_allocator(allocator) bind(c, name = "destroy_vector_allocator")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: allocator
+    end subroutine internal_destroy_vector_allocator
+
+
+    !* Set the allocator vectors get when they're not given one.
+    !* A null pointer goes back to malloc.
+    subroutine internal_vector_set_global_allocator(allocator) bind(c, name = "vector_set_global_allocator")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: allocator
+    end subroutine internal_vector_set_global_allocator
+
+
+    !* Write a vector to a file. path must be null terminated.
+    function internal_vector_save(vec_pointer, path) result(status) bind(c, name = "vector_save")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      character(kind = c_char), dimension(*), intent(in) :: path
+      integer(c_size_t) :: status
+    end function internal_vector_save
+
+
+    !* Replace a vector's elements with the ones in a file. path must be null terminated.
+    function internal_vector_load(vec_pointer, path) result(status) bind(c, name = "vector_load")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(inout) :: vec_pointer
+      character(kind = c_char), dimension(*), intent(in) :: path
+      integer(c_size_t) :: status
+    end function internal_vector_load
+
+
+    !* Map a file as a read only vector. path must be null terminated.
+    function internal_vector_map_readonly(path, vec_pointer) result(status) bind(c, name = "vector_map_readonly")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      character(kind = c_char), dimension(*), intent(in) :: path
+      type(c_ptr), intent(inout) :: vec_pointer
+      integer(c_size_t) :: status
+    end function internal_vector_map_readonly
+
+
+    !* Create a file to stream elements into. path must be null terminated.
+    function internal_new_vector_stream_writer(path, element_size, chunk_size, writer) result(status) &
+        bind(c, name = "new_vector_stream_writer")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      character(kind = c_char), dimension(*), intent(in) :: path
+      integer(c_size_t), intent(in), value :: element_size, chunk_size
+      type(c_ptr), intent(inout) :: writer
+      integer(c_size_t) :: status
+    end function internal_new_vector_stream_writer
+
+
+    !* Push an element onto the end of a stream.
+    subroutine internal_vector_stream_writer_push_back(writer, fortran_data) bind(c, name = "vector_stream_writer_push_back")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: writer
+      type(c_ptr), intent(in), value :: fortran_data
+    end subroutine internal_vector_stream_writer_push_back
+
+
+    !* Push count contiguous elements onto the end of a stream.
+    subroutine internal_vector_stream_writer_push_back_array(writer, fortran_data, count) &
+        bind(c, name = "vector_stream_writer_push_back_array")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: writer
+      type(c_ptr), intent(in), value :: fortran_data
+      integer(c_size_t), intent(in), value :: count
+    end subroutine internal_vector_stream_writer_push_back_array
+
+
+    !* Get how many elements have been pushed onto a stream.
+    function internal_vector_stream_writer_size(writer) result(stream_size) bind(c, name = "vector_stream_writer_size")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: writer
+      integer(c_size_t) :: stream_size
+    end function internal_vector_stream_writer_size
+
+
+    !* Finish the file, and free the writer.
+    function internal_destroy_vector_stream_writer(writer) result(status) bind(c, name = "destroy_vector_stream_writer")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: writer
+      integer(c_size_t) :: status
+    end function internal_destroy_vector_stream_writer
+
+
+    !* Open a file to stream elements out of. path must be null terminated.
+    function internal_new_vector_stream_reader(path, element_size, chunk_size, reader) result(status) &
+        bind(c, name = "new_vector_stream_reader")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      character(kind = c_char), dimension(*), intent(in) :: path
+      integer(c_size_t), intent(in), value :: element_size, chunk_size
+      type(c_ptr), intent(inout) :: reader
+      integer(c_size_t) :: status
+    end function internal_new_vector_stream_reader
+
+
+    !* Get the next chunk of a stream. Gives back .false. when it's done.
+    function internal_vector_stream_reader_next(reader, chunk, count) result(got) bind(c, name = "vector_stream_reader_next")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: reader
+      type(c_ptr), intent(inout) :: chunk
+      integer(c_size_t), intent(inout) :: count
+      logical(c_bool) :: got
+    end function internal_vector_stream_reader_next
+
+
+    !* Get the number of elements in the whole stream.
+    function internal_vector_stream_reader_size(reader) result(stream_size) bind(c, name = "vector_stream_reader_size")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: reader
+      integer(c_size_t) :: stream_size
+    end function internal_vector_stream_reader_size
+
+
+    !* Get the first error a stream reader ran into.
+    function internal_vector_stream_reader_status(reader) result(status) bind(c, name = "vector_stream_reader_status")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: reader
+      integer(c_size_t) :: status
+    end function internal_vector_stream_reader_status
+
+
+    !* Free a stream reader.
+    subroutine internal_destroy_vector_stream_reader(reader) bind(c, name = "destroy_vector_stream_reader")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: reader
+    end subroutine internal_destroy_vector_stream_reader
+
+
+    !* Create a new bump arena.
+    function internal_new_vector_arena(chunk_size) result(arena) bind(c, name = "new_vector_arena")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: chunk_size
+      type(c_ptr) :: arena
+    end function internal_new_vector_arena
+
+
+    !* Destroy a bump arena and every vector in it.
+    subroutine internal_destroy_vector_arena(arena) bind(c, name = "destroy_vector_arena")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: arena
+    end subroutine internal_destroy_vector_arena
+
+
+    !* Release every vector in a bump arena at once.
+    subroutine internal_vector_arena_reset(arena) bind(c, name = "vector_arena_reset")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: arena
+    end subroutine internal_vector_arena_reset
+
+
+    !* Get the allocator of a bump arena.
+    function internal_vector_arena_allocator(arena) result(allocator) bind(c, name = "vector_arena_allocator")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: arena
+      type(c_ptr) :: allocator
+    end function internal_vector_arena_allocator
+
+
+    !* Get the number of bytes a bump arena has handed out.
+    function internal_vector_arena_used(arena) result(used) bind(c, name = "vector_arena_used")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: arena
+      integer(c_size_t) :: used
+    end function internal_vector_arena_used
+
+
+    !* Create a new mmap storage mode.
+    function internal_new_vector_mmap_storage(reserve_bytes, huge_pages) result(storage) &
+        bind(c, name = "new_vector_mmap_storage")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: reserve_bytes
+      logical(c_bool), intent(in), value :: huge_pages
+      type(c_ptr) :: storage
+    end function internal_new_vector_mmap_storage
+
+
+    !* Destroy an mmap storage mode.
+    subroutine internal_destroy_vector_mmap_storage(storage) bind(c, name = "destroy_vector_mmap_storage")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: storage
+    end subroutine internal_destroy_vector_mmap_storage
+
+
+    !* Get the allocator of an mmap storage mode.
+    function internal_vector_mmap_storage_allocator(storage) result(allocator) bind(c, name = "vector_mmap_storage_allocator")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: storage
+      type(c_ptr) :: allocator
+    end function internal_vector_mmap_storage_allocator
+
+
+    !* Create the new C append only vector memory.
+    function internal_new_append_vector(first_segment_size, element_size) result(vec_pointer) bind(c, name = "new_append_vector")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: first_segment_size, element_size
+      type(c_ptr) :: vec_pointer
+    end function internal_new_append_vector
+
+
+    !* Destroy C append only vector memory.
+    subroutine internal_destroy_append_vector(vec_pointer) bind(c, name = "destroy_append_vector")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+    end subroutine internal_destroy_append_vector
+
+
+    !* Get the pointer of an index into the append only vector.
+    !* This will be null if the index hasn't been published yet.
+    function internal_append_vector_get(vec_pointer, index) result(void_pointer) bind(c, name = "append_vector_get")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t), intent(in), value :: index
+      type(c_ptr) :: void_pointer
+    end function internal_append_vector_get
+
+
+    !* Get the number of published elements in the append only vector.
+    function internal_append_vector_size(vec_pointer) result(vec_size) bind(c, name = "append_vector_size")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t) :: vec_size
+    end function internal_append_vector_size
+
+
+    !* Get the capacity of the append only vector.
+    function internal_append_vector_capacity(vec_pointer) result(vec_cap) bind(c, name = "append_vector_capacity")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      integer(c_size_t) :: vec_cap
+    end function internal_append_vector_capacity
+
+
+    !* Push an element to the back of the append only vector.
+    !* Gives back the index it was stored at.
+    function internal_append_vector_push_back(vec_pointer, fortran_data) result(index) bind(c, name = "append_vector_push_back")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_ptr), intent(in), value :: fortran_data
+      integer(c_size_t) :: index
+    end function internal_append_vector_push_back
+
+
+    !* Push count contiguous elements to the back of the append only vector.
+    !* Gives back the index the first one was stored at.
+    function internal_append_vector_push_back_array(vec_pointer, fortran_data, count) result(index) &
+      bind(c, name = "append_vector_push_back_array")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: vec_pointer
+      type(c_ptr), intent(in), value :: fortran_data
+      integer(c_size_t), intent(in), value :: count
+      integer(c_size_t) :: index
+    end function internal_append_vector_push_back_array
+
+
+    !* Create the new C deque memory.
+    function internal_new_deque_vector(initial_size, element_size) result(deque_pointer) bind(c, name = "new_deque_vector")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: initial_size, element_size
+      type(c_ptr) :: deque_pointer
+    end function internal_new_deque_vector
+
+
+    !* Destroy C deque memory.
+    subroutine internal_destroy_deque_vector(deque_pointer) bind(c, name = "destroy_deque_vector")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+    end subroutine internal_destroy_deque_vector
+
+
+    !* Get the pointer of an index into the deque. 1 is the front.
+    !* This will be null if the index is out of bounds.
+    function internal_deque_vector_get(deque_pointer, index) result(void_pointer) bind(c, name = "deque_vector_get")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      integer(c_size_t), intent(in), value :: index
+      type(c_ptr) :: void_pointer
+    end function internal_deque_vector_get
+
+
+    !* Get the number of elements in the deque.
+    function internal_deque_vector_size(deque_pointer) result(deque_size) bind(c, name = "deque_vector_size")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      integer(c_size_t) :: deque_size
+    end function internal_deque_vector_size
+
+
+    !* Get the capacity of the deque.
+    function internal_deque_vector_capacity(deque_pointer) result(deque_cap) bind(c, name = "deque_vector_capacity")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      integer(c_size_t) :: deque_cap
+    end function internal_deque_vector_capacity
+
+
+    !* Push an element to the back of the deque.
+    subroutine internal_deque_vector_push_back(deque_pointer, fortran_data) bind(c, name = "deque_vector_push_back")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      type(c_ptr), intent(in), value :: fortran_data
+    end subroutine internal_deque_vector_push_back
+
+
+    !* Push an element to the front of the deque.
+    subroutine internal_deque_vector_push_front(deque_pointer, fortran_data) bind(c, name = "deque_vector_push_front")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      type(c_ptr), intent(in), value :: fortran_data
+    end subroutine internal_deque_vector_push_front
+
+
+    !* Pop the back element of the deque into out. out can be c_null_ptr.
+    subroutine internal_deque_vector_pop_back(deque_pointer, out) bind(c, name = "deque_vector_pop_back")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      type(c_ptr), intent(in), value :: out
+    end subroutine internal_deque_vector_pop_back
+
+
+    !* Pop the front element of the deque into out. out can be c_null_ptr.
+    subroutine internal_deque_vector_pop_front(deque_pointer, out) bind(c, name = "deque_vector_pop_front")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+      type(c_ptr), intent(in), value :: out
+    end subroutine internal_deque_vector_pop_front
+
+
+    !* Clear the deque.
+    subroutine internal_deque_vector_clear(deque_pointer) bind(c, name = "deque_vector_clear")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: deque_pointer
+    end subroutine internal_deque_vector_clear
+
+
+    !* Create the new C single producer/single consumer ring memory.
+    function internal_new_spsc_ring(capacity, element_size) result(ring_pointer) bind(c, name = "new_spsc_ring")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: capacity, element_size
+      type(c_ptr) :: ring_pointer
+    end function internal_new_spsc_ring
+
+
+    !* Destroy C ring memory.
+    subroutine internal_destroy_spsc_ring(ring_pointer) bind(c, name = "destroy_spsc_ring")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: ring_pointer
+    end subroutine internal_destroy_spsc_ring
+
+
+    !* Push an element into the ring, if there's room. Producer only.
+    function internal_spsc_ring_try_push(ring_pointer, fortran_data) result(pushed) bind(c, name = "spsc_ring_try_push")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: ring_pointer
+      type(c_ptr), intent(in), value :: fortran_data
+      logical(c_bool) :: pushed
+    end function internal_spsc_ring_try_push
+
+
+    !* Pop an element out of the ring into out, if there is one. Consumer only.
+    function internal_spsc_ring_try_pop(ring_pointer, out) result(popped) bind(c, name = "spsc_ring_try_pop")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: ring_pointer
+      type(c_ptr), intent(in), value :: out
+      logical(c_bool) :: popped
+    end function internal_spsc_ring_try_pop
+
+
+    !* Get the number of elements waiting in the ring.
+    function internal_spsc_ring_size(ring_pointer) result(ring_size) bind(c, name = "spsc_ring_size")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: ring_pointer
+      integer(c_size_t) :: ring_size
+    end function internal_spsc_ring_size
+
+
+    !* Get the capacity of the ring.
+    function internal_spsc_ring_capacity(ring_pointer) result(ring_cap) bind(c, name = "spsc_ring_capacity")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: ring_pointer
+      integer(c_size_t) :: ring_cap
+    end function internal_spsc_ring_capacity
+
+
+    !* Create a new reader/writer lock.
+    function internal_vector_rwlock_create() result(rwlock_pointer) bind(c, name = "vector_rwlock_create")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr) :: rwlock_pointer
+    end function internal_vector_rwlock_create
+
+
+    !* Destroy a reader/writer lock.
+    subroutine internal_vector_rwlock_destroy(rwlock_pointer) bind(c, name = "vector_rwlock_destroy")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: rwlock_pointer
+    end subroutine internal_vector_rwlock_destroy
+
+
+    !* Take shared (read) access of a reader/writer lock.
+    function internal_vector_rwlock_lock_shared(rwlock_pointer) result(status) bind(c, name = "vector_rwlock_lock_shared")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: rwlock_pointer
+      integer(c_int) :: status
+    end function internal_vector_rwlock_lock_shared
+
+
+    !* Take exclusive (write) access of a reader/writer lock.
+    function internal_vector_rwlock_lock_exclusive(rwlock_pointer) result(status) bind(c, name = "vector_rwlock_lock_exclusive")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: rwlock_pointer
+      integer(c_int) :: status
+    end function internal_vector_rwlock_lock_exclusive
+
+
+    !* Release either kind of access of a reader/writer lock.
+    function internal_vector_rwlock_unlock(rwlock_pointer) result(status) bind(c, name = "vector_rwlock_unlock")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: rwlock_pointer
+      integer(c_int) :: status
+    end function internal_vector_rwlock_unlock
+
+
+    !* Straight to the C library memcpy.
+    !* This skips going through the vector functions when Fortran already knows where to copy to.
+    subroutine internal_memcpy(destination, source, byte_count) bind(c, name = "memcpy")
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: destination, source
+      integer(c_size_t), intent(in), value :: byte_count
+    end subroutine internal_memcpy
+
+
+!? BEGIN FUNCTION BLUEPRINTS ==================================================
+
+
+    !* If your type uses pointers, I suggest you give your vector a GC.
+    !*
+    !* The raw_c_pointer is the element in the array. You'll be getting it
+    !* right before it's freed from C memory.
+    subroutine vec_gc_blueprint(raw_c_pointer)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: raw_c_pointer
+    end subroutine vec_gc_blueprint
+
+
+    !* This is a blueprint for a GC that cleans up a whole range of elements at once.
+    !*
+    !* base_pointer is the first element of the range, and the rest follow it
+    !* contiguously, element_size bytes apart. You get each range once, right before
+    !* it's freed from C memory, so you can loop over it natively.
+    subroutine vec_gc_range_blueprint(base_pointer, count, element_size)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: base_pointer
+      integer(c_size_t), intent(in), value :: count, element_size
+    end subroutine vec_gc_range_blueprint
+
+
+    !* This is a blueprint for comparing two elements, for sort and binary search.
+    !*
+    !* a and b point at elements in the vector.
+    !* Return a negative number if a goes before b, 0 if they're equal, or a positive number if a goes after b.
+    function vec_compare_blueprint(a, b) result(order) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: a, b
+      integer(c_int) :: order
+    end function vec_compare_blueprint
+
+
+    !* This is a blueprint for working on a span of elements, for parallel_for_each.
+    !*
+    !* base_pointer is the first element of the span, and the rest follow it contiguously.
+    !* Spans run on different threads at the same time, so only touch your own span.
+    subroutine vec_span_blueprint(base_pointer, count, user_data) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: base_pointer
+      integer(c_size_t), intent(in), value :: count
+      type(c_ptr), intent(in), value :: user_data
+    end subroutine vec_span_blueprint
+
+
+    !* This is a blueprint for parallel_transform.
+    !*
+    !* Read count elements from input_pointer, write count elements to output_pointer.
+    subroutine vec_transform_blueprint(input_pointer, output_pointer, count, user_data) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: input_pointer, output_pointer
+      integer(c_size_t), intent(in), value :: count
+      type(c_ptr), intent(in), value :: user_data
+    end subroutine vec_transform_blueprint
+
+
+    !* This is a blueprint for folding a span of elements into an accumulator, for parallel_reduce.
+    subroutine vec_reduce_blueprint(base_pointer, count, accumulator, user_data) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: base_pointer
+      integer(c_size_t), intent(in), value :: count
+      type(c_ptr), intent(in), value :: accumulator, user_data
+    end subroutine vec_reduce_blueprint
+
+
+    !* This is a blueprint for folding one accumulator (partial) into another (accumulator), for parallel_reduce.
+    subroutine vec_combine_blueprint(accumulator, partial, user_data) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: accumulator, partial, user_data
+    end subroutine vec_combine_blueprint
+
+
+    !* Allocate size bytes for a vector.
+    !* user_data is whatever you gave to new_vec_allocator.
+    function vec_allocate_blueprint(size, user_data) result(memory) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      integer(c_size_t), intent(in), value :: size
+      type(c_ptr), intent(in), value :: user_data
+      type(c_ptr) :: memory
+    end function vec_allocate_blueprint
+
+
+    !* Grow or shrink a vector's memory from old_size to new_size bytes.
+    !* The contents must be preserved, like realloc.
+    function vec_reallocate_blueprint(memory, old_size, new_size, user_data) result(new_memory) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: memory
+      integer(c_size_t), intent(in), value :: old_size, new_size
+      type(c_ptr), intent(in), value :: user_data
+      type(c_ptr) :: new_memory
+    end function vec_reallocate_blueprint
+
+
+    !* Free a vector's memory of size bytes.
+    subroutine vec_free_blueprint(memory, size, user_data) bind(c)
+      use, intrinsic :: iso_c_binding
+      implicit none
+
+      type(c_ptr), intent(in), value :: memory
+      integer(c_size_t), intent(in), value :: size
+      type(c_ptr), intent(in), value :: user_data
+    end subroutine vec_free_blueprint
 
 
   end interface
@@ -0,0 +1,273 @@
+module sharded_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector
+  implicit none
+
+
+  private
+
+
+  public :: sharded_vec
+  public :: new_sharded_vec
+
+
+  !* One plain C vector per thread.
+  !* Padded out to a cache line so threads growing their own shard don't fight over it.
+  type :: vec_shard
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_int8_t), dimension(56) :: padding = 0
+  end type vec_shard
+
+
+  !* A vector split up into one shard per thread.
+  !*
+  !* Each thread only ever touches its own shard, so pushing needs no synchronization at all.
+  !* Use your OpenMP thread number (+1) or your forthread id as the shard.
+  !* When everyone is done, flatten() gathers all the shards into one contiguous vec.
+  type :: sharded_vec
+    private
+    type(vec_shard), dimension(:), allocatable :: shards
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => sharded_vector_destroy
+    procedure :: shard_count => sharded_vector_shard_count
+    procedure :: shard_size => sharded_vector_shard_size
+    procedure :: size => sharded_vector_size
+    procedure :: push_back => sharded_vector_push_back
+    procedure :: push_back_array => sharded_vector_push_back_array
+    procedure :: clear => sharded_vector_clear
+    procedure :: flatten => sharded_vector_flatten
+  end type sharded_vec
+
+
+contains
+
+
+  !* Create a new sharded vector with shard_count shards.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* initial_size is the capacity each shard reserves.
+  function new_sharded_vec(size_of_type, shard_count, initial_size, optional_gc_func) result(v)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, initial_size
+    integer(c_int), intent(in), value :: shard_count
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(sharded_vec) :: v
+    integer(c_int) :: i
+
+    if (shard_count < 1) then
+      error stop "[Vector] Error: A sharded vector needs at least one shard."
+    end if
+
+    ! This will automatically clean your memory upon deletion.
+    if (present(optional_gc_func)) then
+      v%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    allocate(v%shards(shard_count))
+
+    do i = 1, shard_count
+      v%shards(i)%data = internal_new_vector(initial_size, size_of_type, c_null_ptr, 0_c_size_t)
+    end do
+
+    v%size_of_type = size_of_type
+  end function new_sharded_vec
+
+
+  !* Destroy all components of the vector. Elements and underlying C memory.
+  !* Make sure no other thread is still using the vector when you call this.
+  subroutine sharded_vector_destroy(this)
+    implicit none
+
+    class(sharded_vec), intent(inout) :: this
+    integer(c_int) :: i
+
+    if (.not. allocated(this%shards)) then
+      return
+    end if
+
+    call this%clear()
+
+    do i = 1, size(this%shards)
+      call internal_destroy_vector(this%shards(i)%data)
+    end do
+
+    deallocate(this%shards)
+
+    this%size_of_type = 0
+  end subroutine sharded_vector_destroy
+
+
+  !* Get the number of shards.
+  function sharded_vector_shard_count(this) result(count)
+    implicit none
+
+    class(sharded_vec), intent(in) :: this
+    integer(c_int) :: count
+
+    if (.not. allocated(this%shards)) then
+      count = 0
+    else
+      count = size(this%shards)
+    end if
+  end function sharded_vector_shard_count
+
+
+  !* Get the number of elements in one shard.
+  function sharded_vector_shard_size(this, shard) result(size)
+    implicit none
+
+    class(sharded_vec), intent(in) :: this
+    integer(c_int), intent(in), value :: shard
+    integer(c_size_t) :: size
+
+    call check_shard(this, shard)
+
+    size = internal_vector_size(this%shards(shard)%data)
+  end function sharded_vector_shard_size
+
+
+  !* Get the number of elements in all shards combined.
+  !* Only reliable when no thread is pushing.
+  function sharded_vector_size(this) result(size)
+    implicit none
+
+    class(sharded_vec), intent(in) :: this
+    integer(c_size_t) :: size
+    integer(c_int) :: i
+
+    size = 0
+
+    do i = 1, this%shard_count()
+      size = size + internal_vector_size(this%shards(i)%data)
+    end do
+  end function sharded_vector_size
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element to the back of a shard.
+  !* Only one thread may use a shard at a time.
+  subroutine sharded_vector_push_back(this, shard, fortran_data)
+    implicit none
+
+    class(sharded_vec), intent(inout) :: this
+    integer(c_int), intent(in), value :: shard
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    call check_shard(this, shard)
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_vector_push_back(this%shards(shard)%data, black_magic)
+  end subroutine sharded_vector_push_back
+
+
+  !* Uses a single memcpy under the hood.
+  !* Push a whole contiguous Fortran array to the back of a shard.
+  !* Only one thread may use a shard at a time.
+  subroutine sharded_vector_push_back_array(this, shard, fortran_data)
+    implicit none
+
+    class(sharded_vec), intent(inout) :: this
+    integer(c_int), intent(in), value :: shard
+    class(*), dimension(:), intent(in), target, contiguous :: fortran_data
+    type(c_ptr) :: black_magic
+
+    call check_shard(this, shard)
+
+    if (size(fortran_data) == 0) then
+      return
+    end if
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_vector_push_back_array(this%shards(shard)%data, black_magic, int(size(fortran_data), c_size_t))
+  end subroutine sharded_vector_push_back_array
+
+
+  !* Clear all the elements from every shard.
+  !* The GC function will run on each element.
+  subroutine sharded_vector_clear(this)
+    implicit none
+
+    class(sharded_vec), intent(inout) :: this
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_int) :: i
+    integer(c_size_t) :: j
+
+    do i = 1, this%shard_count()
+      if (c_associated(this%gc_func)) then
+        call c_f_procpointer(this%gc_func, optional_gc)
+
+        do j = 1, internal_vector_size(this%shards(i)%data)
+          call optional_gc(internal_vector_get(this%shards(i)%data, j))
+        end do
+      end if
+
+      call internal_vector_clear(this%shards(i)%data)
+    end do
+  end subroutine sharded_vector_clear
+
+
+  !* Gather every shard, in shard order, into one new contiguous vector.
+  !* The total size is computed first so the output only allocates once,
+  !* then each shard is copied in with a single memcpy.
+  !*
+  !* The elements are moved, not copied. The shards are left empty
+  !* and the new vector takes over the GC function.
+  function sharded_vector_flatten(this) result(v)
+    implicit none
+
+    class(sharded_vec), intent(inout) :: this
+    type(vec) :: v
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_size_t) :: total_size, shard_size
+    integer(c_int) :: i
+
+    total_size = this%size()
+
+    if (c_associated(this%gc_func)) then
+      call c_f_procpointer(this%gc_func, optional_gc)
+      v = new_vec(this%size_of_type, total_size, optional_gc)
+    else
+      v = new_vec(this%size_of_type, total_size)
+    end if
+
+    call v%reserve(total_size)
+
+    do i = 1, this%shard_count()
+      shard_size = internal_vector_size(this%shards(i)%data)
+
+      if (shard_size == 0) then
+        cycle
+      end if
+
+      call v%append_n(internal_vector_get(this%shards(i)%data, 1_8), shard_size)
+
+      ! Ownership moved into v, so no GC here.
+      call internal_vector_clear(this%shards(i)%data)
+    end do
+  end function sharded_vector_flatten
+
+
+!? BEGIN INTERNAL ONLY ==============================================
+
+  subroutine check_shard(this, shard)
+    implicit none
+
+    type(sharded_vec), intent(in) :: this
+    integer(c_int), intent(in), value :: shard
+
+    if (shard < 1 .or. shard > this%shard_count()) then
+      error stop "[Vector] Error: Shard out of bounds."
+    end if
+  end subroutine check_shard
+
+
+end module sharded_vector
@@ -0,0 +1,330 @@
+module slot_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector
+  use :: vector_i64
+  implicit none
+
+
+  private
+
+
+  public :: slot_vec
+  public :: slot_handle
+  public :: new_slot_vec
+
+
+  !* A handle to an element in a slot_vec.
+  !* It stays valid until that element is removed, no matter what else is inserted or removed.
+  !* After that, the generation no longer matches, so the slot_vec can tell it's stale.
+  type :: slot_handle
+    integer(c_int64_t) :: slot = 0
+    integer(c_int64_t) :: generation = 0
+  end type slot_handle
+
+
+  !* A slot map.
+  !*
+  !* Insert gives you a handle, and remove is O(1). Nothing else moves from your point of view,
+  !* so handles you keep elsewhere never need to be rebuilt.
+  !* Underneath, the elements are packed densely in a vec, so iterating is a plain loop
+  !* over 1 to size(). (See get_dense and handle_at)
+  !*
+  !! Removing moves the last element into the hole, so dense indices (and pointers) do change.
+  !! Only handles are stable.
+  type :: slot_vec
+    private
+    ! The elements, packed.
+    type(vec) :: dense
+    ! Which slot each dense element belongs to.
+    type(vec_i64) :: dense_to_slot
+    ! For a live slot, its dense index. For a free slot, the next free slot.
+    type(vec_i64) :: slot_index
+    type(vec_i64) :: slot_generation
+    ! 0 means there are no free slots.
+    integer(c_int64_t) :: free_head = 0
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => slot_vector_destroy
+    procedure :: insert => slot_vector_insert
+    procedure :: remove => slot_vector_remove
+    procedure :: get => slot_vector_get
+    procedure :: contains => slot_vector_contains
+    procedure :: get_dense => slot_vector_get_dense
+    procedure :: handle_at => slot_vector_handle_at
+    procedure :: data_ptr => slot_vector_data_ptr
+    procedure :: size => slot_vector_size
+    procedure :: is_empty => slot_vector_is_empty
+    procedure :: clear => slot_vector_clear
+  end type slot_vec
+
+
+contains
+
+
+  !* Create a new slot map.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  function new_slot_vec(size_of_type, initial_size, optional_gc_func) result(v)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, initial_size
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(slot_vec) :: v
+
+    ! This will automatically clean your memory upon deletion.
+    ! The slot_vec runs it, so the dense vec doesn't get one.
+    if (present(optional_gc_func)) then
+      v%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    v%dense = new_vec(size_of_type, initial_size)
+    v%dense_to_slot = new_vec_i64(initial_size)
+    v%slot_index = new_vec_i64(initial_size)
+    v%slot_generation = new_vec_i64(initial_size)
+    v%size_of_type = size_of_type
+  end function new_slot_vec
+
+
+  !* Destroy all components of the slot map. Elements and underlying C memory.
+  !* Every handle is stale after this.
+  subroutine slot_vector_destroy(this)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+
+    if (this%size_of_type == 0) then
+      return
+    end if
+
+    call run_gc(this, 1_8, this%dense%size())
+
+    call this%dense%destroy()
+    call this%dense_to_slot%destroy()
+    call this%slot_index%destroy()
+    call this%slot_generation%destroy()
+
+    this%free_head = 0
+    this%size_of_type = 0
+  end subroutine slot_vector_destroy
+
+
+  !* Insert an element, and get a handle to it. O(1).
+  function slot_vector_insert(this, fortran_data) result(handle)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    type(slot_handle) :: handle
+    integer(c_int64_t) :: slot
+
+    ! Reuse a free slot if there is one.
+    if (this%free_head /= 0) then
+      slot = this%free_head
+      this%free_head = this%slot_index%get(int(slot, c_size_t))
+    else
+      call this%slot_index%push_back(0_c_int64_t)
+      call this%slot_generation%push_back(1_c_int64_t)
+      slot = int(this%slot_index%size(), c_int64_t)
+    end if
+
+    call this%dense%push_back(fortran_data)
+    call this%dense_to_slot%push_back(slot)
+    call this%slot_index%set(int(slot, c_size_t), int(this%dense%size(), c_int64_t))
+
+    handle%slot = slot
+    handle%generation = this%slot_generation%get(int(slot, c_size_t))
+  end function slot_vector_insert
+
+
+  !* Remove the element a handle points to. O(1).
+  !* This will call the GC on the element.
+  !* The last element is moved into the hole, and the handle goes stale.
+  subroutine slot_vector_remove(this, handle)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    type(slot_handle), intent(in) :: handle
+    integer(c_size_t) :: dense_index, last
+    integer(c_int64_t) :: moved_slot, slot
+
+    if (.not. this%contains(handle)) then
+      error stop "[Vector] Error: Stale or invalid slot handle."
+    end if
+
+    slot = handle%slot
+    dense_index = int(this%slot_index%get(int(slot, c_size_t)), c_size_t)
+    last = this%dense%size()
+
+    call run_gc(this, dense_index, dense_index)
+
+    ! Fill the hole with the last element.
+    if (dense_index /= last) then
+      call internal_memcpy(this%dense%get(dense_index), this%dense%get(last), this%size_of_type)
+      moved_slot = this%dense_to_slot%get(last)
+      call this%dense_to_slot%set(dense_index, moved_slot)
+      call this%slot_index%set(int(moved_slot, c_size_t), int(dense_index, c_int64_t))
+    end if
+
+    ! The dense vec has no GC, so this just drops the bytes.
+    call this%dense%pop_back()
+    call this%dense_to_slot%pop_back()
+
+    call free_slot(this, slot)
+  end subroutine slot_vector_remove
+
+
+  !* Get the element a handle points to.
+  !* Returns c_null_ptr if the handle is stale.
+  !! The pointer is only good until the next insert or remove.
+  function slot_vector_get(this, handle) result(raw_c_pointer)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    type(slot_handle), intent(in) :: handle
+    type(c_ptr) :: raw_c_pointer
+
+    if (.not. this%contains(handle)) then
+      raw_c_pointer = c_null_ptr
+      return
+    end if
+
+    raw_c_pointer = this%dense%get_unchecked(int(this%slot_index%get(int(handle%slot, c_size_t)), c_size_t))
+  end function slot_vector_get
+
+
+  !* Check if a handle still points at a live element.
+  function slot_vector_contains(this, handle) result(contains)
+    implicit none
+
+    class(slot_vec), intent(in) :: this
+    type(slot_handle), intent(in) :: handle
+    logical(c_bool) :: contains
+
+    contains = .false.
+
+    if (handle%slot < 1 .or. handle%slot > int(this%slot_index%size(), c_int64_t)) then
+      return
+    end if
+
+    contains = this%slot_generation%get(int(handle%slot, c_size_t)) == handle%generation
+  end function slot_vector_contains
+
+
+  !* Get the element at a dense index, 1 to size(), for iterating.
+  function slot_vector_get_dense(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = this%dense%get(index)
+  end function slot_vector_get_dense
+
+
+  !* Get the handle of the element at a dense index.
+  function slot_vector_handle_at(this, index) result(handle)
+    implicit none
+
+    class(slot_vec), intent(in) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(slot_handle) :: handle
+
+    handle%slot = this%dense_to_slot%get(index)
+    handle%generation = this%slot_generation%get(int(handle%slot, c_size_t))
+  end function slot_vector_handle_at
+
+
+  !* Get a pointer to the packed elements.
+  !! It's invalidated by insert and remove.
+  function slot_vector_data_ptr(this) result(raw_c_pointer)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = this%dense%data_ptr()
+  end function slot_vector_data_ptr
+
+
+  !* Get the number of live elements.
+  function slot_vector_size(this) result(size)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    size = this%dense%size()
+  end function slot_vector_size
+
+
+  !* Check if there are no live elements.
+  function slot_vector_is_empty(this) result(empty)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    empty = this%dense%is_empty()
+  end function slot_vector_is_empty
+
+
+  !* Remove every element. The GC function will run on each element.
+  !* Every handle goes stale.
+  subroutine slot_vector_clear(this)
+    implicit none
+
+    class(slot_vec), intent(inout) :: this
+    integer(c_size_t) :: i
+
+    call run_gc(this, 1_8, this%dense%size())
+
+    ! Every live slot goes stale, and onto the free list.
+    do i = 1, this%dense_to_slot%size()
+      call free_slot(this, this%dense_to_slot%get(i))
+    end do
+
+    call this%dense%clear()
+    call this%dense_to_slot%clear()
+  end subroutine slot_vector_clear
+
+
+!? BEGIN INTERNAL ONLY ==============================================
+
+  !* Bump the generation so every copy of the handle goes stale, then put the slot on the free list.
+  subroutine free_slot(this, slot)
+    implicit none
+
+    type(slot_vec), intent(inout) :: this
+    integer(c_int64_t), intent(in), value :: slot
+
+    call this%slot_generation%set(int(slot, c_size_t), this%slot_generation%get(int(slot, c_size_t)) + 1)
+    call this%slot_index%set(int(slot, c_size_t), this%free_head)
+    this%free_head = slot
+  end subroutine free_slot
+
+
+  subroutine run_gc(this, min, max)
+    implicit none
+
+    type(slot_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: min, max
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_size_t) :: i
+
+    ! No GC function was assigned to the vector.
+    if (.not. c_associated(this%gc_func)) then
+      return
+    end if
+
+    call c_f_procpointer(this%gc_func, optional_gc)
+
+    do i = min, max
+      call optional_gc(this%dense%get_unchecked(i))
+    end do
+  end subroutine run_gc
+
+end module slot_vector
@@ -0,0 +1,347 @@
+module small_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector_config
+  implicit none
+
+
+  private
+
+
+  public :: small_vec
+  public :: new_small_vec
+
+
+  !* A vector for lists that are usually tiny.
+  !*
+  !* The first SMALL_VEC_INLINE_BYTES bytes worth of elements live right inside the
+  !* small_vec, so a list that stays small never touches malloc at all.
+  !* When it outgrows that, it spills everything into a regular C vector and stays there.
+  !*
+  !! Pointers from get() point into the small_vec itself while it's inline.
+  !! If you copy or move the small_vec, or it spills, they're invalid.
+  !! Give the small_vec the target attribute if you keep those pointers around.
+  type :: small_vec
+    private
+    integer(c_int8_t), dimension(SMALL_VEC_INLINE_BYTES) :: inline = 0
+    integer(c_size_t) :: inline_size = 0
+    integer(c_size_t) :: inline_capacity = 0
+    ! Null until it spills.
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => small_vector_destroy
+    procedure :: get => small_vector_get
+    procedure :: set => small_vector_set
+    procedure :: push_back => small_vector_push_back
+    procedure :: pop_back => small_vector_pop_back
+    procedure :: remove => small_vector_remove
+    procedure :: clear => small_vector_clear
+    procedure :: is_empty => small_vector_is_empty
+    procedure :: size => small_vector_size
+    procedure :: capacity => small_vector_capacity
+    procedure :: is_inline => small_vector_is_inline
+  end type small_vec
+
+
+contains
+
+
+  !* Create a new small vector.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* If size_of_type is bigger than SMALL_VEC_INLINE_BYTES, it goes straight to the heap.
+  function new_small_vec(size_of_type, optional_gc_func) result(v)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(small_vec) :: v
+
+    if (size_of_type < 1) then
+      error stop "[Vector] Error: size_of_type must be at least 1."
+    end if
+
+    ! This will automatically clean your memory upon deletion.
+    if (present(optional_gc_func)) then
+      v%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    v%size_of_type = size_of_type
+    v%inline_capacity = SMALL_VEC_INLINE_BYTES / size_of_type
+  end function new_small_vec
+
+
+  !* Destroy all components of the vector. Elements and, if it spilled, the underlying C memory.
+  subroutine small_vector_destroy(this)
+    implicit none
+
+    class(small_vec), intent(inout), target :: this
+
+    call this%clear()
+
+    if (c_associated(this%data)) then
+      call internal_destroy_vector(this%data)
+      this%data = c_null_ptr
+    end if
+
+    this%size_of_type = 0
+    this%inline_capacity = 0
+  end subroutine small_vector_destroy
+
+
+  !* Get an element at an index in the vector.
+  function small_vector_get(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(small_vec), intent(in), target :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    if (c_associated(this%data)) then
+      raw_c_pointer = internal_vector_get(this%data, index)
+    else
+      raw_c_pointer = inline_address(this, index)
+    end if
+  end function small_vector_get
+
+
+  !* Overwrite the data at an index in the vector.
+  !* This will run the GC on the element that gets overwritten.
+  subroutine small_vector_set(this, index, fortran_data)
+    implicit none
+
+    class(small_vec), intent(inout), target :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call run_gc(this, index, index)
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_memcpy(this%get(index), black_magic, this%size_of_type)
+  end subroutine small_vector_set
+
+
+  !* Push an element to the back of the vector.
+  !* If the inline buffer is full, everything spills into a C vector first.
+  subroutine small_vector_push_back(this, fortran_data)
+    implicit none
+
+    class(small_vec), intent(inout), target :: this
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    if (.not. c_associated(this%data)) then
+      if (this%inline_size < this%inline_capacity) then
+        this%inline_size = this%inline_size + 1
+        call internal_memcpy(inline_address(this, this%inline_size), black_magic, this%size_of_type)
+        return
+      end if
+
+      call spill(this)
+    end if
+
+    call internal_vector_push_back(this%data, black_magic)
+  end subroutine small_vector_push_back
+
+
+  !* Remove the last element of the vector.
+  subroutine small_vector_pop_back(this)
+    implicit none
+
+    class(small_vec), intent(inout), target :: this
+    integer(c_size_t) :: size
+
+    !? If it's empty, popping can corrupt the memory.
+    if (this%is_empty()) then
+      return
+    end if
+
+    size = this%size()
+
+    call run_gc(this, size, size)
+
+    if (c_associated(this%data)) then
+      call internal_vector_pop_back(this%data)
+    else
+      this%inline_size = this%inline_size - 1
+    end if
+  end subroutine small_vector_pop_back
+
+
+  !* Remove an element at an index in the vector.
+  !* This will call the GC on the element.
+  subroutine small_vector_remove(this, index)
+    implicit none
+
+    class(small_vec), intent(inout), target :: this
+    integer(c_size_t), intent(in), value :: index
+    integer(c_size_t) :: i
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call run_gc(this, index, index)
+
+    if (c_associated(this%data)) then
+      call internal_vector_remove(this%data, index)
+      return
+    end if
+
+    ! It's a handful of elements, just shift them down one by one.
+    do i = index, this%inline_size - 1
+      call internal_memcpy(inline_address(this, i), inline_address(this, i + 1), this%size_of_type)
+    end do
+
+    this%inline_size = this%inline_size - 1
+  end subroutine small_vector_remove
+
+
+  !* Clear all elements out of the vector.
+  !* The GC function will run on each element.
+  !* If it spilled, it keeps its heap memory.
+  subroutine small_vector_clear(this)
+    implicit none
+
+    class(small_vec), intent(inout), target :: this
+
+    if (.not. this%is_empty()) then
+      call run_gc(this, 1_c_size_t, this%size())
+    end if
+
+    if (c_associated(this%data)) then
+      call internal_vector_clear(this%data)
+    else
+      this%inline_size = 0
+    end if
+  end subroutine small_vector_clear
+
+
+  !* Check if the vector is empty.
+  function small_vector_is_empty(this) result(empty)
+    implicit none
+
+    class(small_vec), intent(in) :: this
+    logical(c_bool) :: empty
+
+    empty = this%size() == 0
+  end function small_vector_is_empty
+
+
+  !* Get the number of elements in the vector.
+  function small_vector_size(this) result(size)
+    implicit none
+
+    class(small_vec), intent(in) :: this
+    integer(c_size_t) :: size
+
+    if (c_associated(this%data)) then
+      size = internal_vector_size(this%data)
+    else
+      size = this%inline_size
+    end if
+  end function small_vector_size
+
+
+  !* Get the number of elements the vector can hold before it has to reallocate (or spill).
+  function small_vector_capacity(this) result(capacity)
+    implicit none
+
+    class(small_vec), intent(in) :: this
+    integer(c_size_t) :: capacity
+
+    if (c_associated(this%data)) then
+      capacity = internal_vector_capacity(this%data)
+    else
+      capacity = this%inline_capacity
+    end if
+  end function small_vector_capacity
+
+
+  !* Check if the elements still live inline, in the small_vec itself.
+  function small_vector_is_inline(this) result(is_inline)
+    implicit none
+
+    class(small_vec), intent(in) :: this
+    logical(c_bool) :: is_inline
+
+    is_inline = .not. c_associated(this%data)
+  end function small_vector_is_inline
+
+
+!? BEGIN INTERNAL ONLY ==============================================
+
+  !* Work out where an inline element lives.
+  function inline_address(this, index) result(raw_c_pointer)
+    implicit none
+
+    type(small_vec), intent(in), target :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+    integer(c_intptr_t) :: address
+
+    address = loc(this%inline) + int((index - 1) * this%size_of_type, c_intptr_t)
+
+    raw_c_pointer = transfer(address, raw_c_pointer)
+  end function inline_address
+
+
+  !* Move the inline elements into a C vector with room to grow.
+  subroutine spill(this)
+    implicit none
+
+    type(small_vec), intent(inout), target :: this
+
+    this%data = internal_new_vector(max(this%inline_capacity * 2, 1_c_size_t), this%size_of_type, c_null_ptr, 0_c_size_t)
+
+    if (this%inline_size > 0) then
+      call internal_vector_push_back_array(this%data, inline_address(this, 1_c_size_t), this%inline_size)
+    end if
+
+    this%inline_size = 0
+  end subroutine spill
+
+
+  subroutine run_gc(this, min, max)
+    implicit none
+
+    type(small_vec), intent(inout), target :: this
+    integer(c_size_t), intent(in), value :: min, max
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_size_t) :: i
+
+    ! No GC function was assigned to the vector.
+    if (.not. c_associated(this%gc_func)) then
+      return
+    end if
+
+    call c_f_procpointer(this%gc_func, optional_gc)
+
+    do i = min, max
+      call optional_gc(this%get(i))
+    end do
+  end subroutine run_gc
+
+end module small_vector
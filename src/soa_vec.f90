@@ -0,0 +1,557 @@
+module soa_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector_config
+  use :: vector
+  implicit none
+
+
+  private
+
+
+  public :: soa_vec
+  public :: new_soa_vec
+
+
+  !* A struct of arrays vector for derived types.
+  !*
+  !* You still push_back and get whole records, but each field lives in its own contiguous vec.
+  !* So a kernel that scans one hot field only pulls that field through the cache,
+  !* not every cold byte next to it. Each field can be viewed as a plain Fortran array.
+  !*
+  !* Records are scattered into the fields on the way in, and gathered back out on the way out.
+  !* The padding between fields is never stored.
+  type :: soa_vec
+    private
+    ! One vec per field. Element i of each one is field f of record i.
+    type(vec), dimension(:), allocatable :: fields
+    ! Where each field starts in the record, in bytes.
+    integer(c_size_t), dimension(:), allocatable :: field_offsets
+    integer(c_size_t), dimension(:), allocatable :: field_sizes
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => soa_vector_destroy
+    procedure :: push_back => soa_vector_push_back
+    procedure :: get => soa_vector_get
+    procedure :: set => soa_vector_set
+    procedure :: pop_back => soa_vector_pop_back
+    procedure :: field_ptr => soa_vector_field_ptr
+    procedure :: field_data_ptr => soa_vector_field_data_ptr
+    procedure :: field_count => soa_vector_field_count
+    procedure, private :: soa_vector_view_int8
+    procedure, private :: soa_vector_view_int16
+    procedure, private :: soa_vector_view_int32
+    procedure, private :: soa_vector_view_int64
+    procedure, private :: soa_vector_view_real32
+    procedure, private :: soa_vector_view_real64
+    procedure, private :: soa_vector_view_complex32
+    procedure, private :: soa_vector_view_complex64
+    procedure, private :: soa_vector_view_bool
+    generic :: view => soa_vector_view_int8, soa_vector_view_int16, soa_vector_view_int32, soa_vector_view_int64, &
+      soa_vector_view_real32, soa_vector_view_real64, soa_vector_view_complex32, soa_vector_view_complex64, soa_vector_view_bool
+    procedure :: is_empty => soa_vector_is_empty
+    procedure :: size => soa_vector_size
+    procedure :: capacity => soa_vector_capacity
+    procedure :: reserve => soa_vector_reserve
+    procedure :: clear => soa_vector_clear
+  end type soa_vec
+
+
+contains
+
+
+  !* Create a new struct of arrays vector.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* field_offsets and field_sizes describe where each field sits in one record, in bytes.
+  !* You can get them from an instance of your type like so:
+  !*
+  !* type(some_data), target :: example
+  !* offset = transfer(c_loc(example%hot), 0_c_intptr_t) - transfer(c_loc(example), 0_c_intptr_t)
+  !* size = storage_size(example%hot) / 8
+  !*
+  !* Field 1 is the first one you list, and so on. Fields may not overlap.
+  function new_soa_vec(size_of_type, field_offsets, field_sizes, initial_size, optional_gc_func) result(v)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type
+    integer(c_size_t), dimension(:), intent(in) :: field_offsets, field_sizes
+    integer(c_size_t), intent(in), value :: initial_size
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(soa_vec) :: v
+    integer(c_size_t) :: i, j
+
+    if (size(field_offsets) < 1 .or. size(field_offsets) /= size(field_sizes)) then
+      error stop "[Vector] Error: An soa_vec needs one offset and one size for each field."
+    end if
+
+    do i = 1, size(field_offsets)
+      if (field_sizes(i) < 1 .or. field_offsets(i) < 0 .or. field_offsets(i) + field_sizes(i) > size_of_type) then
+        error stop "[Vector] Error: A field doesn't fit inside the record."
+      end if
+
+      do j = 1, i - 1
+        if (field_offsets(i) < field_offsets(j) + field_sizes(j) .and. field_offsets(j) < field_offsets(i) + field_sizes(i)) then
+          error stop "[Vector] Error: Two fields overlap."
+        end if
+      end do
+    end do
+
+    ! This runs on a gathered copy of each record.
+    if (present(optional_gc_func)) then
+      v%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    allocate(v%fields(size(field_offsets)))
+
+    do i = 1, size(field_offsets)
+      v%fields(i) = new_vec(field_sizes(i), initial_size)
+    end do
+
+    v%field_offsets = field_offsets
+    v%field_sizes = field_sizes
+    v%size_of_type = size_of_type
+  end function new_soa_vec
+
+
+  !* Destroy all components of the vector. Elements and underlying C memory.
+  subroutine soa_vector_destroy(this)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t) :: i
+
+    if (.not. allocated(this%fields)) then
+      return
+    end if
+
+    call run_gc(this, 1_8, this%size())
+
+    do i = 1, size(this%fields)
+      call this%fields(i)%destroy()
+    end do
+
+    deallocate(this%fields)
+    deallocate(this%field_offsets)
+    deallocate(this%field_sizes)
+
+    this%size_of_type = 0
+  end subroutine soa_vector_destroy
+
+
+  !* Uses memcpy under the hood.
+  !* Push a whole record to the back. Each field goes to its own vec.
+  subroutine soa_vector_push_back(this, fortran_data)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+    integer(c_size_t) :: i
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    do i = 1, size(this%fields)
+      call this%fields(i)%append_n(offset_pointer(black_magic, this%field_offsets(i)), 1_c_size_t)
+    end do
+  end subroutine soa_vector_push_back
+
+
+  !* Uses memcpy under the hood.
+  !* Gather the record at an index back together, into out.
+  !* out must be the same type the vector was made for.
+  !* Its padding between fields is left alone.
+  subroutine soa_vector_get(this, index, out)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    call check_index(this, index)
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call gather(this, index, black_magic)
+  end subroutine soa_vector_get
+
+
+  !* Uses memcpy under the hood.
+  !* Overwrite the record at an index, scattering it into the fields.
+  !* This will run the GC on the record that gets overwritten.
+  subroutine soa_vector_set(this, index, fortran_data)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+    integer(c_size_t) :: i
+
+    call check_index(this, index)
+
+    call run_gc(this, index, index)
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    do i = 1, size(this%fields)
+      call internal_memcpy(this%fields(i)%get_unchecked(index), offset_pointer(black_magic, this%field_offsets(i)), &
+        this%field_sizes(i))
+    end do
+  end subroutine soa_vector_set
+
+
+  !* Remove the last record.
+  !* This will call the GC on the record.
+  subroutine soa_vector_pop_back(this)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t) :: i, last
+
+    !? If it's empty, popping can corrupt the memory.
+    if (this%is_empty()) then
+      return
+    end if
+
+    last = this%size()
+
+    call run_gc(this, last, last)
+
+    do i = 1, size(this%fields)
+      call this%fields(i)%pop_back()
+    end do
+  end subroutine soa_vector_pop_back
+
+
+  !* Get a pointer to one field of the record at an index.
+  function soa_vector_field_ptr(this, field, index) result(raw_c_pointer)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field, index
+    type(c_ptr) :: raw_c_pointer
+
+    call check_field(this, field)
+
+    raw_c_pointer = this%fields(field)%get(index)
+  end function soa_vector_field_ptr
+
+
+  !* Get a pointer to the start of one field's contiguous memory.
+  !* Record i's field lives at (i - 1) * that field's size bytes after this.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  function soa_vector_field_data_ptr(this, field) result(raw_c_pointer)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    type(c_ptr) :: raw_c_pointer
+
+    call check_field(this, field)
+
+    raw_c_pointer = this%fields(field)%data_ptr()
+  end function soa_vector_field_data_ptr
+
+
+  !* Get the number of fields each record is split into.
+  function soa_vector_field_count(this) result(count)
+    implicit none
+
+    class(soa_vec), intent(in) :: this
+    integer(c_size_t) :: count
+
+    count = 0
+
+    if (allocated(this%fields)) then
+      count = size(this%fields)
+    end if
+  end function soa_vector_field_count
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_int8(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    integer(c_int8_t), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_int8
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_int16(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    integer(c_int16_t), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_int16
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_int32(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    integer(c_int32_t), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_int32
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_int64(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    integer(c_int64_t), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_int64
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_real32(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    real(c_float), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_real32
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_real64(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    real(c_double), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_real64
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_complex32(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    complex(c_float_complex), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_complex32
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_complex64(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    complex(c_double_complex), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_complex64
+
+
+  !* Point a rank 1 Fortran array straight at one field of every record. Nothing is copied.
+  !! This is invalidated by anything that can reallocate. (push_back, reserve, etc)
+  subroutine soa_vector_view_bool(this, field, array)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: field
+    logical(c_bool), dimension(:), pointer, intent(out) :: array
+
+    call check_field(this, field)
+
+    call this%fields(field)%view(array)
+  end subroutine soa_vector_view_bool
+
+
+  !* Check if the vector is empty.
+  function soa_vector_is_empty(this) result(empty)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    empty = this%fields(1)%is_empty()
+  end function soa_vector_is_empty
+
+
+  !* Get the number of records.
+  function soa_vector_size(this) result(size)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    size = this%fields(1)%size()
+  end function soa_vector_size
+
+
+  !* Get how many records fit before the fields have to reallocate.
+  function soa_vector_capacity(this) result(cap)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t) :: cap
+
+    cap = this%fields(1)%capacity()
+  end function soa_vector_capacity
+
+
+  !* Make room for new_capacity records in every field.
+  subroutine soa_vector_reserve(this, new_capacity)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_capacity
+    integer(c_size_t) :: i
+
+    do i = 1, size(this%fields)
+      call this%fields(i)%reserve(new_capacity)
+    end do
+  end subroutine soa_vector_reserve
+
+
+  !* Remove every record. The GC function will run on each record.
+  subroutine soa_vector_clear(this)
+    implicit none
+
+    class(soa_vec), intent(inout) :: this
+    integer(c_size_t) :: i
+
+    call run_gc(this, 1_8, this%size())
+
+    do i = 1, size(this%fields)
+      call this%fields(i)%clear()
+    end do
+  end subroutine soa_vector_clear
+
+
+!? BEGIN INTERNAL ONLY ==============================================
+
+
+  function offset_pointer(base, offset) result(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base
+    integer(c_size_t), intent(in), value :: offset
+    type(c_ptr) :: raw_c_pointer
+    integer(c_intptr_t) :: address
+
+    address = transfer(base, address) + int(offset, c_intptr_t)
+
+    raw_c_pointer = transfer(address, raw_c_pointer)
+  end function offset_pointer
+
+
+  subroutine gather(this, index, record)
+    implicit none
+
+    type(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr), intent(in), value :: record
+    integer(c_size_t) :: i
+
+    do i = 1, size(this%fields)
+      call internal_memcpy(offset_pointer(record, this%field_offsets(i)), this%fields(i)%get_unchecked(index), &
+        this%field_sizes(i))
+    end do
+  end subroutine gather
+
+
+  subroutine check_index(this, index)
+    implicit none
+
+    type(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+  end subroutine check_index
+
+
+  subroutine check_field(this, field)
+    implicit none
+
+    type(soa_vec), intent(in) :: this
+    integer(c_size_t), intent(in), value :: field
+
+    if (field < 1 .or. field > size(this%fields)) then
+      error stop "[Vector] Error: There is no field with that number."
+    end if
+  end subroutine check_field
+
+
+  subroutine run_gc(this, min, max)
+    implicit none
+
+    type(soa_vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: min, max
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_int8_t), dimension(:), allocatable, target :: record
+    integer(c_size_t) :: i
+
+    ! No GC function was assigned to the vector.
+    if (.not. c_associated(this%gc_func)) then
+      return
+    end if
+
+    call c_f_procpointer(this%gc_func, optional_gc)
+
+    ! The GC gets the record gathered back together, so it can look at any field.
+    allocate(record(this%size_of_type))
+    record = 0
+
+    do i = min, max
+      call gather(this, i, c_loc(record))
+      call optional_gc(c_loc(record))
+    end do
+  end subroutine run_gc
+
+end module soa_vector
@@ -0,0 +1,174 @@
+module spsc_ring_vector
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  implicit none
+
+
+  private
+
+
+  public :: spsc_ring
+  public :: new_spsc_ring
+
+
+  !* A bounded ring for handing elements from one thread to another.
+  !*
+  !* Exactly one thread pushes, and exactly one thread pops. That's what lets it skip the mutex.
+  !* Each side only ever writes its own counter, and reads the other one atomically.
+  !* It never grows. When it's full, try_push gives back .false. and you decide what to do.
+  !*
+  !! Two producers, or two consumers, on the same ring will corrupt it.
+  !! If you need that, use a concurrent_vec.
+  type :: spsc_ring
+    private
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_size_t) :: size_of_type = 0
+    type(c_funptr) :: gc_func = c_null_funptr
+  contains
+    procedure :: destroy => spsc_ring_destroy
+    procedure :: try_push => spsc_ring_try_push
+    procedure :: try_pop => spsc_ring_try_pop
+    procedure :: is_empty => spsc_ring_is_empty
+    procedure :: size => spsc_ring_size
+    procedure :: capacity => spsc_ring_capacity
+  end type spsc_ring
+
+
+contains
+
+
+  !* Create a new single producer/single consumer ring.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* capacity is rounded up to a power of 2.
+  function new_spsc_ring(size_of_type, capacity, optional_gc_func) result(r)
+    implicit none
+
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, capacity
+    procedure(vec_gc_blueprint), optional :: optional_gc_func
+    type(spsc_ring) :: r
+
+    if (capacity < 1) then
+      error stop "[Vector] Error: An spsc_ring needs a capacity of at least 1."
+    end if
+
+    ! This will clean up whatever is still in the ring when it's destroyed.
+    if (present(optional_gc_func)) then
+      r%gc_func = c_funloc(optional_gc_func)
+    end if
+
+    r%data = internal_new_spsc_ring(capacity, size_of_type)
+
+    r%size_of_type = size_of_type
+  end function new_spsc_ring
+
+
+  !* Destroy the ring. Elements still in it, and underlying C memory.
+  !* Make sure both threads are done with it when you call this.
+  subroutine spsc_ring_destroy(this)
+    implicit none
+
+    class(spsc_ring), intent(inout) :: this
+    procedure(vec_gc_blueprint), pointer :: optional_gc
+    integer(c_int8_t), dimension(:), allocatable, target :: element
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    ! Drain it, so the GC sees every element that never got popped.
+    if (c_associated(this%gc_func)) then
+      call c_f_procpointer(this%gc_func, optional_gc)
+
+      allocate(element(this%size_of_type))
+
+      do while (internal_spsc_ring_try_pop(this%data, c_loc(element)))
+        call optional_gc(c_loc(element))
+      end do
+    end if
+
+    call internal_destroy_spsc_ring(this%data)
+
+    this%data = c_null_ptr
+    this%size_of_type = 0
+  end subroutine spsc_ring_destroy
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element into the ring. Producer thread only.
+  !* Gives back .false. if the ring is full, and nothing was pushed.
+  function spsc_ring_try_push(this, fortran_data) result(pushed)
+    implicit none
+
+    class(spsc_ring), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    logical(c_bool) :: pushed
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    pushed = internal_spsc_ring_try_push(this%data, black_magic)
+  end function spsc_ring_try_push
+
+
+  !* Uses memcpy under the hood.
+  !* Move the oldest element out of the ring into out. Consumer thread only.
+  !* Gives back .false. if the ring is empty, and out is left alone.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* out must be the same type as the elements.
+  function spsc_ring_try_pop(this, out) result(popped)
+    implicit none
+
+    class(spsc_ring), intent(inout) :: this
+    class(*), intent(inout), target :: out
+    logical(c_bool) :: popped
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(out), black_magic)
+
+    popped = internal_spsc_ring_try_pop(this%data, black_magic)
+  end function spsc_ring_try_pop
+
+
+  !* Check if the ring is empty.
+  !! If the other thread is working, this can be stale by the time you look at it.
+  function spsc_ring_is_empty(this) result(empty)
+    implicit none
+
+    class(spsc_ring), intent(inout) :: this
+    logical(c_bool) :: empty
+
+    if (.not. c_associated(this%data)) then
+      empty = .true.
+    else
+      empty = internal_spsc_ring_size(this%data) == 0
+    end if
+  end function spsc_ring_is_empty
+
+
+  !* Get the number of elements waiting in the ring.
+  !! If the other thread is working, this can be stale by the time you look at it.
+  function spsc_ring_size(this) result(size)
+    implicit none
+
+    class(spsc_ring), intent(inout) :: this
+    integer(c_size_t) :: size
+
+    size = internal_spsc_ring_size(this%data)
+  end function spsc_ring_size
+
+
+  !* Get how many elements the ring can hold.
+  function spsc_ring_capacity(this) result(cap)
+    implicit none
+
+    class(spsc_ring), intent(inout) :: this
+    integer(c_size_t) :: cap
+
+    cap = internal_spsc_ring_capacity(this%data)
+  end function spsc_ring_capacity
+
+
+end module spsc_ring_vector
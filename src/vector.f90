@@ -1,6 +1,8 @@
 module vector
   use, intrinsic :: iso_c_binding
   use :: fortran_vector_bindings
+  use :: vector_io_status
+  use :: vector_config
   implicit none
 
 
@@ -9,6 +11,14 @@ module vector
 
   public :: vec
   public :: new_vec
+  public :: vec_set_global_allocator
+  public :: vec_set_parallel_threads
+  public :: VEC_GROWTH_DOUBLE
+  public :: VEC_GROWTH_FACTOR_1_5
+  public :: VEC_GROWTH_CHUNK
+  public :: VEC_GROWTH_CAPPED
+  public :: vec_stats
+  public :: vec_stats_dump
 
 
   type :: vec
@@ -16,23 +26,65 @@ module vector
     type(c_ptr) :: data = c_null_ptr
     integer(c_size_t) :: size_of_type = 0
     type(c_funptr) :: gc_func = c_null_funptr
+    type(c_funptr) :: gc_range_func = c_null_funptr
+    ! Set by map_readonly. Everything that changes the vector refuses to run.
+    logical(c_bool) :: read_only = .false.
   contains
     procedure :: destroy => vector_destroy
     procedure :: get => vector_get
+    procedure :: get_unchecked => vector_get_unchecked
     procedure :: set => vector_set
+    procedure :: set_unchecked => vector_set_unchecked
+    procedure :: data_ptr => vector_data_ptr
+    procedure, private :: vector_view_int8
+    procedure, private :: vector_view_int16
+    procedure, private :: vector_view_int32
+    procedure, private :: vector_view_int64
+    procedure, private :: vector_view_real32
+    procedure, private :: vector_view_real64
+    procedure, private :: vector_view_complex32
+    procedure, private :: vector_view_complex64
+    procedure, private :: vector_view_bool
+    generic :: view => vector_view_int8, vector_view_int16, vector_view_int32, vector_view_int64, &
+      vector_view_real32, vector_view_real64, vector_view_complex32, vector_view_complex64, vector_view_bool
     procedure :: is_empty => vector_is_empty
     procedure :: size => vector_size
     procedure :: capacity => vector_capacity
     procedure :: shrink_to_fit => vector_shrink_to_fit
     procedure :: clear => vector_clear
     procedure :: insert => vector_insert
+    procedure :: insert_range => vector_insert_range
     procedure :: remove => vector_remove
+    procedure :: remove_range => vector_remove_range
     procedure :: push_back => vector_push_back
+    procedure :: push_back_array => vector_push_back_array
+    procedure :: append_n => vector_append_n
+    procedure :: emplace_back => vector_emplace_back
+    procedure :: emplace_n => vector_emplace_n
     procedure :: pop_back => vector_pop_back
+    procedure :: pop_back_into => vector_pop_back_into
+    procedure :: take => vector_take
+    procedure :: find => vector_find
+    procedure :: count => vector_count
+    procedure :: contains => vector_contains
+    procedure :: fill => vector_fill
+    procedure :: sort => vector_sort
+    procedure :: lower_bound => vector_lower_bound
+    procedure :: binary_search => vector_binary_search
+    procedure :: parallel_for_each => vector_parallel_for_each
+    procedure :: parallel_transform => vector_parallel_transform
+    procedure :: parallel_reduce => vector_parallel_reduce
     procedure :: reserve => vector_reserve
     procedure :: resize => vector_resize
     procedure :: swap => vector_swap
     procedure :: clone => vector_clone
+    procedure :: is_shared => vector_is_shared
+    procedure :: make_unique => vector_make_unique
+    procedure :: save => vector_save
+    procedure :: load => vector_load
+    procedure :: map_readonly => vector_map_readonly
+    procedure :: is_read_only => vector_is_read_only
+    procedure :: stats => vector_get_stats
   end type vec
 
 
@@ -42,20 +94,93 @@ contains
   !* Create a new vector.
   !* I did not create a module interface because I want you to be able to see explicitly
   !* Where you create your vector.
-  function new_vec(size_of_type, initial_size, optional_gc_func) result(v)
+  !*
+  !* allocator lets this vector's memory come from somewhere other than malloc.
+  !* (See the vector_allocator module, for example, vec_arena)
+  !*
+  !* alignment makes element 1 start on a multiple of that many bytes. It must be a power of 2.
+  !* Use 32 or 64 to hand the data straight to AVX kernels. This sticks through every reallocation.
+  !* If your element size is a multiple of the alignment, every element will be aligned.
+  !*
+  !* growth_policy picks how the vector grows when it runs out of room. (VEC_GROWTH_*)
+  !* Doubling is the default. For huge vectors, VEC_GROWTH_FACTOR_1_5 or VEC_GROWTH_CAPPED
+  !* waste a lot less memory at the moment of reallocation.
+  !* growth_amount is the size (in elements) of the chunk, or the cap.
+  !* Range operations always grow straight to the capacity they need, if the policy isn't enough.
+  !*
+  !* optional_gc_range_func is a GC that gets a whole range of elements in one call.
+  !* (See vec_gc_range_blueprint) Use it instead of optional_gc_func when clearing
+  !* millions of elements one call at a time is too slow.
+  !*
+  !* stats_name turns on stats for this vector, under that name. (See stats() and vec_stats_dump)
+  !* Or turn them on for every vector with VECTOR_STATS in vector_config.
+  function new_vec(size_of_type, initial_size, optional_gc_func, allocator, alignment, growth_policy, growth_amount, &
+      optional_gc_range_func, stats_name) result(v)
     implicit none
 
     ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
     integer(c_size_t), intent(in), value :: size_of_type, initial_size
     procedure(vec_gc_blueprint), optional :: optional_gc_func
+    procedure(vec_gc_range_blueprint), optional :: optional_gc_range_func
+    type(c_ptr), intent(in), optional :: allocator
+    integer(c_size_t), intent(in), optional :: alignment
+    integer(c_size_t), intent(in), optional :: growth_policy, growth_amount
+    character(len = *), intent(in), optional :: stats_name
     type(vec) :: v
+    type(c_ptr) :: allocator_pointer
+    integer(c_size_t) :: element_alignment
 
     ! This will automatically clean your memory upon deletion.
     if (present(optional_gc_func)) then
       v%gc_func = c_funloc(optional_gc_func)
     end if
 
-    v%data = internal_new_vector(initial_size, size_of_type)
+    ! Or clean it a whole range at a time.
+    if (present(optional_gc_range_func)) then
+      if (present(optional_gc_func)) then
+        error stop "[Vector] Error: Give either a GC function or a range GC function, not both."
+      end if
+      v%gc_range_func = c_funloc(optional_gc_range_func)
+    end if
+
+    allocator_pointer = c_null_ptr
+    if (present(allocator)) then
+      allocator_pointer = allocator
+    end if
+
+    element_alignment = 0
+    if (present(alignment)) then
+      if (alignment < 0 .or. iand(alignment, alignment - 1) /= 0) then
+        error stop "[Vector] Error: Alignment must be a power of 2."
+      end if
+      element_alignment = alignment
+    end if
+
+    v%data = internal_new_vector(initial_size, size_of_type, allocator_pointer, element_alignment)
+
+    if (present(growth_policy)) then
+      if (growth_policy < VEC_GROWTH_DOUBLE .or. growth_policy > VEC_GROWTH_CAPPED) then
+        error stop "[Vector] Error: Unknown growth policy."
+      end if
+
+      if (growth_policy >= VEC_GROWTH_CHUNK) then
+        if (.not. present(growth_amount)) then
+          error stop "[Vector] Error: This growth policy needs a growth_amount."
+        end if
+        if (growth_amount < 1) then
+          error stop "[Vector] Error: growth_amount must be at least 1."
+        end if
+        call internal_vector_set_growth_policy(v%data, growth_policy, growth_amount)
+      else
+        call internal_vector_set_growth_policy(v%data, growth_policy, 0_c_size_t)
+      end if
+    end if
+
+    if (present(stats_name)) then
+      call internal_vector_enable_stats(v%data, trim(stats_name)//c_null_char)
+    else if (VECTOR_STATS) then
+      call internal_vector_enable_stats(v%data, c_null_char)
+    end if
 
     v%size_of_type = size_of_type
   end function new_vec
@@ -71,14 +196,20 @@ contains
       return
     end if
 
-    if (.not. this%is_empty()) then
+    ! The vector with the GC owns what the elements point to, so it always cleans them up.
+    ! Clones never get the GC. If one is still reading the elements, they're copied first,
+    ! so the GC never touches memory the clone is using.
+    if (.not. this%is_empty() .and. (c_associated(this%gc_func) .or. c_associated(this%gc_range_func))) then
+      call internal_vector_unshare(this%data)
       call run_gc(this, 1_8, this%size())
     end if
 
+    ! This only frees the memory if it's the last clone using it.
     call internal_destroy_vector(this%data)
 
     this%data = c_null_ptr
     this%size_of_type = 0
+    this%read_only = .false.
   end subroutine vector_destroy
 
 
@@ -90,13 +221,53 @@ contains
     integer(c_size_t), intent(in), value :: index
     type(c_ptr) :: raw_c_pointer
 
-    if (index < 1 .or. index > this%size()) then
-      error stop "[Vector] Error: Went out of bounds."
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
     end if
 
-    raw_c_pointer = internal_vector_get(this%data, index)
+    raw_c_pointer = element_address(this, index)
   end function vector_get
 
+  !* Get an element at an index in the vector, without any bounds checking.
+  !* The address is worked out right here in Fortran, so this can be inlined into your loop.
+  !! If the index is out of bounds, you get garbage.
+  function vector_get_unchecked(this, index) result(raw_c_pointer)
+    implicit none
+
+    class(vec), intent(in) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = element_address(this, index)
+  end function vector_get_unchecked
+
+
+  !* Overwrite the data at an index in the vector, without any bounds checking.
+  !* This will run the GC on the element that gets overwritten.
+  !* The address is worked out right here in Fortran, and the data goes straight to memcpy.
+  !! If the index is out of bounds, you will corrupt memory.
+  subroutine vector_set_unchecked(this, index, fortran_data)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    call prepare_write(this)
+
+    if (c_associated(this%gc_func) .or. c_associated(this%gc_range_func)) then
+      call run_gc(this, index, index)
+    end if
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_memcpy(element_address(this, index), black_magic, this%size_of_type)
+  end subroutine vector_set_unchecked
+
+
   !* Overwrite the data at an index in the vector.
   !* This will run the GC.
   subroutine vector_set(this, index, fortran_data)
@@ -107,20 +278,253 @@ contains
     class(*), intent(in), target :: fortran_data
     type(c_ptr) :: black_magic
 
-    if (index < 1 .or. index > this%size()) then
-      error stop "[Vector] Error: Went out of bounds."
-    end if
+    call prepare_write(this)
 
-    if (.not. this%is_empty()) then
-      call run_gc(this, index, this%size())
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
     end if
 
+    call run_gc(this, index, index)
+
     black_magic = transfer(loc(fortran_data), black_magic)
 
-    call internal_vector_set(this%data, index, black_magic)
+    call internal_memcpy(element_address(this, index), black_magic, this%size_of_type)
   end subroutine vector_set
 
 
+  !* Get a pointer to the start of the contiguous element memory.
+  !* Element i lives at (i - 1) * size_of_type bytes after this.
+  !* For a derived type you can get a Fortran array over everything like so:
+  !*
+  !* type(some_data), dimension(:), pointer :: array
+  !* call c_f_pointer(v%data_ptr(), array, [v%size()])
+  !*
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  function vector_data_ptr(this) result(raw_c_pointer)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = c_null_ptr
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    raw_c_pointer = element_address(this, 1_c_size_t)
+  end function vector_data_ptr
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_int8(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_int8_t), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(0_c_int8_t) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_int8
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_int16(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_int16_t), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(0_c_int16_t) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_int16
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_int32(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_int32_t), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(0_c_int32_t) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_int32
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_int64(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_int64_t), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(0_c_int64_t) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_int64
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_real32(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    real(c_float), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(0.0_c_float) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_real32
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_real64(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    real(c_double), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(0.0_c_double) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_real64
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_complex32(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    complex(c_float_complex), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size((0.0_c_float, 0.0_c_float)) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_complex32
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_complex64(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    complex(c_double_complex), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size((0.0_c_double, 0.0_c_double)) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_complex64
+
+
+  !* Point a rank 1 Fortran array straight at the vector's elements. Nothing is copied.
+  !* Now sum, maxval, do concurrent, BLAS, etc. can work right on the data.
+  !! This is invalidated by anything that can reallocate. (push_back, insert, reserve, etc)
+  subroutine vector_view_bool(this, array)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    logical(c_bool), dimension(:), pointer, intent(out) :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    if (this%size_of_type /= storage_size(.false._c_bool) / 8) then
+      error stop "[Vector] Error: View type does not match the element size."
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end subroutine vector_view_bool
+
+
   !* Check if the vector is empty.
   function vector_is_empty(this) result(empty)
     implicit none
@@ -128,11 +532,7 @@ contains
     class(vec), intent(inout) :: this
     logical(c_bool) :: empty
 
-    if (.not. c_associated(this%data)) then
-      empty = .true.
-    else
-      empty = internal_vector_is_empty(this%data)
-    end if
+    empty = this%size() == 0
   end function vector_is_empty
 
 
@@ -142,8 +542,17 @@ contains
 
     class(vec), intent(inout) :: this
     integer(c_size_t) :: size
+    integer(c_size_t), dimension(:), pointer :: header
 
-    size = internal_vector_size(this%data)
+    if (.not. c_associated(this%data)) then
+      size = 0
+      return
+    end if
+
+    ! Size and capacity are the first two things in the cvector_header.
+    call c_f_pointer(this%data, header, [2])
+
+    size = header(1)
   end function vector_size
 
 
@@ -154,8 +563,16 @@ contains
 
     class(vec), intent(inout) :: this
     integer(c_size_t) :: cap
+    integer(c_size_t), dimension(:), pointer :: header
+
+    if (.not. c_associated(this%data)) then
+      cap = 0
+      return
+    end if
+
+    call c_f_pointer(this%data, header, [2])
 
-    cap = internal_vector_capacity(this%data)
+    cap = header(2)
   end function vector_capacity
 
 
@@ -166,6 +583,8 @@ contains
 
     class(vec), intent(inout) :: this
 
+    call prepare_write(this)
+
     call internal_vector_shrink_to_fit(this%data)
   end subroutine vector_shrink_to_fit
 
@@ -177,6 +596,8 @@ contains
 
     class(vec), intent(inout) :: this
 
+    call prepare_write(this)
+
     if (.not. this%is_empty()) then
       call run_gc(this, 1_8, this%size())
     end if
@@ -194,12 +615,37 @@ contains
     class(*), intent(in), target :: fortran_data
     type(c_ptr) :: black_magic
 
+    call prepare_write(this)
+
     black_magic = transfer(loc(fortran_data), black_magic)
 
     call internal_vector_insert(this%data, index, black_magic)
   end subroutine vector_insert
 
 
+  !* Insert count contiguous elements, starting at raw_c_pointer, into an index of the array.
+  !* The memory must hold elements of this vector's type.
+  !* Everything after the index is only shifted once, no matter how many elements you insert.
+  subroutine vector_insert_range(this, index, raw_c_pointer, count)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_size_t), intent(in), value :: count
+
+    call prepare_write(this)
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size() + 1) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call internal_vector_insert_range(this%data, index, raw_c_pointer, count)
+  end subroutine vector_insert_range
+
+
   !* Remove an element from the vector at an index.
   !* This will call the GC on the element.
   subroutine vector_remove(this, index)
@@ -208,8 +654,12 @@ contains
     class(vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: index
 
-    if (index < 1 .or. index > this%size()) then
-      error stop "[Vector] Error: Went out of bounds."
+    call prepare_write(this)
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
     end if
 
     if (.not. this%is_empty()) then
@@ -220,6 +670,29 @@ contains
   end subroutine vector_remove
 
 
+  !* Remove all elements from first to last (inclusive) in the vector.
+  !* This will call the GC on each removed element.
+  !* Everything after the range is only shifted once, no matter how many elements you remove.
+  subroutine vector_remove_range(this, first, last)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: first, last
+
+    call prepare_write(this)
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (first < 1 .or. last > this%size() .or. first > last) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call run_gc(this, first, last)
+
+    call internal_vector_remove_range(this%data, first, last)
+  end subroutine vector_remove_range
+
+
   !* Uses memcpy under the hood.
   !* Push an element to the back of the vector.
   subroutine vector_push_back(this, fortran_data)
@@ -228,13 +701,117 @@ contains
     class(vec), intent(inout) :: this
     class(*), intent(in), target :: fortran_data
     type(c_ptr) :: black_magic
+    integer(c_size_t), dimension(:), pointer :: header
+
+    call prepare_write(this)
 
     black_magic = transfer(loc(fortran_data), black_magic)
 
-    call internal_vector_push_back(this%data, black_magic)
+    ! Size and capacity are the first two things in the cvector_header.
+    call c_f_pointer(this%data, header, [2])
+
+    ! Out of room, C has to reallocate.
+    if (header(1) >= header(2)) then
+      call internal_vector_push_back(this%data, black_magic)
+      return
+    end if
+
+    call internal_memcpy(element_address(this, header(1) + 1), black_magic, this%size_of_type)
+
+    header(1) = header(1) + 1
   end subroutine vector_push_back
 
 
+  !* Uses a single memcpy under the hood.
+  !* Push a whole contiguous Fortran array to the back of the vector.
+  !* The vector will only reallocate once, no matter how big the array is.
+  subroutine vector_push_back_array(this, fortran_data)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    class(*), dimension(:), intent(in), target, contiguous :: fortran_data
+    type(c_ptr) :: black_magic
+
+    call prepare_write(this)
+
+    if (size(fortran_data) == 0) then
+      return
+    end if
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_vector_push_back_array(this%data, black_magic, int(size(fortran_data), c_size_t))
+  end subroutine vector_push_back_array
+
+
+  !* Uses a single memcpy under the hood.
+  !* Push count elements, starting at raw_c_pointer, to the back of the vector.
+  !* The memory must be contiguous and hold elements of this vector's type.
+  subroutine vector_append_n(this, raw_c_pointer, count)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_size_t), intent(in), value :: count
+
+    call prepare_write(this)
+
+    call internal_vector_push_back_array(this%data, raw_c_pointer, count)
+  end subroutine vector_append_n
+
+
+  !* Nothing is copied.
+  !* Add one uninitialized element to the back of the vector, and get a pointer to it.
+  !* Build your element right in the vector, instead of building it somewhere and copying it in.
+  !*
+  !* Example:
+  !* call c_f_pointer(v%emplace_back(), element)
+  !* element%x = 1
+  !*
+  !! The slot holds garbage until you write it. Write it before anything reads it, or the GC runs on it.
+  !! Like get(), the pointer is only good until the vector grows again.
+  function vector_emplace_back(this) result(raw_c_pointer)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    call prepare_write(this)
+
+    raw_c_pointer = internal_vector_emplace_back(this%data, 1_c_size_t)
+  end function vector_emplace_back
+
+
+  !* Nothing is copied.
+  !* Add count uninitialized elements to the back of the vector, and get a pointer to the first one.
+  !* The vector grows at most once, and the slots are contiguous, so you can fill them with a plain loop.
+  !*
+  !* Example:
+  !* call c_f_pointer(v%emplace_n(1000_8), elements, [1000])
+  !* do i = 1,1000
+  !*   elements(i)%x = i
+  !* end do
+  !*
+  !! The slots hold garbage until you write them. Write them before anything reads them, or the GC runs on them.
+  !! Like get(), the pointer is only good until the vector grows again.
+  function vector_emplace_n(this, count) result(raw_c_pointer)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr) :: raw_c_pointer
+
+    call prepare_write(this)
+
+    if (count < 1) then
+      raw_c_pointer = c_null_ptr
+      return
+    end if
+
+    raw_c_pointer = internal_vector_emplace_back(this%data, count)
+  end function vector_emplace_n
+
+
   !* Remove the last element of the vector.
   subroutine vector_pop_back(this)
     implicit none
@@ -242,6 +819,8 @@ contains
     class(vec), intent(inout) :: this
     integer(c_size_t) :: size
 
+    call prepare_write(this)
+
     !? If it's empty, popping can corrupt the memory.
     if (this%is_empty()) then
       return
@@ -257,6 +836,256 @@ contains
   end subroutine vector_pop_back
 
 
+  !* Move the last element of the vector out into out, and remove it.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* out must be the same type as the elements.
+  subroutine vector_pop_back_into(this, out)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    call prepare_write(this)
+
+    if (this%is_empty()) then
+      error stop "[Vector] Error: Can't pop from an empty vector."
+    end if
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call internal_vector_pop_back_into(this%data, black_magic)
+  end subroutine vector_pop_back_into
+
+
+  !* Move the element at index out into out, and remove it from the vector.
+  !* The GC does not run. Whatever the element owns belongs to out now.
+  !* out must be the same type as the elements.
+  subroutine vector_take(this, index, out)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    class(*), intent(inout), target :: out
+    type(c_ptr) :: black_magic
+
+    call prepare_write(this)
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    black_magic = transfer(loc(out), black_magic)
+
+    call internal_vector_take(this%data, index, black_magic)
+  end subroutine vector_take
+
+
+  !* Find the first element that has the same bytes as value.
+  !* Returns its index, or 0 if it's not in the vector.
+  !! Elements are compared bytewise. Derived types with padding or pointer components
+  !! compare the padding and the addresses, not what they point to.
+  function vector_find(this, value) result(index)
+    implicit none
+
+    class(vec), intent(in) :: this
+    class(*), intent(in), target :: value
+    integer(c_size_t) :: index
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(value), black_magic)
+
+    index = internal_vector_find(this%data, black_magic)
+  end function vector_find
+
+
+  !* Count the elements that have the same bytes as value.
+  function vector_count(this, value) result(count)
+    implicit none
+
+    class(vec), intent(in) :: this
+    class(*), intent(in), target :: value
+    integer(c_size_t) :: count
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(value), black_magic)
+
+    count = internal_vector_count(this%data, black_magic)
+  end function vector_count
+
+
+  !* Check if any element has the same bytes as value.
+  function vector_contains(this, value) result(contains)
+    implicit none
+
+    class(vec), intent(in) :: this
+    class(*), intent(in), target :: value
+    logical(c_bool) :: contains
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(value), black_magic)
+
+    contains = internal_vector_contains(this%data, black_magic)
+  end function vector_contains
+
+
+  !* Overwrite the elements first to last (inclusive) with value.
+  !* This will run the GC on the elements that get overwritten.
+  subroutine vector_fill(this, value, first, last)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    class(*), intent(in), target :: value
+    integer(c_size_t), intent(in), value :: first, last
+    type(c_ptr) :: black_magic
+
+    call prepare_write(this)
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (first < 1 .or. last > this%size() .or. first > last) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call run_gc(this, first, last)
+
+    black_magic = transfer(loc(value), black_magic)
+
+    call internal_vector_fill(this%data, first, last, black_magic)
+  end subroutine vector_fill
+
+
+  !* Sort the vector in place.
+  !* It's an introsort, so it's n log n no matter what, but it is not stable.
+  !* Your comparator must be bind(c). (See vec_compare_blueprint)
+  subroutine vector_sort(this, compare_func)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    procedure(vec_compare_blueprint) :: compare_func
+
+    call prepare_write(this)
+
+    call internal_vector_sort(this%data, c_funloc(compare_func))
+  end subroutine vector_sort
+
+
+  !* Get the index of the first element that doesn't go before value.
+  !* The vector must be sorted with the same comparator.
+  !* If every element goes before value, this is size() + 1.
+  function vector_lower_bound(this, value, compare_func) result(index)
+    implicit none
+
+    class(vec), intent(in) :: this
+    class(*), intent(in), target :: value
+    procedure(vec_compare_blueprint) :: compare_func
+    integer(c_size_t) :: index
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(value), black_magic)
+
+    index = internal_vector_lower_bound(this%data, black_magic, c_funloc(compare_func))
+  end function vector_lower_bound
+
+
+  !* Find an element that compares equal to value.
+  !* The vector must be sorted with the same comparator.
+  !* Returns its index, or 0 if it's not in the vector.
+  function vector_binary_search(this, value, compare_func) result(index)
+    implicit none
+
+    class(vec), intent(in) :: this
+    class(*), intent(in), target :: value
+    procedure(vec_compare_blueprint) :: compare_func
+    integer(c_size_t) :: index
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(value), black_magic)
+
+    index = internal_vector_binary_search(this%data, black_magic, c_funloc(compare_func))
+  end function vector_binary_search
+
+
+  !* Run func over the whole vector, in parallel.
+  !*
+  !* The elements are cut into spans of chunk_size (0 picks one for you), and every
+  !* thread in the pool takes spans until they're gone. (See vec_span_blueprint)
+  !* Returns once every span is done.
+  !! Don't push, insert, or remove from inside func, and don't start another parallel job.
+  subroutine vector_parallel_for_each(this, func, chunk_size, user_data)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    procedure(vec_span_blueprint) :: func
+    integer(c_size_t), intent(in), optional :: chunk_size
+    type(c_ptr), intent(in), optional :: user_data
+
+    ! func gets to write into the spans, so this counts as a change.
+    call prepare_write(this)
+
+    call internal_vector_parallel_for_each(this%data, optional_chunk_size(chunk_size), c_funloc(func), &
+      optional_user_data(user_data))
+  end subroutine vector_parallel_for_each
+
+
+  !* Run func over the whole vector in parallel, writing into output.
+  !*
+  !* output can hold any type. It's cleared (with its GC), then made the same size as this,
+  !* and func gets each span of this along with the same span of output. (See vec_transform_blueprint)
+  !*
+  !* this is only read, so it can be a clone or a read only mapping.
+  !! Don't write through input_pointer. Like get() or data_ptr(), it points straight into
+  !! memory a clone might share, or a file mapped read only.
+  subroutine vector_parallel_transform(this, func, output, chunk_size, user_data)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    procedure(vec_transform_blueprint) :: func
+    type(vec), intent(inout) :: output
+    integer(c_size_t), intent(in), optional :: chunk_size
+    type(c_ptr), intent(in), optional :: user_data
+
+    call output%clear()
+
+    call internal_vector_parallel_transform(this%data, output%data, optional_chunk_size(chunk_size), c_funloc(func), &
+      optional_user_data(user_data))
+  end subroutine vector_parallel_transform
+
+
+  !* Reduce the whole vector in parallel.
+  !*
+  !* Every span gets its own accumulator, starting as a copy of init, which func folds
+  !* the span into. (See vec_reduce_blueprint) Then combine_func folds the accumulators
+  !* into result one at a time, in order, so the answer is the same every run.
+  !*
+  !* init and result must be the same type. init has to be the identity of your
+  !* operation, like 0 for a sum, or 1 for a product.
+  subroutine vector_parallel_reduce(this, func, combine_func, init, result, chunk_size, user_data)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    procedure(vec_reduce_blueprint) :: func
+    procedure(vec_combine_blueprint) :: combine_func
+    class(*), intent(in), target :: init
+    class(*), intent(inout), target :: result
+    integer(c_size_t), intent(in), optional :: chunk_size
+    type(c_ptr), intent(in), optional :: user_data
+    type(c_ptr) :: init_black_magic, result_black_magic
+
+    if (storage_size(init) /= storage_size(result)) then
+      error stop "[Vector] Error: init and result must be the same type."
+    end if
+
+    init_black_magic = transfer(loc(init), init_black_magic)
+    result_black_magic = transfer(loc(result), result_black_magic)
+
+    call internal_vector_parallel_reduce(this%data, optional_chunk_size(chunk_size), c_funloc(func), c_funloc(combine_func), &
+      init_black_magic, result_black_magic, int(storage_size(result) / 8, c_size_t), optional_user_data(user_data))
+  end subroutine vector_parallel_reduce
+
+
   !* Reserve an internal capacity of the vector.
   subroutine vector_reserve(this, new_capacity)
     implicit none
@@ -264,12 +1093,16 @@ contains
     class(vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: new_capacity
 
+    call prepare_write(this)
+
     call internal_vector_reserve(this%data, new_capacity)
   end subroutine vector_reserve
 
 
   !* Resize a vector to a new size.
   !* Requires a new default element.
+  !* If it shrinks, the GC runs on the elements that get dropped.
+  !* If it grows, every new slot is a bytewise copy of default_element.
   subroutine vector_resize(this, new_size, default_element)
     implicit none
 
@@ -278,9 +1111,14 @@ contains
     class(*), intent(in), target :: default_element
     type(c_ptr) :: black_magic
 
-    black_magic = transfer(loc(default_element), black_magic)
+    call prepare_write(this)
 
-    !! FIXME: this will need some in depth analysis of how to GC this.
+    ! Clean up whatever gets dropped off the end.
+    if (new_size < this%size()) then
+      call run_gc(this, new_size + 1, this%size())
+    end if
+
+    black_magic = transfer(loc(default_element), black_magic)
 
     call internal_vector_resize(this%data, new_size, black_magic)
   end subroutine vector_resize
@@ -293,33 +1131,293 @@ contains
 
     class(vec), intent(inout) :: this
     type(vec), intent(inout) :: other
+    logical(c_bool) :: read_only
 
     call internal_vector_swap(this%data, other%data)
+
+    ! A mapping stays read only wherever it ends up.
+    read_only = this%read_only
+    this%read_only = other%read_only
+    other%read_only = read_only
   end subroutine vector_swap
 
 
-  !* Clone a vector into another one.
-  !* Might want to make sure that it's uninitialized or this might cause issues.
+  !* Clone a vector into another one. Whatever other held is destroyed first.
+  !*
+  !* This is copy on write. Nothing is copied right away, both vectors share the same memory.
+  !* The first time either of them changes, that one gets a copy of its own, of just the elements.
+  !* So a snapshot that's only ever read costs nothing, no matter how big the vector is.
+  !* It's safe to destroy clones from other threads.
+  !*
+  !* The clone doesn't get the GC. It's a snapshot of the elements, and this vector still owns
+  !* whatever they point to. The GC runs on this vector's elements when it changes or is destroyed,
+  !* same as always, so don't follow those pointers from the clone once this vector lets go of them.
+  !! Writing through get(), data_ptr(), or a view doesn't count as a change, it writes into
+  !! the shared memory. Call make_unique() first.
   subroutine vector_clone(this, other)
     implicit none
 
     class(vec), intent(in) :: this
     type(vec), intent(inout) :: other
 
-    call internal_vector_clone(this%data, other%data)
+    if (this%read_only) then
+      error stop "[Vector] Error: Can't clone a read only vector. Use load() to get a copy you can change."
+    end if
+
+    call other%destroy()
+
+    other%data = internal_vector_share(this%data)
+    other%size_of_type = this%size_of_type
+    other%gc_func = c_null_funptr
+    other%gc_range_func = c_null_funptr
   end subroutine vector_clone
 
 
+  !* Check if this vector still shares its memory with a clone.
+  function vector_is_shared(this) result(shared)
+    implicit none
+
+    class(vec), intent(in) :: this
+    logical(c_bool) :: shared
+
+    shared = .false.
+
+    if (c_associated(this%data)) then
+      shared = internal_vector_is_shared(this%data)
+    end if
+  end function vector_is_shared
+
+
+  !* Make sure this vector has memory of its own, copying it if a clone still shares it.
+  !* Do this before writing through get(), data_ptr(), or a view.
+  subroutine vector_make_unique(this)
+    implicit none
+
+    class(vec), intent(inout) :: this
+
+    call prepare_write(this)
+  end subroutine vector_make_unique
+
+
+  !* Write the vector to a file, replacing it. The header and every element go out in one write.
+  !* The elements are written as raw bytes, so anything they point to is not saved.
+  subroutine vector_save(this, path)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    character(len = *), intent(in) :: path
+
+    if (.not. c_associated(this%data)) then
+      error stop "[Vector] Error: Can't save a vector that was never created."
+    end if
+
+    call check_io_status(internal_vector_save(this%data, trim(path)//c_null_char))
+  end subroutine vector_save
+
+
+  !* Replace the elements of the vector with the ones in a file written by save().
+  !* They're read straight into the vector's memory.
+  !* The GC runs on the elements that were there before.
+  !* The vector keeps its own allocator, alignment, GC, and growth policy.
+  !* The file must have been saved from a vector with the same size_of_type.
+  subroutine vector_load(this, path)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    character(len = *), intent(in) :: path
+
+    call prepare_write(this)
+
+    if (.not. c_associated(this%data)) then
+      error stop "[Vector] Error: Create the vector with new_vec() before loading into it."
+    end if
+
+    if (.not. this%is_empty()) then
+      call run_gc(this, 1_8, this%size())
+    end if
+
+    call check_io_status(internal_vector_load(this%data, trim(path)//c_null_char))
+  end subroutine vector_load
+
+
+  !* Turn this into a read only view of a file written by save(). Nothing is copied.
+  !* The pages are read in as you touch them, so even huge files are ready right away.
+  !* Whatever the vector held before is destroyed first.
+  !*
+  !* Everything that would change the vector stops with an error. It has no GC.
+  !* Destroying it unmaps the file.
+  !! Writing through get(), data_ptr(), or a view will crash. The memory is read only.
+  subroutine vector_map_readonly(this, path)
+    implicit none
+
+    class(vec), intent(inout) :: this
+    character(len = *), intent(in) :: path
+    integer(c_size_t), dimension(:), pointer :: header
+
+    call this%destroy()
+
+    call check_io_status(internal_vector_map_readonly(trim(path)//c_null_char, this%data))
+
+    ! The element size is the third field of the header.
+    call c_f_pointer(this%data, header, [3])
+
+    this%size_of_type = header(3)
+    this%gc_func = c_null_funptr
+    this%gc_range_func = c_null_funptr
+    this%read_only = .true.
+  end subroutine vector_map_readonly
+
+
+  !* Check if the vector is a read only mapping. (See map_readonly)
+  function vector_is_read_only(this) result(read_only)
+    implicit none
+
+    class(vec), intent(in) :: this
+    logical(c_bool) :: read_only
+
+    read_only = this%read_only
+  end function vector_is_read_only
+
+
+  !* Get what this vector has counted so far.
+  !* Everything is 0 if stats are off. (See stats_name in new_vec)
+  !* If the grows keep climbing, reserve peak_capacity up front.
+  function vector_get_stats(this) result(stats)
+    implicit none
+
+    class(vec), intent(in) :: this
+    type(vec_stats) :: stats
+    logical(c_bool) :: enabled
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    enabled = internal_vector_stats(this%data, stats)
+  end function vector_get_stats
+
+
+  !* Set the allocator that every new vector gets, when it is not given one.
+  !* Vectors that already exist keep the allocator they were created with.
+  !* Pass c_null_ptr to go back to malloc.
+  subroutine vec_set_global_allocator(allocator)
+    implicit none
+
+    type(c_ptr), intent(in), value :: allocator
+
+    call internal_vector_set_global_allocator(allocator)
+  end subroutine vec_set_global_allocator
+
+
+  !* Set how many threads the parallel operations use, counting the thread that calls them.
+  !* The default (0) is one per core. Don't call this while a parallel operation is running.
+  subroutine vec_set_parallel_threads(thread_count)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: thread_count
+
+    call internal_vector_parallel_set_thread_count(thread_count)
+  end subroutine vec_set_parallel_threads
+
+
+  !* Print the stats of every vector that has them on, one line each.
+  !* Unnamed ones show up as (unnamed).
+  subroutine vec_stats_dump()
+    use, intrinsic :: iso_fortran_env, only: output_unit
+    implicit none
+
+    ! C has its own buffer for stdout, so get ours out first.
+    flush(output_unit)
+
+    call internal_vector_stats_dump()
+  end subroutine vec_stats_dump
+
+
 !? BEGIN INTERNAL ONLY ==============================================
 
+  !* Work out where an element lives, without calling into C.
+  function element_address(this, index) result(raw_c_pointer)
+    implicit none
+
+    type(vec), intent(in) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+    integer(c_intptr_t) :: address
+
+    address = transfer(this%data, address) + int(vector_header_size + ((index - 1) * this%size_of_type), c_intptr_t)
+
+    raw_c_pointer = transfer(address, raw_c_pointer)
+  end function element_address
+
+
+  function optional_chunk_size(chunk_size) result(size)
+    implicit none
+
+    integer(c_size_t), intent(in), optional :: chunk_size
+    integer(c_size_t) :: size
+
+    size = 0
+    if (present(chunk_size)) then
+      size = chunk_size
+    end if
+  end function optional_chunk_size
+
+
+  function optional_user_data(user_data) result(pointer)
+    implicit none
+
+    type(c_ptr), intent(in), optional :: user_data
+    type(c_ptr) :: pointer
+
+    pointer = c_null_ptr
+    if (present(user_data)) then
+      pointer = user_data
+    end if
+  end function optional_user_data
+
+
+  !* Everything that changes the vector calls this first.
+  !* A clone that still shares its memory gets a copy of its own here. (Copy on write)
+  subroutine prepare_write(this)
+    implicit none
+
+    type(vec), intent(inout) :: this
+
+    if (this%read_only) then
+      error stop "[Vector] Error: This vector is a read only mapping of a file."
+    end if
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    ! Only one of the owners ever has a GC, so the copy can't be cleaned up twice.
+    call internal_vector_unshare(this%data)
+  end subroutine prepare_write
+
+
+  !* Run the GC over the elements min to max.
+  !* A range GC gets them all in one call.
   subroutine run_gc(this, min, max)
     implicit none
 
     type(vec), intent(inout) :: this
     integer(c_size_t), intent(in), value :: min, max
     procedure(vec_gc_blueprint), pointer :: optional_gc
+    procedure(vec_gc_range_blueprint), pointer :: optional_gc_range
     integer(c_size_t) :: i
 
+    if (max < min) then
+      return
+    end if
+
+    if (c_associated(this%gc_range_func)) then
+      call c_f_procpointer(this%gc_range_func, optional_gc_range)
+      call optional_gc_range(element_address(this, min), (max - min) + 1, this%size_of_type)
+      call internal_vector_stats_record_gc_calls(this%data, (max - min) + 1)
+      return
+    end if
+
     ! No GC function was assigned to the vector.
     if (.not. c_associated(this%gc_func)) then
       return
@@ -328,8 +1426,10 @@ contains
     call c_f_procpointer(this%gc_func, optional_gc)
 
     do i = min, max
-      call optional_gc(this%get(i))
+      call optional_gc(element_address(this, i))
     end do
+
+    call internal_vector_stats_record_gc_calls(this%data, (max - min) + 1)
   end subroutine run_gc
 
 end module vector
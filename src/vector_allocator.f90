@@ -0,0 +1,229 @@
+module vector_allocator
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  implicit none
+
+
+  private
+
+
+  public :: vec_allocator
+  public :: new_vec_allocator
+  public :: vec_arena
+  public :: new_vec_arena
+  public :: vec_mmap_storage
+  public :: new_vec_mmap_storage
+
+
+  !* A custom table of memory functions for vectors.
+  !* Give allocator%get() to new_vec, or to vec_set_global_allocator.
+  type :: vec_allocator
+    private
+    type(c_ptr) :: data = c_null_ptr
+  contains
+    procedure :: destroy => vector_allocator_destroy
+    procedure :: get => vector_allocator_get
+  end type vec_allocator
+
+
+  !* A bump arena for vectors.
+  !*
+  !* If you create and destroy piles of small vectors per timestep, put them in an arena.
+  !* Every allocation is a pointer bump, and reset() releases every vector in it at once.
+  !*
+  !! After reset(), every vector that was in the arena is gone. Don't touch them.
+  !! If they have a GC, destroy them before you reset.
+  !! An arena is not thread safe. Use one per thread.
+  type :: vec_arena
+    private
+    type(c_ptr) :: data = c_null_ptr
+  contains
+    procedure :: destroy => vector_arena_destroy
+    procedure :: get => vector_arena_get
+    procedure :: reset => vector_arena_reset
+    procedure :: used => vector_arena_used
+  end type vec_arena
+
+
+  !* An mmap backed storage mode for very large vectors.
+  !*
+  !* Each vector made with it reserves reserve_bytes of virtual memory up front.
+  !* Pages are only committed when they're touched, so growing never copies.
+  !* The elements never move, so pointers from get() stay valid across push_back.
+  !* shrink_to_fit() gives the tail pages back to the kernel.
+  !*
+  !! The elements only move if a vector outgrows its whole reservation.
+  !! Destroy every vector made with it before you destroy the storage.
+  type :: vec_mmap_storage
+    private
+    type(c_ptr) :: data = c_null_ptr
+  contains
+    procedure :: destroy => vector_mmap_storage_destroy
+    procedure :: get => vector_mmap_storage_get
+  end type vec_mmap_storage
+
+
+contains
+
+
+  !* Create a new allocator table.
+  !* Your functions must be bind(c).
+  !* user_data is handed back to each of them.
+  function new_vec_allocator(allocate_func, reallocate_func, free_func, user_data) result(a)
+    implicit none
+
+    procedure(vec_allocate_blueprint) :: allocate_func
+    procedure(vec_reallocate_blueprint) :: reallocate_func
+    procedure(vec_free_blueprint) :: free_func
+    type(c_ptr), intent(in), optional :: user_data
+    type(vec_allocator) :: a
+    type(c_ptr) :: user_data_pointer
+
+    user_data_pointer = c_null_ptr
+    if (present(user_data)) then
+      user_data_pointer = user_data
+    end if
+
+    a%data = internal_new_vector_allocator(c_funloc(allocate_func), c_funloc(reallocate_func), c_funloc(free_func), &
+      user_data_pointer)
+  end function new_vec_allocator
+
+
+  !* Destroy the allocator table.
+  !* No vector may still be using it.
+  subroutine vector_allocator_destroy(this)
+    implicit none
+
+    class(vec_allocator), intent(inout) :: this
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call internal_destroy_vector_allocator(this%data)
+
+    this%data = c_null_ptr
+  end subroutine vector_allocator_destroy
+
+
+  !* Get the allocator to give to new_vec.
+  function vector_allocator_get(this) result(allocator)
+    implicit none
+
+    class(vec_allocator), intent(in) :: this
+    type(c_ptr) :: allocator
+
+    allocator = this%data
+  end function vector_allocator_get
+
+
+  !* Create a new bump arena.
+  !* chunk_size is how many bytes the arena grabs from malloc at a time.
+  function new_vec_arena(chunk_size) result(a)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: chunk_size
+    type(vec_arena) :: a
+
+    a%data = internal_new_vector_arena(chunk_size)
+  end function new_vec_arena
+
+
+  !* Destroy the arena, and every vector in it.
+  subroutine vector_arena_destroy(this)
+    implicit none
+
+    class(vec_arena), intent(inout) :: this
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call internal_destroy_vector_arena(this%data)
+
+    this%data = c_null_ptr
+  end subroutine vector_arena_destroy
+
+
+  !* Get the allocator to give to new_vec.
+  function vector_arena_get(this) result(allocator)
+    implicit none
+
+    class(vec_arena), intent(in) :: this
+    type(c_ptr) :: allocator
+
+    allocator = internal_vector_arena_allocator(this%data)
+  end function vector_arena_get
+
+
+  !* Release every vector in the arena at once.
+  !* If the arena needed more than one chunk, it merges them into one for next time.
+  subroutine vector_arena_reset(this)
+    implicit none
+
+    class(vec_arena), intent(inout) :: this
+
+    call internal_vector_arena_reset(this%data)
+  end subroutine vector_arena_reset
+
+
+  !* Get the number of bytes the arena has handed out.
+  function vector_arena_used(this) result(used)
+    implicit none
+
+    class(vec_arena), intent(in) :: this
+    integer(c_size_t) :: used
+
+    used = internal_vector_arena_used(this%data)
+  end function vector_arena_used
+
+
+  !* Create a new mmap storage mode.
+  !* reserve_bytes is how much virtual memory each vector reserves. Make it as big as the data can get.
+  !* huge_pages asks the kernel for transparent huge pages. (MADV_HUGEPAGE)
+  function new_vec_mmap_storage(reserve_bytes, huge_pages) result(s)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: reserve_bytes
+    logical, intent(in), optional :: huge_pages
+    type(vec_mmap_storage) :: s
+    logical(c_bool) :: use_huge_pages
+
+    use_huge_pages = .false.
+    if (present(huge_pages)) then
+      use_huge_pages = huge_pages
+    end if
+
+    s%data = internal_new_vector_mmap_storage(reserve_bytes, use_huge_pages)
+  end function new_vec_mmap_storage
+
+
+  !* Destroy the storage mode.
+  !* No vector may still be using it.
+  subroutine vector_mmap_storage_destroy(this)
+    implicit none
+
+    class(vec_mmap_storage), intent(inout) :: this
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call internal_destroy_vector_mmap_storage(this%data)
+
+    this%data = c_null_ptr
+  end subroutine vector_mmap_storage_destroy
+
+
+  !* Get the allocator to give to new_vec.
+  function vector_mmap_storage_get(this) result(allocator)
+    implicit none
+
+    class(vec_mmap_storage), intent(in) :: this
+    type(c_ptr) :: allocator
+
+    allocator = internal_vector_mmap_storage_allocator(this%data)
+  end function vector_mmap_storage_get
+
+
+end module vector_allocator
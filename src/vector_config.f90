@@ -0,0 +1,28 @@
+module vector_config
+  implicit none
+
+
+  !* Compile time switches for every vector type.
+  !*
+  !* These are parameters, so the compiler sees a constant and throws the
+  !* disabled code away completely. Flip them and rebuild.
+
+
+  !* Every get, set, insert, and remove checks that the index is in the vector.
+  !* Set this to .false. to compile the bounds checks out for release builds.
+  !! Only do this once your program is known to be correct. Out of bounds writes will corrupt memory.
+  logical, parameter :: VECTOR_BOUNDS_CHECKING = .true.
+
+
+  !* Turn stats on for every vec and concurrent_vec, as if each one was given a stats_name.
+  !* Then vec_stats_dump() lists all of them. (See vec_stats)
+  !* Set it back to .false. for release builds, counting isn't free.
+  logical, parameter :: VECTOR_STATS = .false.
+
+
+  !* How many bytes a small_vec holds inline, before it spills to the heap.
+  !* 64 bytes is 16 integers or 8 doubles.
+  integer, parameter :: SMALL_VEC_INLINE_BYTES = 64
+
+
+end module vector_config
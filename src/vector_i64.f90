@@ -0,0 +1,441 @@
+!! This file is generated by scripts/generate_typed_vectors.sh from scripts/templates/typed_vec.f90.in
+!! Don't edit it by hand, edit the template and run the script.
+module vector_i64
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector_config
+  implicit none
+
+
+  private
+
+
+  public :: vec_i64
+  public :: new_vec_i64
+
+
+  !* A vector of integer(c_int64_t).
+  !*
+  !* Same C memory as vec, but push_back, get, and set know the type,
+  !* so they're plain loads and stores instead of a memcpy through C.
+  !* It only calls into C when it has to reallocate.
+  type :: vec_i64
+    private
+    type(c_ptr) :: data = c_null_ptr
+  contains
+    procedure :: destroy => vec_i64_destroy
+    procedure :: get => vec_i64_get
+    procedure :: set => vec_i64_set
+    procedure :: push_back => vec_i64_push_back
+    procedure :: push_back_array => vec_i64_push_back_array
+    procedure :: emplace_n => vec_i64_emplace_n
+    procedure :: pop_back => vec_i64_pop_back
+    procedure :: find => vec_i64_find
+    procedure :: count => vec_i64_count
+    procedure :: contains => vec_i64_contains
+    procedure :: fill => vec_i64_fill
+    procedure :: sort => vec_i64_sort
+    procedure :: lower_bound => vec_i64_lower_bound
+    procedure :: binary_search => vec_i64_binary_search
+    procedure :: is_empty => vec_i64_is_empty
+    procedure :: size => vec_i64_size
+    procedure :: capacity => vec_i64_capacity
+    procedure :: clear => vec_i64_clear
+    procedure :: reserve => vec_i64_reserve
+    procedure :: resize => vec_i64_resize
+    procedure :: shrink_to_fit => vec_i64_shrink_to_fit
+    procedure :: view => vec_i64_view
+    procedure :: data_ptr => vec_i64_data_ptr
+  end type vec_i64
+
+
+  integer(c_size_t), parameter :: ELEMENT_SIZE = storage_size(0_c_int64_t) / 8
+
+
+contains
+
+
+  !* Create a new vector of integer(c_int64_t).
+  function new_vec_i64(initial_size) result(v)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: initial_size
+    type(vec_i64) :: v
+
+    v%data = internal_new_vector(initial_size, ELEMENT_SIZE, c_null_ptr, 0_c_size_t)
+  end function new_vec_i64
+
+
+  !* Destroy the underlying C memory.
+  subroutine vec_i64_destroy(this)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call internal_destroy_vector(this%data)
+
+    this%data = c_null_ptr
+  end subroutine vec_i64_destroy
+
+
+  !* Get the element at an index in the vector.
+  function vec_i64_get(this, index) result(value)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_size_t), intent(in), value :: index
+    integer(c_int64_t) :: value
+    integer(c_int64_t), pointer :: element
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call c_f_pointer(element_address(this, index), element)
+
+    value = element
+  end function vec_i64_get
+
+
+  !* Overwrite the element at an index in the vector.
+  subroutine vec_i64_set(this, index, value)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: index
+    integer(c_int64_t), intent(in) :: value
+    integer(c_int64_t), pointer :: element
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (index < 1 .or. index > this%size()) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call c_f_pointer(element_address(this, index), element)
+
+    element = value
+  end subroutine vec_i64_set
+
+
+  !* Push an element to the back of the vector.
+  subroutine vec_i64_push_back(this, value)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_int64_t), intent(in), target :: value
+    integer(c_size_t), dimension(:), pointer :: header
+    integer(c_int64_t), pointer :: element
+
+    ! Size and capacity are the first two things in the cvector_header.
+    call c_f_pointer(this%data, header, [2])
+
+    ! Out of room, C has to reallocate.
+    if (header(1) >= header(2)) then
+      call internal_vector_push_back(this%data, c_loc(value))
+      return
+    end if
+
+    call c_f_pointer(element_address(this, header(1) + 1), element)
+
+    element = value
+    header(1) = header(1) + 1
+  end subroutine vec_i64_push_back
+
+
+  !* Push a whole array to the back of the vector, in one copy.
+  subroutine vec_i64_push_back_array(this, values)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_int64_t), dimension(:), intent(in), target, contiguous :: values
+
+    if (size(values) == 0) then
+      return
+    end if
+
+    call internal_vector_push_back_array(this%data, c_loc(values(1)), int(size(values), c_size_t))
+  end subroutine vec_i64_push_back_array
+
+
+  !* Add count elements to the back of the vector without writing them, and get them as an array.
+  !* Fill them in with a plain loop, there's no temporary to copy from.
+  !! They hold garbage until you write them.
+  !! It's invalidated by anything that reallocates the vector.
+  function vec_i64_emplace_n(this, count) result(slots)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: count
+    integer(c_int64_t), dimension(:), pointer :: slots
+
+    if (count < 1) then
+      call c_f_pointer(element_address(this, 1_c_size_t), slots, [0])
+      return
+    end if
+
+    call c_f_pointer(internal_vector_emplace_back(this%data, count), slots, [count])
+  end function vec_i64_emplace_n
+
+
+  !* Remove the last element of the vector.
+  subroutine vec_i64_pop_back(this)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_size_t), dimension(:), pointer :: header
+
+    call c_f_pointer(this%data, header, [2])
+
+    !? If it's empty, popping can corrupt the memory.
+    if (header(1) == 0) then
+      return
+    end if
+
+    header(1) = header(1) - 1
+  end subroutine vec_i64_pop_back
+
+
+  !* Find the first element that has the same bits as value.
+  !* Returns its index, or 0 if it's not in the vector.
+  function vec_i64_find(this, value) result(index)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_int64_t), intent(in), target :: value
+    integer(c_size_t) :: index
+
+    index = internal_vector_find(this%data, c_loc(value))
+  end function vec_i64_find
+
+
+  !* Count the elements that have the same bits as value.
+  function vec_i64_count(this, value) result(count)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_int64_t), intent(in), target :: value
+    integer(c_size_t) :: count
+
+    count = internal_vector_count(this%data, c_loc(value))
+  end function vec_i64_count
+
+
+  !* Check if any element has the same bits as value.
+  function vec_i64_contains(this, value) result(contains)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_int64_t), intent(in), target :: value
+    logical(c_bool) :: contains
+
+    contains = internal_vector_contains(this%data, c_loc(value))
+  end function vec_i64_contains
+
+
+  !* Overwrite the elements first to last (inclusive) with value.
+  subroutine vec_i64_fill(this, value, first, last)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_int64_t), intent(in), target :: value
+    integer(c_size_t), intent(in), value :: first, last
+
+    if (VECTOR_BOUNDS_CHECKING) then
+      if (first < 1 .or. last > this%size() .or. first > last) then
+        error stop "[Vector] Error: Went out of bounds."
+      end if
+    end if
+
+    call internal_vector_fill(this%data, first, last, c_loc(value))
+  end subroutine vec_i64_fill
+
+
+  !* Sort the vector in place, smallest first.
+  !* This is a radix sort, so it's linear in the size of the vector.
+  subroutine vec_i64_sort(this)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+
+    call internal_vector_radix_sort(this%data, VEC_RADIX_SIGNED)
+  end subroutine vec_i64_sort
+
+
+  !* Get the index of the first element that isn't less than value.
+  !* The vector must be sorted. If every element is less than value, this is size() + 1.
+  function vec_i64_lower_bound(this, value) result(index)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_int64_t), intent(in), target :: value
+    integer(c_size_t) :: index
+
+    index = internal_vector_radix_lower_bound(this%data, c_loc(value), VEC_RADIX_SIGNED)
+  end function vec_i64_lower_bound
+
+
+  !* Find an element equal to value. The vector must be sorted.
+  !* Returns its index, or 0 if it's not in the vector.
+  function vec_i64_binary_search(this, value) result(index)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_int64_t), intent(in), target :: value
+    integer(c_size_t) :: index
+
+    index = internal_vector_radix_binary_search(this%data, c_loc(value), VEC_RADIX_SIGNED)
+  end function vec_i64_binary_search
+
+
+  !* Check if the vector is empty.
+  function vec_i64_is_empty(this) result(empty)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    logical(c_bool) :: empty
+
+    empty = this%size() == 0
+  end function vec_i64_is_empty
+
+
+  !* Get the number of elements in the vector.
+  function vec_i64_size(this) result(size)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_size_t) :: size
+    integer(c_size_t), dimension(:), pointer :: header
+
+    if (.not. c_associated(this%data)) then
+      size = 0
+      return
+    end if
+
+    call c_f_pointer(this%data, header, [2])
+
+    size = header(1)
+  end function vec_i64_size
+
+
+  !* Get the number of elements the vector can hold before it reallocates.
+  function vec_i64_capacity(this) result(capacity)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_size_t) :: capacity
+    integer(c_size_t), dimension(:), pointer :: header
+
+    if (.not. c_associated(this%data)) then
+      capacity = 0
+      return
+    end if
+
+    call c_f_pointer(this%data, header, [2])
+
+    capacity = header(2)
+  end function vec_i64_capacity
+
+
+  !* Clear all elements out of the vector. The capacity stays.
+  subroutine vec_i64_clear(this)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+
+    call internal_vector_clear(this%data)
+  end subroutine vec_i64_clear
+
+
+  !* Reserve an internal capacity of the vector.
+  subroutine vec_i64_reserve(this, new_capacity)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_capacity
+
+    call internal_vector_reserve(this%data, new_capacity)
+  end subroutine vec_i64_reserve
+
+
+  !* Resize the vector. New slots get default_value.
+  subroutine vec_i64_resize(this, new_size, default_value)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+    integer(c_size_t), intent(in), value :: new_size
+    integer(c_int64_t), intent(in), target :: default_value
+
+    call internal_vector_resize(this%data, new_size, c_loc(default_value))
+  end subroutine vec_i64_resize
+
+
+  !* Shrink the capacity down to the size.
+  subroutine vec_i64_shrink_to_fit(this)
+    implicit none
+
+    class(vec_i64), intent(inout) :: this
+
+    call internal_vector_shrink_to_fit(this%data)
+  end subroutine vec_i64_shrink_to_fit
+
+
+  !* Get a Fortran array pointer over every element, without copying.
+  !! It's invalidated by anything that reallocates the vector.
+  function vec_i64_view(this) result(array)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    integer(c_int64_t), dimension(:), pointer :: array
+
+    ! Never created, so there's nothing to point at.
+    if (.not. c_associated(this%data)) then
+      call c_f_pointer(c_null_ptr, array, [0])
+      return
+    end if
+
+    call c_f_pointer(element_address(this, 1_c_size_t), array, [this%size()])
+  end function vec_i64_view
+
+
+  !* Get a pointer to the start of the contiguous element memory.
+  !! It's invalidated by anything that reallocates the vector.
+  function vec_i64_data_ptr(this) result(raw_c_pointer)
+    implicit none
+
+    class(vec_i64), intent(in) :: this
+    type(c_ptr) :: raw_c_pointer
+
+    raw_c_pointer = c_null_ptr
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    raw_c_pointer = element_address(this, 1_c_size_t)
+  end function vec_i64_data_ptr
+
+
+!? BEGIN INTERNAL ONLY ==============================================
+
+  !* Work out where an element lives, without calling into C.
+  function element_address(this, index) result(raw_c_pointer)
+    implicit none
+
+    type(vec_i64), intent(in) :: this
+    integer(c_size_t), intent(in), value :: index
+    type(c_ptr) :: raw_c_pointer
+    integer(c_intptr_t) :: address
+
+    address = transfer(this%data, address) + int(vector_header_size + ((index - 1) * ELEMENT_SIZE), c_intptr_t)
+
+    raw_c_pointer = transfer(address, raw_c_pointer)
+  end function element_address
+
+end module vector_i64
@@ -0,0 +1,40 @@
+module vector_io_status
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  implicit none
+
+
+  private
+
+
+  public :: check_io_status
+
+
+contains
+
+
+  !* Turn a cvector_io_status from save, load, map, or a stream into an error stop.
+  !* Shared by vec and the stream types, so they all report a file the same way.
+  subroutine check_io_status(status)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: status
+
+    select case (status)
+    case (VEC_IO_OK)
+      return
+    case (VEC_IO_OPEN_FAILED)
+      error stop "[Vector] Error: Couldn't open the file."
+    case (VEC_IO_TRANSFER_FAILED)
+      error stop "[Vector] Error: Couldn't read or write the whole file."
+    case (VEC_IO_BAD_FILE)
+      error stop "[Vector] Error: That's not a vector file, or it was saved by another version or byte order."
+    case (VEC_IO_ELEMENT_SIZE_MISMATCH)
+      error stop "[Vector] Error: The file's elements aren't the same size as this vector's."
+    case default
+      error stop "[Vector] Error: Unknown file error."
+    end select
+  end subroutine check_io_status
+
+
+end module vector_io_status
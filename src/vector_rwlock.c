@@ -0,0 +1,64 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+/**
+ * Create a new reader/writer lock.
+ *
+ * On glibc, writers are preferred so a single producer can't be starved by a
+ * constant stream of readers.
+ */
+pthread_rwlock_t *vector_rwlock_create()
+{
+  pthread_rwlock_t *rwlock = malloc(sizeof(pthread_rwlock_t));
+  assert(rwlock);
+
+  pthread_rwlockattr_t attributes;
+  pthread_rwlockattr_init(&attributes);
+
+#ifdef __GLIBC__
+  pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+
+  int status = pthread_rwlock_init(rwlock, &attributes);
+  assert(status == 0);
+  (void)status;
+
+  pthread_rwlockattr_destroy(&attributes);
+
+  return rwlock;
+}
+
+/**
+ * Free a reader/writer lock. It must not be held.
+ */
+void vector_rwlock_destroy(pthread_rwlock_t *rwlock)
+{
+  pthread_rwlock_destroy(rwlock);
+  free(rwlock);
+}
+
+/**
+ * Take shared (read) access.
+ */
+int vector_rwlock_lock_shared(pthread_rwlock_t *rwlock)
+{
+  return pthread_rwlock_rdlock(rwlock);
+}
+
+/**
+ * Take exclusive (write) access.
+ */
+int vector_rwlock_lock_exclusive(pthread_rwlock_t *rwlock)
+{
+  return pthread_rwlock_wrlock(rwlock);
+}
+
+/**
+ * Release either kind of access.
+ */
+int vector_rwlock_unlock(pthread_rwlock_t *rwlock)
+{
+  return pthread_rwlock_unlock(rwlock);
+}
@@ -0,0 +1,223 @@
+module vector_stream
+  use, intrinsic :: iso_c_binding
+  use :: fortran_vector_bindings
+  use :: vector_io_status
+  implicit none
+
+
+  private
+
+
+  public :: vec_stream_writer
+  public :: new_vec_stream_writer
+  public :: vec_stream_reader
+  public :: new_vec_stream_reader
+
+
+  !* Streams elements into a file, a chunk at a time.
+  !*
+  !* Only one chunk is ever in memory, so you can write far more than fits in RAM.
+  !* The file is the same format vec%save() makes, so vec%load() and vec%map_readonly()
+  !* can open it once it's destroyed.
+  !*
+  !! The file isn't finished until you call destroy().
+  type :: vec_stream_writer
+    private
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_size_t) :: size_of_type = 0
+  contains
+    procedure :: destroy => vector_stream_writer_destroy
+    procedure :: push_back => vector_stream_writer_push_back
+    procedure :: push_back_array => vector_stream_writer_push_back_array
+    procedure :: size => vector_stream_writer_size
+  end type vec_stream_writer
+
+
+  !* Streams elements out of a file, a chunk at a time.
+  !*
+  !* It's double buffered. While you work on one chunk, the next one
+  !* is already being read in the background.
+  !* Two chunks are in memory at most, no matter how big the file is.
+  type :: vec_stream_reader
+    private
+    type(c_ptr) :: data = c_null_ptr
+    integer(c_size_t) :: size_of_type = 0
+  contains
+    procedure :: destroy => vector_stream_reader_destroy
+    procedure :: next => vector_stream_reader_next
+    procedure :: size => vector_stream_reader_size
+  end type vec_stream_reader
+
+
+contains
+
+
+  !* Create a file to stream elements into, replacing it.
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* chunk_size is how many elements are buffered before each write.
+  function new_vec_stream_writer(path, size_of_type, chunk_size) result(w)
+    implicit none
+
+    character(len = *), intent(in) :: path
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, chunk_size
+    type(vec_stream_writer) :: w
+
+    if (size_of_type < 1 .or. chunk_size < 1) then
+      error stop "[Vector] Error: A stream needs a size_of_type and chunk_size of at least 1."
+    end if
+
+    call check_io_status(internal_new_vector_stream_writer(trim(path)//c_null_char, size_of_type, chunk_size, w%data))
+
+    w%size_of_type = size_of_type
+  end function new_vec_stream_writer
+
+
+  !* Write out whatever is still buffered, finish the file, and free the writer.
+  subroutine vector_stream_writer_destroy(this)
+    implicit none
+
+    class(vec_stream_writer), intent(inout) :: this
+    integer(c_size_t) :: status
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    status = internal_destroy_vector_stream_writer(this%data)
+
+    this%data = c_null_ptr
+    this%size_of_type = 0
+
+    call check_io_status(status)
+  end subroutine vector_stream_writer_destroy
+
+
+  !* Uses memcpy under the hood.
+  !* Push an element onto the end of the stream.
+  subroutine vector_stream_writer_push_back(this, fortran_data)
+    implicit none
+
+    class(vec_stream_writer), intent(inout) :: this
+    class(*), intent(in), target :: fortran_data
+    type(c_ptr) :: black_magic
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_vector_stream_writer_push_back(this%data, black_magic)
+  end subroutine vector_stream_writer_push_back
+
+
+  !* Uses memcpy under the hood.
+  !* Push a whole contiguous Fortran array onto the end of the stream.
+  subroutine vector_stream_writer_push_back_array(this, fortran_data)
+    implicit none
+
+    class(vec_stream_writer), intent(inout) :: this
+    class(*), dimension(:), intent(in), target, contiguous :: fortran_data
+    type(c_ptr) :: black_magic
+
+    if (size(fortran_data) == 0) then
+      return
+    end if
+
+    black_magic = transfer(loc(fortran_data), black_magic)
+
+    call internal_vector_stream_writer_push_back_array(this%data, black_magic, int(size(fortran_data), c_size_t))
+  end subroutine vector_stream_writer_push_back_array
+
+
+  !* Get how many elements have been pushed so far.
+  function vector_stream_writer_size(this) result(size)
+    implicit none
+
+    class(vec_stream_writer), intent(in) :: this
+    integer(c_size_t) :: size
+
+    size = internal_vector_stream_writer_size(this%data)
+  end function vector_stream_writer_size
+
+
+  !* Open a file written by a vec_stream_writer or vec%save().
+  !* I did not create a module interface because I want you to be able to see explicitly
+  !* Where you create your vector.
+  !*
+  !* chunk_size is how many elements each chunk holds. The first chunk starts reading right away.
+  !* size_of_type must match the file.
+  function new_vec_stream_reader(path, size_of_type, chunk_size) result(r)
+    implicit none
+
+    character(len = *), intent(in) :: path
+    ! size_of_type allows you to simply get the size of your type before and hard code it into your program. 8)
+    integer(c_size_t), intent(in), value :: size_of_type, chunk_size
+    type(vec_stream_reader) :: r
+
+    if (size_of_type < 1 .or. chunk_size < 1) then
+      error stop "[Vector] Error: A stream needs a size_of_type and chunk_size of at least 1."
+    end if
+
+    call check_io_status(internal_new_vector_stream_reader(trim(path)//c_null_char, size_of_type, chunk_size, r%data))
+
+    r%size_of_type = size_of_type
+  end function new_vec_stream_reader
+
+
+  !* Stop the background reads, and free the reader.
+  subroutine vector_stream_reader_destroy(this)
+    implicit none
+
+    class(vec_stream_reader), intent(inout) :: this
+
+    if (.not. c_associated(this%data)) then
+      return
+    end if
+
+    call internal_destroy_vector_stream_reader(this%data)
+
+    this%data = c_null_ptr
+    this%size_of_type = 0
+  end subroutine vector_stream_reader_destroy
+
+
+  !* Get the next chunk. Gives back .false. once the whole stream has been read.
+  !* chunk points at count contiguous elements. Use it like so:
+  !*
+  !* do while (r%next(chunk, count))
+  !*   call c_f_pointer(chunk, array, [count])
+  !*   ...
+  !* end do
+  !*
+  !! The chunk is only good until the next call to next(). Its buffer gets reused.
+  function vector_stream_reader_next(this, chunk, count) result(got)
+    implicit none
+
+    class(vec_stream_reader), intent(inout) :: this
+    type(c_ptr), intent(out) :: chunk
+    integer(c_size_t), intent(out) :: count
+    logical(c_bool) :: got
+
+    chunk = c_null_ptr
+    count = 0
+
+    got = internal_vector_stream_reader_next(this%data, chunk, count)
+
+    if (.not. got) then
+      call check_io_status(internal_vector_stream_reader_status(this%data))
+    end if
+  end function vector_stream_reader_next
+
+
+  !* Get the number of elements in the whole stream.
+  function vector_stream_reader_size(this) result(size)
+    implicit none
+
+    class(vec_stream_reader), intent(in) :: this
+    integer(c_size_t) :: size
+
+    size = internal_vector_stream_reader_size(this%data)
+  end function vector_stream_reader_size
+
+
+end module vector_stream
@@ -0,0 +1,153 @@
+module concurrent_append_test_workers
+  use, intrinsic :: iso_c_binding
+  use :: concurrent_append_vector
+  implicit none
+
+  !* How many threads push at once, and how much each of them pushes.
+  integer, parameter :: THREADS = 4
+  integer, parameter :: PUSHES_PER_THREAD = 20000
+  integer, parameter :: ARRAY_LENGTH = 100
+
+  !* Every thread pushes into this one vector at the same time.
+  type(concurrent_append_vec) :: shared
+
+  !* Where each thread's push_back_array landed. Each thread only writes its own slot.
+  integer(c_size_t), dimension(THREADS) :: array_index = 0
+
+contains
+
+  !* The value a thread pushes on its i'th push, so we can tell who pushed what.
+  function tagged(thread, i) result(value)
+    implicit none
+
+    integer(c_int), intent(in), value :: thread, i
+    integer(c_int) :: value
+
+    value = (thread * 10000000) + i
+  end function tagged
+
+
+  !* Each thread runs this with a span of one element, its thread number.
+  !* We're just borrowing parallel_for_each to get real threads.
+  subroutine pusher(base_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int), pointer :: thread
+    integer(c_int), dimension(ARRAY_LENGTH), target :: values
+    integer(c_int) :: i
+
+    call c_f_pointer(base_pointer, thread)
+
+    do i = 1, PUSHES_PER_THREAD
+      call shared%push_back(tagged(thread, i))
+    end do
+
+    !* An array always gets indices one after another, even with everyone else pushing.
+    do i = 1, ARRAY_LENGTH
+      values(i) = tagged(thread, PUSHES_PER_THREAD + i)
+    end do
+
+    call shared%push_back_array(values, array_index(thread))
+  end subroutine pusher
+
+end module concurrent_append_test_workers
+
+
+!* concurrent_append_vec: many threads pushing at once, and addresses that never move.
+program test_concurrent_append_vec
+  use :: concurrent_append_test_workers
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  type(vec) :: threads_driver
+  type(c_ptr) :: first_address
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: thread, i, first_value
+  integer(c_size_t) :: index
+  logical, dimension(:, :), allocatable :: seen
+
+
+  !* Start small, so the threads have to grow it many times while they push.
+  shared = new_concurrent_append_vec(int(c_sizeof(thread), c_size_t), 4_8)
+
+  !* Put one element in first, and hold on to its address.
+  first_value = -1
+  call shared%push_back(first_value)
+  first_address = shared%get(1_8)
+
+  !* One element per thread. parallel_for_each gives each one its own span.
+  call vec_set_parallel_threads(int(THREADS, c_size_t))
+  threads_driver = new_vec(int(c_sizeof(thread), c_size_t), 0_8)
+  do thread = 1, THREADS
+    call threads_driver%push_back(thread)
+  end do
+
+  call threads_driver%parallel_for_each(pusher, 1_8)
+
+
+  !* Nothing got lost.
+  if (shared%size() /= 1 + (THREADS * (PUSHES_PER_THREAD + ARRAY_LENGTH))) then
+    error stop "[Test] Pushes got lost."
+  end if
+
+  !* The first element never moved, no matter how much it grew.
+  if (.not. c_associated(first_address, shared%get(1_8))) then
+    error stop "[Test] The first element moved."
+  end if
+
+  call c_f_pointer(first_address, int_pointer)
+  if (int_pointer /= first_value) then
+    error stop "[Test] The first element changed."
+  end if
+
+
+  !* Every value shows up exactly once.
+  allocate(seen(THREADS, PUSHES_PER_THREAD + ARRAY_LENGTH))
+  seen = .false.
+
+  do index = 2, shared%size()
+    call c_f_pointer(shared%get(index), int_pointer)
+
+    thread = int_pointer / 10000000
+    i = mod(int_pointer, 10000000)
+
+    if (thread < 1 .or. thread > THREADS .or. i < 1 .or. i > PUSHES_PER_THREAD + ARRAY_LENGTH) then
+      error stop "[Test] Found a value nobody pushed."
+    end if
+
+    if (seen(thread, i)) then
+      error stop "[Test] Found a value twice."
+    end if
+
+    seen(thread, i) = .true.
+  end do
+
+  if (.not. all(seen)) then
+    error stop "[Test] A value is missing."
+  end if
+
+
+  !* And each array still has consecutive indices, in order.
+  do thread = 1, THREADS
+    do i = 1, ARRAY_LENGTH
+      call c_f_pointer(shared%get(array_index(thread) + int(i - 1, c_size_t)), int_pointer)
+
+      if (int_pointer /= tagged(thread, PUSHES_PER_THREAD + i)) then
+        error stop "[Test] An array got interleaved with other pushes."
+      end if
+    end do
+  end do
+
+
+  deallocate(seen)
+  call shared%destroy()
+  call threads_driver%destroy()
+  call vec_set_parallel_threads(0_8)
+
+  print*,"concurrent_append_vec: OK"
+
+end program test_concurrent_append_vec
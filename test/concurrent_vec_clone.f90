@@ -0,0 +1,90 @@
+module concurrent_clone_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* How many elements the GC has seen.
+  integer :: gc_count = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_count = gc_count + 1
+  end subroutine counting_gc
+
+end module concurrent_clone_test_module
+
+
+!* concurrent_vec%clone(): into a fresh vector and into one that's already in use.
+program test_concurrent_vec_clone
+  use :: concurrent_clone_test_module
+  use :: concurrent_vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int), parameter :: COUNT = 100
+
+  type(concurrent_vec) :: v, copy
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+
+
+  v = new_concurrent_vec(int(c_sizeof(i), c_size_t), 0_8, counting_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* The clone has every element, in its own memory.
+  call v%clone(copy)
+
+  if (copy%size() /= COUNT) then
+    error stop "[Test] The clone has the wrong size."
+  end if
+
+  call copy%lock()
+  do i = 1, COUNT
+    call c_f_pointer(copy%get_unlocked(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] The clone has the wrong element."
+    end if
+  end do
+  call copy%unlock()
+
+  !* It has its own lock, and changing it doesn't touch the original.
+  call copy%push_back(COUNT + 1)
+  if (v%size() /= COUNT .or. copy%size() /= COUNT + 1) then
+    error stop "[Test] The clone isn't separate from the original."
+  end if
+
+
+  !* Cloning into a vector that's in use destroys what it held first.
+  !* It's a clone, so it had no GC, and nothing gets cleaned up twice.
+  call v%clone(copy)
+
+  if (gc_count /= 0) then
+    error stop "[Test] Cloning into a used vector ran the GC."
+  end if
+
+  if (copy%size() /= COUNT) then
+    error stop "[Test] Cloning into a used vector kept its old elements."
+  end if
+
+  call copy%destroy()
+  if (gc_count /= 0) then
+    error stop "[Test] The clone ran the GC."
+  end if
+
+
+  !* Only the original cleans up.
+  call v%destroy()
+  if (gc_count /= COUNT) then
+    error stop "[Test] The original didn't GC its elements."
+  end if
+
+  print*,"concurrent_vec clone: OK"
+
+end program test_concurrent_vec_clone
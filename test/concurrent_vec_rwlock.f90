@@ -0,0 +1,77 @@
+!* concurrent_vec with use_rwlock: readers share the lock, writers still get it to themselves.
+program test_concurrent_vec_rwlock
+  use :: concurrent_vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int), parameter :: COUNT = 1000
+
+  type(concurrent_vec) :: v
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+
+
+  v = new_concurrent_vec(int(c_sizeof(i), c_size_t), 0_8, use_rwlock = .true.)
+
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* Hold shared access for a batch of reads.
+  call v%lock_shared()
+
+  if (v%size_unlocked() /= COUNT .or. v%is_empty_unlocked()) then
+    error stop "[Test] Wrong size under a shared lock."
+  end if
+
+  do i = 1, COUNT
+    call c_f_pointer(v%get_unlocked(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] Wrong element under a shared lock."
+    end if
+  end do
+
+  !* get, size, and capacity only take shared access, so they run while another reader holds it.
+  !* With a plain mutex, these would wait on ourselves forever.
+  if (v%size() /= COUNT .or. v%capacity() < COUNT) then
+    error stop "[Test] A reader couldn't share the lock."
+  end if
+
+  call c_f_pointer(v%get(1_8), int_pointer)
+  if (int_pointer /= 1) then
+    error stop "[Test] A reader got the wrong element while sharing the lock."
+  end if
+
+  call v%unlock()
+
+
+  !* Writes take exclusive access, and see everything the readers saw.
+  call v%lock()
+  do i = 1, COUNT
+    call v%push_back_unlocked(-i)
+  end do
+  call v%unlock()
+
+  call v%set(1_8, 0)
+  call v%remove(2_8)
+
+  if (v%size() /= (2 * COUNT) - 1) then
+    error stop "[Test] Writes under the rwlock went wrong."
+  end if
+
+  call c_f_pointer(v%get(1_8), int_pointer)
+  if (int_pointer /= 0) then
+    error stop "[Test] set() under the rwlock didn't stick."
+  end if
+
+  call c_f_pointer(v%get(2_8), int_pointer)
+  if (int_pointer /= 3) then
+    error stop "[Test] remove() under the rwlock didn't stick."
+  end if
+
+  call v%destroy()
+
+  print*,"concurrent_vec rwlock: OK"
+
+end program test_concurrent_vec_rwlock
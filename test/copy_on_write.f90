@@ -0,0 +1,178 @@
+module copy_on_write_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* How many elements the GC has seen.
+  integer :: gc_count = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_count = gc_count + 1
+  end subroutine counting_gc
+
+
+  !* Negate a span in place.
+  subroutine negate_span(base_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int), dimension(:), pointer :: elements
+
+    call c_f_pointer(base_pointer, elements, [count])
+
+    elements = -elements
+  end subroutine negate_span
+
+end module copy_on_write_test_module
+
+
+!* clone(): vectors share their memory until one of them changes.
+program test_copy_on_write
+  use :: copy_on_write_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int), parameter :: COUNT = 100
+
+  type(vec) :: v, snapshot
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_8, counting_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* Right after cloning, both point at the same memory.
+  call v%clone(snapshot)
+
+  if (.not. v%is_shared() .or. .not. snapshot%is_shared()) then
+    error stop "[Test] A fresh clone isn't shared."
+  end if
+
+  if (.not. c_associated(v%get(1_8), snapshot%get(1_8))) then
+    error stop "[Test] A fresh clone copied the elements."
+  end if
+
+
+  !* The original can keep changing while the clone is around. The first change unshares it.
+  call v%push_back(COUNT + 1)
+
+  if (v%is_shared() .or. snapshot%is_shared()) then
+    error stop "[Test] A write didn't unshare."
+  end if
+
+  if (v%size() /= COUNT + 1 .or. snapshot%size() /= COUNT) then
+    error stop "[Test] The write showed up in the clone."
+  end if
+
+  call v%remove(1_8)
+  call v%set(1_8, -2)
+
+  !* The original owns the elements, so its changes still GC them.
+  if (gc_count /= 2) then
+    error stop "[Test] The original stopped running its GC after being cloned."
+  end if
+
+  !* The clone still has the elements from when it was made.
+  do i = 1, COUNT
+    call c_f_pointer(snapshot%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] The clone changed under us."
+    end if
+  end do
+
+
+  !* The clone doesn't get the GC, so changing or destroying it never cleans up the original's elements.
+  call snapshot%pop_back()
+  call snapshot%destroy()
+
+  if (gc_count /= 2) then
+    error stop "[Test] The clone ran the GC."
+  end if
+
+
+  !* Destroying the original while a clone still shares its memory.
+  !* The GC runs on every element, and the clone still sees what it had.
+  call v%clone(snapshot)
+  gc_count = 0
+  call v%destroy()
+
+  if (gc_count /= COUNT) then
+    error stop "[Test] Destroying a shared original didn't GC every element."
+  end if
+
+  if (snapshot%is_shared() .or. snapshot%size() /= COUNT) then
+    error stop "[Test] The clone lost its elements when the original was destroyed."
+  end if
+
+  call c_f_pointer(snapshot%get(1_8), int_pointer)
+  if (int_pointer /= -2) then
+    error stop "[Test] The clone has the wrong elements."
+  end if
+
+  call snapshot%destroy()
+
+
+  !* make_unique() gives a vector its own memory, so it's safe to write through get().
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+  call v%clone(snapshot)
+  call snapshot%make_unique()
+
+  if (v%is_shared() .or. snapshot%is_shared()) then
+    error stop "[Test] make_unique() didn't unshare."
+  end if
+
+  call c_f_pointer(snapshot%get(1_8), int_pointer)
+  int_pointer = 0
+
+  call c_f_pointer(v%get(1_8), int_pointer)
+  if (int_pointer /= 1) then
+    error stop "[Test] Writing after make_unique() changed the original."
+  end if
+
+  call snapshot%destroy()
+
+
+  !* parallel_for_each writes, so on a clone it unshares first.
+  call v%clone(snapshot)
+  call vec_set_parallel_threads(3_8)
+  call snapshot%parallel_for_each(negate_span, 7_8)
+  call vec_set_parallel_threads(0_8)
+
+  if (v%is_shared()) then
+    error stop "[Test] parallel_for_each didn't unshare."
+  end if
+
+  do i = 1, COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] parallel_for_each on a clone changed the original."
+    end if
+
+    call c_f_pointer(snapshot%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= -i) then
+      error stop "[Test] parallel_for_each on a clone missed an element."
+    end if
+  end do
+
+  call snapshot%destroy()
+  call v%destroy()
+
+  print*,"copy_on_write: OK"
+
+end program test_copy_on_write
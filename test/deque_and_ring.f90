@@ -0,0 +1,204 @@
+module deque_ring_test_workers
+  use, intrinsic :: iso_c_binding
+  use :: spsc_ring_vector
+  implicit none
+
+  !* How many elements go through the ring. It only holds a few at a time, so it wraps a lot.
+  integer(c_int), parameter :: TRANSFERS = 5000
+
+  type(spsc_ring) :: ring
+
+  !* Set by the consumer if anything came out of order.
+  logical :: out_of_order = .false.
+
+  !* How many elements the GC has seen.
+  integer :: gc_count = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_count = gc_count + 1
+  end subroutine counting_gc
+
+
+  !* Span 1 is the producer, span 2 is the consumer. They run on two threads at once.
+  subroutine producer_or_consumer(base_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int), pointer :: role
+    integer(c_int) :: i, value
+
+    call c_f_pointer(base_pointer, role)
+
+    if (role == 1) then
+      do i = 1, TRANSFERS
+        !* Full, so wait for the consumer.
+        do while (.not. ring%try_push(i))
+        end do
+      end do
+    else
+      do i = 1, TRANSFERS
+        !* Empty, so wait for the producer.
+        do while (.not. ring%try_pop(value))
+        end do
+
+        if (value /= i) then
+          out_of_order = .true.
+        end if
+      end do
+    end if
+  end subroutine producer_or_consumer
+
+end module deque_ring_test_workers
+
+
+!* deque_vec wrapping around its ring buffer, and a spsc_ring between two threads.
+program test_deque_and_ring
+  use :: deque_ring_test_workers
+  use :: deque_vector
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  type(deque_vec) :: d
+  type(vec) :: threads_driver
+  integer(c_int), dimension(:), allocatable :: model
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i, value
+  integer(c_size_t) :: index
+
+
+  !* The deque starts with 4 slots. Churning front to back walks the head around the buffer
+  !* over and over, and a plain Fortran array keeps track of what should be in it.
+  d = new_deque_vec(int(c_sizeof(i), c_size_t), 4_8, counting_gc)
+  allocate(model(0))
+
+  do i = 1, 3
+    call d%push_back(i)
+    model = [model, i]
+  end do
+
+  do i = 4, 1000
+    !* Every so often, grow while the head is somewhere in the middle of the buffer.
+    if (mod(i, 97) == 0) then
+      call d%push_front(-i)
+      model = [-i, model]
+      call d%push_back(i)
+      model = [model, i]
+      cycle
+    end if
+
+    call d%pop_front_into(value)
+    if (value /= model(1)) then
+      error stop "[Test] pop_front_into gave the wrong element."
+    end if
+    model = model(2:)
+
+    call d%push_back(i)
+    model = [model, i]
+
+    if (d%size() /= size(model)) then
+      error stop "[Test] The deque has the wrong size."
+    end if
+  end do
+
+  !* The capacity stays a power of 2.
+  if (iand(d%capacity(), d%capacity() - 1) /= 0) then
+    error stop "[Test] The capacity isn't a power of 2."
+  end if
+
+  !* Everything is in order, from front to back, across the wrap.
+  do index = 1, d%size()
+    call c_f_pointer(d%get(index), int_pointer)
+    if (int_pointer /= model(index)) then
+      error stop "[Test] The deque is out of order."
+    end if
+  end do
+
+  call c_f_pointer(d%front(), int_pointer)
+  if (int_pointer /= model(1)) then
+    error stop "[Test] front() is wrong."
+  end if
+
+  call c_f_pointer(d%back(), int_pointer)
+  if (int_pointer /= model(size(model))) then
+    error stop "[Test] back() is wrong."
+  end if
+
+  !* The *_into pops above moved their elements out, so the GC never ran.
+  if (gc_count /= 0) then
+    error stop "[Test] pop_front_into ran the GC."
+  end if
+
+  !* Plain pops do run it, from either end.
+  call d%pop_front()
+  call d%pop_back()
+  if (gc_count /= 2 .or. d%size() /= size(model) - 2) then
+    error stop "[Test] pop_front() or pop_back() went wrong."
+  end if
+
+  call d%destroy()
+  if (gc_count /= size(model)) then
+    error stop "[Test] destroy() didn't GC the rest."
+  end if
+
+  deallocate(model)
+
+
+  !* The ring rounds its capacity up to a power of 2, and never grows.
+  gc_count = 0
+  ring = new_spsc_ring(int(c_sizeof(i), c_size_t), 12_8, counting_gc)
+
+  if (ring%capacity() /= 16) then
+    error stop "[Test] The ring's capacity wasn't rounded up to 16."
+  end if
+
+  do i = 1, 16
+    if (.not. ring%try_push(i)) then
+      error stop "[Test] The ring filled up early."
+    end if
+  end do
+
+  if (ring%try_push(17)) then
+    error stop "[Test] A full ring took another element."
+  end if
+
+  !* Elements still in the ring get GC'd when it's destroyed.
+  call ring%destroy()
+  if (gc_count /= 16) then
+    error stop "[Test] destroy() didn't GC what was left in the ring."
+  end if
+
+
+  !* Now one thread pushes and another pops, through a ring much smaller than what goes through it.
+  ring = new_spsc_ring(int(c_sizeof(i), c_size_t), 16_8)
+
+  call vec_set_parallel_threads(2_8)
+  threads_driver = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+  call threads_driver%push_back(1)
+  call threads_driver%push_back(2)
+
+  call threads_driver%parallel_for_each(producer_or_consumer, 1_8)
+
+  if (out_of_order) then
+    error stop "[Test] The ring handed elements over out of order."
+  end if
+
+  if (.not. ring%is_empty()) then
+    error stop "[Test] The consumer didn't get everything."
+  end if
+
+  call ring%destroy()
+  call threads_driver%destroy()
+  call vec_set_parallel_threads(0_8)
+
+  print*,"deque_vec and spsc_ring: OK"
+
+end program test_deque_and_ring
@@ -0,0 +1,256 @@
+module flat_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* Only key is compared, so two entries can be "the same" and still be told apart by tag.
+  type, bind(c) :: tagged_key
+    integer(c_int) :: key
+    integer(c_int) :: tag
+  end type tagged_key
+
+  !* How many elements each GC has seen.
+  integer :: key_gc_count = 0
+  integer :: value_gc_count = 0
+
+contains
+
+  function compare_tagged_keys(a, b) result(order) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: a, b
+    integer(c_int) :: order
+    type(tagged_key), pointer :: x, y
+
+    call c_f_pointer(a, x)
+    call c_f_pointer(b, y)
+
+    if (x%key < y%key) then
+      order = -1
+    else if (x%key > y%key) then
+      order = 1
+    else
+      order = 0
+    end if
+  end function compare_tagged_keys
+
+
+  function compare_ints(a, b) result(order) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: a, b
+    integer(c_int) :: order
+    integer(c_int), pointer :: x, y
+
+    call c_f_pointer(a, x)
+    call c_f_pointer(b, y)
+
+    if (x < y) then
+      order = -1
+    else if (x > y) then
+      order = 1
+    else
+      order = 0
+    end if
+  end function compare_ints
+
+
+  subroutine counting_key_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    key_gc_count = key_gc_count + 1
+  end subroutine counting_key_gc
+
+
+  subroutine counting_value_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    value_gc_count = value_gc_count + 1
+  end subroutine counting_value_gc
+
+end module flat_test_module
+
+
+!* flat_set and flat_map: batched inserts merged in sorted, with duplicates dropped and the newest kept.
+program test_flat_set_and_map
+  use :: flat_test_module
+  use :: flat_set_vector
+  use :: flat_map_vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer, parameter :: INSERTS = 100000
+  integer(c_int), parameter :: DISTINCT = 5000
+
+  type(flat_set) :: s
+  type(flat_map) :: m
+  type(tagged_key) :: entry
+  type(tagged_key), dimension(:), pointer :: entries
+  type(tagged_key), dimension(4) :: batch
+  integer(c_int), pointer :: int_pointer
+  integer(c_int), dimension(5) :: keys, values
+  integer(c_int) :: key, value
+  integer :: i
+
+
+  !* Every key comes up many times, out of order. The tag says which insert it was.
+  s = new_flat_set(int(c_sizeof(entry), c_size_t), compare_tagged_keys, 0_8, counting_key_gc)
+
+  do i = 1, INSERTS
+    entry = tagged_key(mod(i * 7919, DISTINCT), i)
+    call s%insert(entry)
+
+    !* A lookup partway through merges what's pending, so later inserts merge into sorted keys.
+    if (mod(i, 30000) == 0) then
+      if (.not. s%contains(entry)) then
+        error stop "[Test] A key went missing in the middle."
+      end if
+    end if
+  end do
+
+  if (s%size() /= DISTINCT) then
+    error stop "[Test] The set kept duplicates."
+  end if
+
+  !* One GC per dropped duplicate.
+  if (key_gc_count /= INSERTS - DISTINCT) then
+    error stop "[Test] The set didn't GC every duplicate."
+  end if
+
+  !* Sorted, and each key is the last one inserted. 7919 and 5000 are coprime,
+  !* so key k was last inserted at the largest i with mod(i * 7919, 5000) == k.
+  call c_f_pointer(s%data_ptr(), entries, [s%size()])
+
+  do i = 1, DISTINCT
+    if (entries(i)%key /= i - 1) then
+      error stop "[Test] The set isn't sorted."
+    end if
+
+    if (entries(i)%tag <= INSERTS - DISTINCT .or. mod(entries(i)%tag * 7919, DISTINCT) /= i - 1) then
+      error stop "[Test] The set didn't keep the newest duplicate."
+    end if
+  end do
+
+
+  !* Removing GCs the key, and lower_bound lands on the one after it.
+  key_gc_count = 0
+  entry = tagged_key(2500, 0)
+  call s%remove(entry)
+
+  if (s%contains(entry) .or. key_gc_count /= 1) then
+    error stop "[Test] remove() went wrong."
+  end if
+
+  if (s%lower_bound(entry) /= 2501 .or. s%find(entry) /= 0) then
+    error stop "[Test] lower_bound() or find() went wrong after a remove."
+  end if
+
+  !* A batch with duplicates of its own, and of keys already in the set.
+  batch = [tagged_key(9000, 1), tagged_key(1, -1), tagged_key(9000, 2), tagged_key(-5, 0)]
+  call s%insert_array(batch)
+
+  if (s%size() /= DISTINCT + 1) then
+    error stop "[Test] insert_array() kept a duplicate."
+  end if
+
+  call c_f_pointer(s%get(1_8), entries, [1])
+  if (entries(1)%key /= -5) then
+    error stop "[Test] insert_array() didn't sort."
+  end if
+
+  call c_f_pointer(s%get(int(s%size(), c_size_t)), entries, [1])
+  if (entries(1)%key /= 9000 .or. entries(1)%tag /= 2) then
+    error stop "[Test] insert_array() didn't keep the newest in the batch."
+  end if
+
+  call c_f_pointer(s%get(3_8), entries, [1])
+  if (entries(1)%key /= 1 .or. entries(1)%tag /= -1) then
+    error stop "[Test] insert_array() didn't replace a key that was already there."
+  end if
+
+  call s%destroy()
+
+
+  !* The map keeps the newest value for each key, and both GCs run on what's dropped.
+  key_gc_count = 0
+  value_gc_count = 0
+  m = new_flat_map(int(c_sizeof(key), c_size_t), int(c_sizeof(value), c_size_t), compare_ints, 0_8, &
+    counting_key_gc, counting_value_gc)
+
+  do i = 1, INSERTS
+    key = mod(i, 1000)
+    value = i
+    call m%insert(key, value)
+  end do
+
+  if (m%size() /= 1000) then
+    error stop "[Test] The map kept duplicate keys."
+  end if
+
+  if (key_gc_count /= INSERTS - 1000 .or. value_gc_count /= INSERTS - 1000) then
+    error stop "[Test] The map didn't GC every duplicate."
+  end if
+
+  do key = 0, 999
+    call c_f_pointer(m%get(key), int_pointer)
+
+    if (int_pointer /= INSERTS - 1000 + key .and. .not. (key == 0 .and. int_pointer == INSERTS)) then
+      error stop "[Test] The map didn't keep the newest value."
+    end if
+  end do
+
+  key = 123456
+  if (c_associated(m%get(key)) .or. m%contains(key)) then
+    error stop "[Test] The map found a key that isn't there."
+  end if
+
+  !* The values stay lined up with their keys through the merge.
+  keys = [7, 7, 2000, 3000, 2000]
+  values = [1, 2, 3, 4, 5]
+  call m%insert_array(keys, values)
+
+  if (m%size() /= 1002) then
+    error stop "[Test] insert_array() kept a duplicate key."
+  end if
+
+  key = 7
+  call c_f_pointer(m%get(key), int_pointer)
+  if (int_pointer /= 2) then
+    error stop "[Test] insert_array() didn't keep the newest value."
+  end if
+
+  key = 2000
+  call c_f_pointer(m%value_at(m%find(key)), int_pointer)
+  if (int_pointer /= 5) then
+    error stop "[Test] value_at() isn't lined up with its key."
+  end if
+
+  call c_f_pointer(m%key_at(1002_8), int_pointer)
+  if (int_pointer /= 3000) then
+    error stop "[Test] key_at() isn't sorted."
+  end if
+
+  !* Removing GCs both halves of the entry.
+  key_gc_count = 0
+  value_gc_count = 0
+  call m%remove(key)
+
+  if (m%size() /= 1001 .or. m%contains(key) .or. key_gc_count /= 1 .or. value_gc_count /= 1) then
+    error stop "[Test] remove() went wrong."
+  end if
+
+  !* Pending entries get cleared too.
+  call m%insert(key, value)
+  call m%clear()
+  if (.not. m%is_empty()) then
+    error stop "[Test] clear() left entries behind."
+  end if
+
+  call m%destroy()
+
+  print*,"flat_set and flat_map: OK"
+
+end program test_flat_set_and_map
@@ -0,0 +1,214 @@
+module parallel_test_kernels
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+contains
+
+  !* Multiply a span in place, by the factor user_data points at.
+  subroutine scale_span(base_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int64_t), dimension(:), pointer :: elements
+    integer(c_int64_t), pointer :: factor
+
+    call c_f_pointer(base_pointer, elements, [count])
+    call c_f_pointer(user_data, factor)
+
+    elements = elements * factor
+  end subroutine scale_span
+
+
+  !* Integers in, halved doubles out. The output is a different type on purpose.
+  subroutine halve_span(input_pointer, output_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: input_pointer, output_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int64_t), dimension(:), pointer :: input
+    real(c_double), dimension(:), pointer :: output
+
+    call c_f_pointer(input_pointer, input, [count])
+    call c_f_pointer(output_pointer, output, [count])
+
+    output = real(input, c_double) / 2.0_c_double
+  end subroutine halve_span
+
+
+  !* Sum a span of integers into its accumulator.
+  subroutine sum_span(base_pointer, count, accumulator_pointer, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer, accumulator_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int64_t), dimension(:), pointer :: elements
+    integer(c_int64_t), pointer :: accumulator
+
+    call c_f_pointer(base_pointer, elements, [count])
+    call c_f_pointer(accumulator_pointer, accumulator)
+
+    accumulator = accumulator + sum(elements)
+  end subroutine sum_span
+
+
+  subroutine combine_sums(accumulator_pointer, partial_pointer, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: accumulator_pointer, partial_pointer
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int64_t), pointer :: accumulator, partial
+
+    call c_f_pointer(accumulator_pointer, accumulator)
+    call c_f_pointer(partial_pointer, partial)
+
+    accumulator = accumulator + partial
+  end subroutine combine_sums
+
+
+  !* Sum a span of doubles one at a time, so the rounding depends on the order.
+  subroutine sum_real_span(base_pointer, count, accumulator_pointer, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer, accumulator_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    real(c_double), dimension(:), pointer :: elements
+    real(c_double), pointer :: accumulator
+    integer(c_size_t) :: i
+
+    call c_f_pointer(base_pointer, elements, [count])
+    call c_f_pointer(accumulator_pointer, accumulator)
+
+    do i = 1, count
+      accumulator = accumulator + elements(i)
+    end do
+  end subroutine sum_real_span
+
+
+  subroutine combine_real_sums(accumulator_pointer, partial_pointer, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: accumulator_pointer, partial_pointer
+    type(c_ptr), intent(in), value :: user_data
+    real(c_double), pointer :: accumulator, partial
+
+    call c_f_pointer(accumulator_pointer, accumulator)
+    call c_f_pointer(partial_pointer, partial)
+
+    accumulator = accumulator + partial
+  end subroutine combine_real_sums
+
+end module parallel_test_kernels
+
+
+!* parallel_for_each, parallel_transform, and parallel_reduce, over a few pool sizes and chunk sizes.
+program test_parallel
+  use :: parallel_test_kernels
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 100003
+  integer(c_size_t), dimension(3), parameter :: POOL_SIZES = [1_c_size_t, 3_c_size_t, 8_c_size_t]
+  integer(c_size_t), dimension(3), parameter :: CHUNK_SIZES = [0_c_size_t, 7_c_size_t, 1000_c_size_t]
+
+  type(vec) :: v, output, reals
+  integer(c_int64_t), target :: factor
+  integer(c_int64_t) :: i, total
+  integer(c_int64_t), pointer :: int_pointer
+  real(c_double), pointer :: real_pointer
+  real(c_double) :: real_total, first_real_total
+  integer :: p, c
+
+
+  do p = 1, size(POOL_SIZES)
+    call vec_set_parallel_threads(POOL_SIZES(p))
+
+    do c = 1, size(CHUNK_SIZES)
+      !* COUNT isn't a multiple of any chunk size, so the last span is always short.
+      v = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+      do i = 1, COUNT
+        call v%push_back(i)
+      end do
+
+      !* Every element gets touched exactly once.
+      factor = 3
+      call v%parallel_for_each(scale_span, CHUNK_SIZES(c), c_loc(factor))
+
+      do i = 1, COUNT
+        call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+        if (int_pointer /= i * 3) then
+          error stop "[Test] parallel_for_each missed an element, or did one twice."
+        end if
+      end do
+
+      !* The output is cleared, sized to match, and filled in.
+      output = new_vec(int(c_sizeof(real_total), c_size_t), 0_8)
+      call output%push_back(-1.0_c_double)
+      call v%parallel_transform(halve_span, output, CHUNK_SIZES(c))
+
+      if (output%size() /= COUNT) then
+        error stop "[Test] parallel_transform made the wrong size."
+      end if
+
+      do i = 1, COUNT
+        call c_f_pointer(output%get(int(i, c_size_t)), real_pointer)
+        if (real_pointer /= real(i * 3, c_double) / 2.0_c_double) then
+          error stop "[Test] parallel_transform wrote the wrong value."
+        end if
+      end do
+
+      !* The reduce gets the exact sum.
+      total = -1
+      call v%parallel_reduce(sum_span, combine_sums, 0_c_int64_t, total, CHUNK_SIZES(c))
+
+      if (total /= 3 * ((COUNT * (COUNT + 1)) / 2)) then
+        error stop "[Test] parallel_reduce got the wrong sum."
+      end if
+
+      call output%destroy()
+      call v%destroy()
+    end do
+  end do
+
+
+  !* With a fixed chunk size, a floating point reduce gives the same bits on any number of threads.
+  reals = new_vec(int(c_sizeof(real_total), c_size_t), 0_8)
+  do i = 1, COUNT
+    call reals%push_back(1.0_c_double / real(i, c_double))
+  end do
+
+  do p = 1, size(POOL_SIZES)
+    call vec_set_parallel_threads(POOL_SIZES(p))
+
+    real_total = 0.0_c_double
+    call reals%parallel_reduce(sum_real_span, combine_real_sums, 0.0_c_double, real_total, 1000_8)
+
+    if (p == 1) then
+      first_real_total = real_total
+    else if (real_total /= first_real_total) then
+      error stop "[Test] parallel_reduce changed with the number of threads."
+    end if
+  end do
+
+  call reals%destroy()
+
+
+  !* Reducing nothing gives back init.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+  total = 12345
+  call v%parallel_reduce(sum_span, combine_sums, 7_c_int64_t, total)
+  if (total /= 7) then
+    error stop "[Test] parallel_reduce over nothing should give init."
+  end if
+  call v%destroy()
+
+  call vec_set_parallel_threads(0_8)
+
+  print*,"parallel: OK"
+
+end program test_parallel
@@ -0,0 +1,136 @@
+module sharded_test_workers
+  use, intrinsic :: iso_c_binding
+  use :: sharded_vector
+  implicit none
+
+  integer, parameter :: THREADS = 4
+  integer, parameter :: PUSHES_PER_THREAD = 5000
+
+  !* Each thread pushes into its own shard of this one.
+  type(sharded_vec) :: shared
+
+  !* How many elements the GC has seen.
+  integer :: gc_count = 0
+
+contains
+
+  !* This type doesn't own anything, we're only counting.
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_count = gc_count + 1
+  end subroutine counting_gc
+
+
+  !* Each thread runs this with a span of one element, its thread number, which is also its shard.
+  subroutine pusher(base_pointer, count, user_data) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count
+    type(c_ptr), intent(in), value :: user_data
+    integer(c_int), pointer :: thread
+    integer(c_int) :: i
+
+    call c_f_pointer(base_pointer, thread)
+
+    do i = 1, PUSHES_PER_THREAD - 2
+      call shared%push_back(thread, (thread * 100000) + i)
+    end do
+
+    call shared%push_back_array(thread, [(thread * 100000) + PUSHES_PER_THREAD - 1, (thread * 100000) + PUSHES_PER_THREAD])
+  end subroutine pusher
+
+end module sharded_test_workers
+
+
+!* sharded_vec: one shard per thread, gathered into a single vec by flatten().
+program test_sharded_vec
+  use :: sharded_test_workers
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  type(vec) :: threads_driver, flat
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: thread, i
+  integer(c_size_t) :: index
+
+
+  shared = new_sharded_vec(int(c_sizeof(thread), c_size_t), THREADS, 0_8, counting_gc)
+
+  call vec_set_parallel_threads(int(THREADS, c_size_t))
+  threads_driver = new_vec(int(c_sizeof(thread), c_size_t), 0_8)
+  do thread = 1, THREADS
+    call threads_driver%push_back(thread)
+  end do
+
+  call threads_driver%parallel_for_each(pusher, 1_8)
+
+
+  !* Every shard has exactly what its thread pushed.
+  do thread = 1, THREADS
+    if (shared%shard_size(thread) /= PUSHES_PER_THREAD) then
+      error stop "[Test] A shard has the wrong size."
+    end if
+  end do
+
+  if (shared%size() /= THREADS * PUSHES_PER_THREAD) then
+    error stop "[Test] The total size is wrong."
+  end if
+
+
+  !* flatten() lays the shards out one after another, each in the order it was pushed.
+  flat = shared%flatten()
+
+  if (flat%size() /= THREADS * PUSHES_PER_THREAD) then
+    error stop "[Test] flatten() lost elements."
+  end if
+
+  !* It only allocated once.
+  if (flat%capacity() /= flat%size()) then
+    error stop "[Test] flatten() grew more than it had to."
+  end if
+
+  index = 0
+  do thread = 1, THREADS
+    do i = 1, PUSHES_PER_THREAD
+      index = index + 1
+      call c_f_pointer(flat%get(index), int_pointer)
+
+      if (int_pointer /= (thread * 100000) + i) then
+        error stop "[Test] flatten() put something in the wrong place."
+      end if
+    end do
+  end do
+
+
+  !* The elements were moved, so the shards are empty, and nothing was GC'd.
+  if (shared%size() /= 0) then
+    error stop "[Test] flatten() left elements in the shards."
+  end if
+
+  if (gc_count /= 0) then
+    error stop "[Test] flatten() ran the GC."
+  end if
+
+  !* Destroying the shards doesn't touch what moved out.
+  call shared%destroy()
+  if (gc_count /= 0) then
+    error stop "[Test] The shards GC'd elements they gave away."
+  end if
+
+  !* The flat vector took the GC with it.
+  call flat%destroy()
+  if (gc_count /= THREADS * PUSHES_PER_THREAD) then
+    error stop "[Test] The flat vector didn't GC its elements."
+  end if
+
+  call threads_driver%destroy()
+  call vec_set_parallel_threads(0_8)
+
+  print*,"sharded_vec: OK"
+
+end program test_sharded_vec
@@ -0,0 +1,129 @@
+module slot_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* How many elements the GC has seen.
+  integer :: gc_count = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_count = gc_count + 1
+  end subroutine counting_gc
+
+end module slot_test_module
+
+
+!* slot_vec: handles that stay good across removes, and go stale when their element does.
+program test_slot_vec
+  use :: slot_test_module
+  use :: slot_vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer, parameter :: COUNT = 1000
+
+  type(slot_vec) :: s
+  type(slot_handle), dimension(COUNT) :: handles, stale
+  type(slot_handle) :: handle, never_made
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+  integer(c_size_t) :: index
+  integer :: removed
+
+
+  s = new_slot_vec(int(c_sizeof(i), c_size_t), 0_8, counting_gc)
+
+  do i = 1, COUNT
+    handles(i) = s%insert(i)
+  end do
+
+  !* Remove every third one. Each remove moves the last element into the hole.
+  removed = 0
+  do i = 3, COUNT, 3
+    call s%remove(handles(i))
+    removed = removed + 1
+  end do
+
+  if (s%size() /= COUNT - removed) then
+    error stop "[Test] Wrong size after removing."
+  end if
+
+  if (gc_count /= removed) then
+    error stop "[Test] The GC didn't run once per remove."
+  end if
+
+
+  !* The removed handles are stale, and the rest still find their element, wherever it moved to.
+  do i = 1, COUNT
+    if (mod(i, 3) == 0) then
+      if (s%contains(handles(i)) .or. c_associated(s%get(handles(i)))) then
+        error stop "[Test] A removed handle still works."
+      end if
+    else
+      call c_f_pointer(s%get(handles(i)), int_pointer)
+
+      if (int_pointer /= i) then
+        error stop "[Test] A live handle found the wrong element."
+      end if
+    end if
+  end do
+
+
+  !* Inserting again reuses the free slots, with a new generation.
+  !* The old handles to those slots must stay stale, even though the slot is live again.
+  stale = handles
+  do i = 3, COUNT, 3
+    handles(i) = s%insert(-i)
+  end do
+
+  do i = 3, COUNT, 3
+    if (handles(i)%slot > int(COUNT, c_int64_t)) then
+      error stop "[Test] Insert didn't reuse a free slot."
+    end if
+
+    if (s%contains(stale(i)) .or. c_associated(s%get(stale(i)))) then
+      error stop "[Test] An old handle works on its reused slot."
+    end if
+
+    call c_f_pointer(s%get(handles(i)), int_pointer)
+    if (int_pointer /= -i) then
+      error stop "[Test] A new handle found the wrong element."
+    end if
+  end do
+
+  if (s%size() /= COUNT) then
+    error stop "[Test] Wrong size after inserting again."
+  end if
+
+
+  !* Walking the dense elements, every handle_at leads back to the same element.
+  do index = 1, s%size()
+    handle = s%handle_at(index)
+
+    if (.not. c_associated(s%get(handle), s%get_dense(index))) then
+      error stop "[Test] handle_at doesn't match the dense element."
+    end if
+  end do
+
+
+  !* A handle that was never made doesn't work either.
+  if (s%contains(never_made)) then
+    error stop "[Test] An empty handle works."
+  end if
+
+
+  !* Destroying runs the GC on everything left.
+  gc_count = 0
+  call s%destroy()
+  if (gc_count /= COUNT) then
+    error stop "[Test] destroy() didn't GC every element."
+  end if
+
+  print*,"slot_vec: OK"
+
+end program test_slot_vec
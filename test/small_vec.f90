@@ -0,0 +1,147 @@
+module small_vec_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* What the GC has seen.
+  integer :: gc_count = 0
+  integer(c_int64_t) :: gc_value_sum = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_int64_t), pointer :: int_pointer
+
+    call c_f_pointer(raw_c_pointer, int_pointer)
+
+    gc_count = gc_count + 1
+    gc_value_sum = gc_value_sum + int_pointer
+  end subroutine counting_gc
+
+end module small_vec_test_module
+
+
+!* small_vec: staying inline, spilling at inline_capacity, and new_vec honouring its initial size.
+program test_small_vec
+  use :: small_vec_test_module
+  use :: small_vector
+  use :: vector
+  use :: vector_config
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 100
+
+  type(small_vec), target :: s
+  type(vec) :: v
+  integer(c_int64_t), pointer :: int_pointer
+  integer(c_size_t) :: inline_capacity
+  integer(c_int64_t) :: i
+
+
+  s = new_small_vec(int(c_sizeof(i), c_size_t), counting_gc)
+  inline_capacity = SMALL_VEC_INLINE_BYTES / c_sizeof(i)
+
+  if (.not. s%is_inline() .or. s%capacity() /= inline_capacity) then
+    error stop "[Test] A new small_vec isn't inline."
+  end if
+
+
+  !* Filling the inline buffer right up doesn't spill.
+  do i = 1, inline_capacity
+    call s%push_back(i)
+  end do
+
+  if (.not. s%is_inline() .or. s%size() /= inline_capacity) then
+    error stop "[Test] small_vec spilled before it was full."
+  end if
+
+  !* Removing in the middle while inline shifts the rest down, and GCs just that one.
+  call s%remove(2_c_size_t)
+
+  if (s%size() /= inline_capacity - 1 .or. gc_count /= 1 .or. gc_value_sum /= 2) then
+    error stop "[Test] remove() while inline went wrong."
+  end if
+
+  do i = 2, inline_capacity - 1
+    call c_f_pointer(s%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i + 1) then
+      error stop "[Test] remove() while inline didn't close the gap."
+    end if
+  end do
+
+  !* Fill the gap back up, still inline.
+  call s%push_back(inline_capacity)
+  gc_count = 0
+  gc_value_sum = 0
+
+  if (.not. s%is_inline()) then
+    error stop "[Test] small_vec spilled refilling the gap."
+  end if
+
+
+  !* One more spills, and everything comes along.
+  call s%push_back(inline_capacity + 1)
+
+  if (s%is_inline() .or. s%size() /= inline_capacity + 1 .or. s%capacity() < inline_capacity + 1) then
+    error stop "[Test] small_vec didn't spill when it outgrew the inline buffer."
+  end if
+
+  if (gc_count /= 0) then
+    error stop "[Test] Spilling ran the GC."
+  end if
+
+  do i = inline_capacity + 2, COUNT
+    call s%push_back(i)
+  end do
+
+  !* 1, then 3 up to inline_capacity and inline_capacity again from before the spill, then the rest in order.
+  call c_f_pointer(s%get(1_c_size_t), int_pointer)
+  if (int_pointer /= 1) then
+    error stop "[Test] Spilling lost the first element."
+  end if
+
+  do i = 2, COUNT
+    call c_f_pointer(s%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= merge(i + 1, i, i < inline_capacity)) then
+      error stop "[Test] small_vec lost an element across the spill."
+    end if
+  end do
+
+
+  !* Removing while spilled goes through the C vector, and GCs just that one.
+  call s%remove(int(inline_capacity + 1, c_size_t))
+
+  if (s%size() /= COUNT - 1 .or. gc_count /= 1 .or. gc_value_sum /= inline_capacity + 1) then
+    error stop "[Test] remove() while spilled went wrong."
+  end if
+
+  call c_f_pointer(s%get(int(inline_capacity + 1, c_size_t)), int_pointer)
+  if (int_pointer /= inline_capacity + 2) then
+    error stop "[Test] remove() while spilled didn't close the gap."
+  end if
+
+  !* It stays spilled once it's spilled, even when it's small again.
+  call s%clear()
+
+  if (s%is_inline() .or. .not. s%is_empty() .or. gc_count /= COUNT) then
+    error stop "[Test] clear() after spilling went wrong."
+  end if
+
+  call s%destroy()
+
+
+  !* new_vec gives you at least the room you asked for, straight away.
+  v = new_vec(int(c_sizeof(i), c_size_t), 1000_c_size_t)
+
+  if (v%capacity() < 1000 .or. .not. v%is_empty()) then
+    error stop "[Test] new_vec didn't reserve its initial size."
+  end if
+
+  call v%destroy()
+
+  print*,"small_vec: OK"
+
+end program test_small_vec
@@ -0,0 +1,167 @@
+module soa_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* A hot field, a small field, and a cold one, with padding between them.
+  type, bind(c) :: particle
+    real(c_double) :: x
+    integer(c_int32_t) :: id
+    real(c_double), dimension(3) :: cold
+  end type particle
+
+  !* How many records the GC has seen, and the sum of their ids.
+  integer :: gc_count = 0
+  integer :: gc_id_sum = 0
+
+contains
+
+  !* The GC gets a record gathered back together, so every field is there.
+  subroutine particle_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    type(particle), pointer :: p
+
+    call c_f_pointer(raw_c_pointer, p)
+
+    if (p%cold(1) /= real(p%id, c_double)) then
+      error stop "[Test] The GC got a record that wasn't gathered right."
+    end if
+
+    gc_count = gc_count + 1
+    gc_id_sum = gc_id_sum + p%id
+  end subroutine particle_gc
+
+
+  function make_particle(i) result(p)
+    implicit none
+
+    integer(c_int32_t), intent(in), value :: i
+    type(particle) :: p
+
+    p%x = i * 0.5_c_double
+    p%id = i
+    p%cold = [1.0_c_double * i, 2.0_c_double * i, 3.0_c_double * i]
+  end function make_particle
+
+end module soa_test_module
+
+
+!* soa_vec: whole records in and out, each field in its own contiguous array.
+program test_soa_vec
+  use :: soa_test_module
+  use :: soa_vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int32_t), parameter :: COUNT = 1000
+
+  type(soa_vec) :: v
+  type(particle), target :: p, q
+  real(c_double), dimension(:), pointer :: xs, x_data
+  integer(c_int32_t), dimension(:), pointer :: ids
+  integer(c_int32_t), pointer :: id_pointer
+  integer(c_size_t), dimension(3) :: offsets, sizes
+  integer(c_intptr_t) :: base
+  integer(c_int32_t) :: i
+
+
+  base = transfer(c_loc(p), 0_c_intptr_t)
+  offsets = [transfer(c_loc(p%x), 0_c_intptr_t) - base, transfer(c_loc(p%id), 0_c_intptr_t) - base, &
+    transfer(c_loc(p%cold), 0_c_intptr_t) - base]
+  sizes = [storage_size(p%x) / 8, storage_size(p%id) / 8, storage_size(p%cold) / 8 * 3]
+
+  !* Start small, so every field grows a few times.
+  v = new_soa_vec(int(c_sizeof(p), c_size_t), offsets, sizes, 4_8, particle_gc)
+
+  if (v%field_count() /= 3) then
+    error stop "[Test] Wrong number of fields."
+  end if
+
+  do i = 1, COUNT
+    call v%push_back(make_particle(i))
+  end do
+
+  if (v%size() /= COUNT) then
+    error stop "[Test] Wrong size after pushing."
+  end if
+
+
+  !* Each field is its own packed array, with no gaps for the other fields.
+  call v%view(1_8, xs)
+  call v%view(2_8, ids)
+
+  if (size(xs) /= COUNT .or. size(ids) /= COUNT) then
+    error stop "[Test] A view has the wrong size."
+  end if
+
+  do i = 1, COUNT
+    if (xs(i) /= i * 0.5_c_double .or. ids(i) /= i) then
+      error stop "[Test] A field didn't get scattered into the right place."
+    end if
+  end do
+
+  !* field_data_ptr points at the same packed memory, and field_ptr at one record's slot in it.
+  call c_f_pointer(v%field_data_ptr(1_8), x_data, [COUNT])
+  if (.not. all(x_data == xs)) then
+    error stop "[Test] field_data_ptr doesn't match the view."
+  end if
+
+  call c_f_pointer(v%field_ptr(2_8, 500_8), id_pointer)
+  if (id_pointer /= 500) then
+    error stop "[Test] field_ptr points at the wrong record."
+  end if
+
+
+  !* get() gathers every field back into one record.
+  call v%get(37_8, q)
+  if (q%x /= 18.5_c_double .or. q%id /= 37 .or. any(q%cold /= [37.0_c_double, 74.0_c_double, 111.0_c_double])) then
+    error stop "[Test] get() didn't gather the record right."
+  end if
+
+
+  !* set() scatters a record back out, and GCs the one it replaces.
+  q = make_particle(-37)
+  call v%set(37_8, q)
+
+  if (gc_count /= 1 .or. gc_id_sum /= 37) then
+    error stop "[Test] set() didn't GC the old record."
+  end if
+
+  call v%view(2_8, ids)
+  call v%view(1_8, xs)
+  if (ids(37) /= -37 .or. xs(37) /= -18.5_c_double .or. ids(36) /= 36 .or. ids(38) /= 38) then
+    error stop "[Test] set() scattered into the wrong place."
+  end if
+
+  call v%get(37_8, p)
+  if (any(p%cold /= q%cold)) then
+    error stop "[Test] set() lost the cold field."
+  end if
+
+
+  !* pop_back() GCs the last record, and every field shrinks with it.
+  call v%pop_back()
+
+  if (v%size() /= COUNT - 1 .or. gc_count /= 2 .or. gc_id_sum /= 37 + COUNT) then
+    error stop "[Test] pop_back() went wrong."
+  end if
+
+  call v%view(2_8, ids)
+  if (size(ids) /= COUNT - 1) then
+    error stop "[Test] pop_back() left a field behind."
+  end if
+
+
+  !* Destroying GCs everything that's left.
+  gc_count = 0
+  gc_id_sum = 0
+  call v%destroy()
+
+  if (gc_count /= COUNT - 1 .or. gc_id_sum /= ((COUNT - 1) * COUNT) / 2 - 37 - 37) then
+    error stop "[Test] destroy() didn't GC every record."
+  end if
+
+  print*,"soa_vec: OK"
+
+end program test_soa_vec
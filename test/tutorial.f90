@@ -93,6 +93,10 @@ program example
   call v%push_back(2)
   call v%push_back(3)
 
+  !* You can also push a whole array in one go.
+  !* This only reallocates once and copies it in with a single memcpy.
+  call v%push_back_array([4, 5, 6])
+
   !* Change the first element.
   call v%set(1_8, 99999)
 
@@ -190,12 +194,9 @@ program example
     call v%insert(23451_8, dat)
 
     !* Now let us delete the first 10 items.
-    !* With a list this HUGE this is very slow!
-    !* We literally have to memmove the items down, byte by byte.
-    !? In the future: I hope to optimize this so you can do it in one huge chunk.
-    do i = 1,10
-      call v%remove(1_8)
-    end do
+    !* With a list this HUGE, removing them one by one would be very slow!
+    !* Instead, we remove them as a range. The items are memmoved down in one huge chunk.
+    call v%remove_range(1_8, 10_8)
 
     do i = 1,int(v%size())
       call c_f_pointer(v%get(int(i, c_int64_t)), output)
@@ -0,0 +1,157 @@
+!* vec_i32, vec_i64, vec_r32, vec_r64, and vec_c_ptr: the typed fast paths, and what C does when they run out of room.
+program test_typed_vectors
+  use :: vector_i32
+  use :: vector_i64
+  use :: vector_r32
+  use :: vector_r64
+  use :: vector_c_ptr
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int32_t), parameter :: COUNT = 10000
+
+  type(vec_i32) :: ints, never_created
+  type(vec_i64) :: longs
+  type(vec_r32) :: floats
+  type(vec_r64) :: doubles
+  type(vec_c_ptr) :: pointers
+  integer(c_int32_t), dimension(:), pointer :: int_view
+  integer(c_int32_t), dimension(:), allocatable :: array
+  integer(c_int32_t), target :: targets(3)
+  integer(c_int32_t) :: i
+
+
+  !* Start with room for 4, so most pushes are the Fortran fast path and a few go through C to grow.
+  ints = new_vec_i32(4_c_size_t)
+
+  do i = 1, COUNT
+    call ints%push_back(i)
+  end do
+
+  if (ints%size() /= COUNT .or. ints%capacity() < COUNT) then
+    error stop "[Test] vec_i32 has the wrong size after pushing."
+  end if
+
+  do i = 1, COUNT
+    if (ints%get(int(i, c_size_t)) /= i) then
+      error stop "[Test] vec_i32 lost an element."
+    end if
+  end do
+
+  !* set() writes in place.
+  call ints%set(1_c_size_t, -1)
+  call ints%set(int(COUNT, c_size_t), -COUNT)
+  if (ints%get(1_c_size_t) /= -1 .or. ints%get(int(COUNT, c_size_t)) /= -COUNT .or. ints%get(2_c_size_t) /= 2) then
+    error stop "[Test] vec_i32 set() wrote to the wrong place."
+  end if
+
+  !* The view is the vector's memory.
+  int_view => ints%view()
+  if (size(int_view) /= COUNT .or. int_view(2) /= 2) then
+    error stop "[Test] vec_i32 view() is wrong."
+  end if
+
+  int_view(3) = 333
+  if (ints%get(3_c_size_t) /= 333) then
+    error stop "[Test] Writing through the vec_i32 view didn't reach the vector."
+  end if
+
+  if (.not. c_associated(ints%data_ptr(), c_loc(int_view(1)))) then
+    error stop "[Test] vec_i32 data_ptr() and view() disagree."
+  end if
+
+  !* An array goes on in one copy.
+  array = [(i, i = 1, 100)]
+  call ints%push_back_array(array)
+  if (ints%size() /= COUNT + 100 .or. ints%get(int(COUNT + 100, c_size_t)) /= 100) then
+    error stop "[Test] vec_i32 push_back_array() went wrong."
+  end if
+  deallocate(array)
+
+  call ints%pop_back()
+  if (ints%size() /= COUNT + 99 .or. ints%get(int(COUNT + 99, c_size_t)) /= 99) then
+    error stop "[Test] vec_i32 pop_back() went wrong."
+  end if
+
+  !* resize() fills the new slots with the default, and shrink_to_fit() trims the capacity.
+  call ints%resize(int(COUNT + 200, c_size_t), 7)
+  if (ints%size() /= COUNT + 200 .or. ints%get(int(COUNT + 100, c_size_t)) /= 7 .or. &
+    ints%get(int(COUNT + 200, c_size_t)) /= 7) then
+    error stop "[Test] vec_i32 resize() went wrong."
+  end if
+
+  call ints%shrink_to_fit()
+  if (ints%capacity() /= ints%size()) then
+    error stop "[Test] vec_i32 shrink_to_fit() didn't trim."
+  end if
+
+  call ints%clear()
+  if (.not. ints%is_empty()) then
+    error stop "[Test] vec_i32 clear() left elements."
+  end if
+
+  call ints%destroy()
+
+
+  !* A vector that was never created is just empty.
+  if (never_created%size() /= 0 .or. never_created%capacity() /= 0 .or. .not. never_created%is_empty()) then
+    error stop "[Test] A vector that was never created isn't empty."
+  end if
+
+  if (c_associated(never_created%data_ptr()) .or. size(never_created%view()) /= 0) then
+    error stop "[Test] A vector that was never created points at something."
+  end if
+
+
+  !* The other types go through the same paths at their own sizes.
+  longs = new_vec_i64(0_c_size_t)
+  floats = new_vec_r32(0_c_size_t)
+  doubles = new_vec_r64(0_c_size_t)
+
+  do i = 1, COUNT
+    call longs%push_back(int(i, c_int64_t) * 3000000000_c_int64_t)
+    call floats%push_back(real(i, c_float) * 0.5_c_float)
+    call doubles%push_back(real(i, c_double) * 0.25_c_double)
+  end do
+
+  do i = 1, COUNT
+    if (longs%get(int(i, c_size_t)) /= int(i, c_int64_t) * 3000000000_c_int64_t) then
+      error stop "[Test] vec_i64 lost an element."
+    end if
+
+    if (floats%get(int(i, c_size_t)) /= real(i, c_float) * 0.5_c_float) then
+      error stop "[Test] vec_r32 lost an element."
+    end if
+
+    if (doubles%get(int(i, c_size_t)) /= real(i, c_double) * 0.25_c_double) then
+      error stop "[Test] vec_r64 lost an element."
+    end if
+  end do
+
+  if (sum(doubles%view()) /= 0.25_c_double * ((real(COUNT, c_double) * (COUNT + 1)) / 2)) then
+    error stop "[Test] vec_r64 view() doesn't see every element."
+  end if
+
+  call longs%destroy()
+  call floats%destroy()
+  call doubles%destroy()
+
+
+  !* Pointers go in and come back the same.
+  pointers = new_vec_c_ptr(0_c_size_t)
+  do i = 1, 3
+    targets(i) = i * 10
+    call pointers%push_back(c_loc(targets(i)))
+  end do
+
+  do i = 1, 3
+    if (.not. c_associated(pointers%get(int(i, c_size_t)), c_loc(targets(i)))) then
+      error stop "[Test] vec_c_ptr gave back a different pointer."
+    end if
+  end do
+
+  call pointers%destroy()
+
+  print*,"typed vectors: OK"
+
+end program test_typed_vectors
@@ -0,0 +1,105 @@
+module alignment_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+contains
+
+  !* Check that element 1 of a vector sits on a multiple of alignment.
+  function is_aligned(address, alignment) result(aligned)
+    implicit none
+
+    type(c_ptr), intent(in), value :: address
+    integer(c_intptr_t), intent(in), value :: alignment
+    logical :: aligned
+
+    aligned = mod(transfer(address, 0_c_intptr_t), alignment) == 0
+  end function is_aligned
+
+end module alignment_test_module
+
+
+!* alignment: element 1 stays aligned through every grow and shrink, whatever the allocator hands back.
+program test_vec_alignment
+  use :: alignment_test_module
+  use :: vector
+  use :: vector_allocator
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 2000
+  integer(c_intptr_t), parameter :: ALIGNMENT = 64
+
+  type(vec_arena) :: arena
+  type(vec) :: v, other
+  integer(c_int64_t), pointer :: int_pointer
+  integer(c_int64_t) :: i
+
+
+  !* From malloc, which only promises 16.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, alignment = int(ALIGNMENT, c_size_t))
+
+  do i = 1, COUNT
+    call v%push_back(i)
+    if (.not. is_aligned(v%get(1_c_size_t), ALIGNMENT)) then
+      error stop "[Test] A grow through malloc lost the alignment."
+    end if
+  end do
+
+  call v%shrink_to_fit()
+  if (.not. is_aligned(v%get(1_c_size_t), ALIGNMENT)) then
+    error stop "[Test] shrink_to_fit() lost the alignment."
+  end if
+
+  do i = 1, COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] An aligned vector lost an element."
+    end if
+  end do
+
+  call v%destroy()
+
+
+  !* The arena only aligns to 16, and two vectors taking turns means every grow moves to
+  !* a new spot, at a different offset from 64. So the elements get slid over each time.
+  arena = new_vec_arena(4096_c_size_t)
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get(), alignment = int(ALIGNMENT, c_size_t))
+  other = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get(), &
+    alignment = int(ALIGNMENT, c_size_t))
+
+  do i = 1, COUNT
+    call v%push_back(i)
+    call other%push_back(-i)
+
+    if (.not. is_aligned(v%get(1_c_size_t), ALIGNMENT) .or. .not. is_aligned(other%get(1_c_size_t), ALIGNMENT)) then
+      error stop "[Test] A grow through the arena lost the alignment."
+    end if
+  end do
+
+  call v%shrink_to_fit()
+  call other%shrink_to_fit()
+
+  if (.not. is_aligned(v%get(1_c_size_t), ALIGNMENT) .or. .not. is_aligned(other%get(1_c_size_t), ALIGNMENT)) then
+    error stop "[Test] shrink_to_fit() through the arena lost the alignment."
+  end if
+
+  !* Sliding the elements over kept every one of them.
+  do i = 1, COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] Sliding to a new alignment lost an element."
+    end if
+
+    call c_f_pointer(other%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= -i) then
+      error stop "[Test] Sliding to a new alignment lost an element."
+    end if
+  end do
+
+  call other%destroy()
+  call v%destroy()
+  call arena%destroy()
+
+  print*,"vec_alignment: OK"
+
+end program test_vec_alignment
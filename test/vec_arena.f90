@@ -0,0 +1,137 @@
+!* vec_arena: vectors that grow and free in place at the end of the arena, and a reset that reuses it all.
+program test_vec_arena
+  use :: vector
+  use :: vector_allocator
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int), parameter :: COUNT = 1000
+
+  type(vec_arena) :: arena
+  type(vec) :: v, other
+  type(c_ptr) :: first_address
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+  integer(c_size_t) :: used_before
+
+
+  !* One chunk that's big enough for everything, so nothing spills into a second one.
+  arena = new_vec_arena(1000000_c_size_t)
+
+  if (arena%used() /= 0) then
+    error stop "[Test] A new arena has bytes in use."
+  end if
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get())
+  call v%push_back(1)
+  first_address = v%get(1_c_size_t)
+
+
+  !* v is the last thing in the arena, so every grow just bumps the end. It never moves.
+  do i = 2, COUNT
+    call v%push_back(i)
+  end do
+
+  if (.not. c_associated(first_address, v%get(1_c_size_t))) then
+    error stop "[Test] The last allocation moved when it grew."
+  end if
+
+  !* And nothing was left behind by the grows. Copying would have used about twice this.
+  if (arena%used() < v%capacity() * c_sizeof(i) .or. arena%used() > (v%capacity() * c_sizeof(i)) + 1024) then
+    error stop "[Test] Growing in place left holes in the arena."
+  end if
+
+  do i = 1, COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] Growing in the arena lost an element."
+    end if
+  end do
+
+
+  !* Freeing the last allocation gives its bytes straight back.
+  call v%destroy()
+
+  if (arena%used() /= 0) then
+    error stop "[Test] Freeing the last allocation didn't give it back."
+  end if
+
+
+  !* Only the last allocation can be given back. Anything before it waits for a reset.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get())
+  call v%push_back(1)
+  other = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get())
+  call other%push_back(2)
+
+  used_before = arena%used()
+  call v%destroy()
+
+  if (arena%used() /= used_before) then
+    error stop "[Test] Freeing an allocation in the middle gave bytes back."
+  end if
+
+  call other%destroy()
+
+  if (arena%used() >= used_before) then
+    error stop "[Test] Freeing the last allocation didn't give it back."
+  end if
+
+
+  !* reset() releases the lot, and the next vector starts right back where the first one did.
+  call arena%reset()
+
+  if (arena%used() /= 0) then
+    error stop "[Test] reset() left bytes in use."
+  end if
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get())
+  call v%push_back(7)
+
+  if (.not. c_associated(first_address, v%get(1_c_size_t))) then
+    error stop "[Test] reset() didn't reuse the arena's memory."
+  end if
+
+  call c_f_pointer(v%get(1_c_size_t), int_pointer)
+  if (int_pointer /= 7) then
+    error stop "[Test] A vector after reset() has the wrong element."
+  end if
+
+  call v%destroy()
+
+
+  !* With small chunks, vectors spill into new ones. They still work, and reset() still clears it.
+  call arena%destroy()
+  arena = new_vec_arena(256_c_size_t)
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get())
+  other = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = arena%get())
+
+  do i = 1, COUNT
+    call v%push_back(i)
+    call other%push_back(-i)
+  end do
+
+  do i = 1, COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] A vector spilling across chunks lost an element."
+    end if
+
+    call c_f_pointer(other%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= -i) then
+      error stop "[Test] A vector spilling across chunks lost an element."
+    end if
+  end do
+
+  call arena%reset()
+
+  if (arena%used() /= 0) then
+    error stop "[Test] reset() left bytes in use."
+  end if
+
+  !* Destroying the arena frees every chunk. The vectors in it are gone too.
+  call arena%destroy()
+
+  print*,"vec_arena: OK"
+
+end program test_vec_arena
@@ -0,0 +1,153 @@
+module emplace_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  type, bind(c) :: point
+    real(c_double) :: x = 0
+    real(c_double) :: y = 0
+    integer(c_int64_t) :: id = 0
+  end type point
+
+  !* The ids the GC has seen, added up.
+  integer :: gc_count = 0
+  integer(c_int64_t) :: gc_id_sum = 0
+
+contains
+
+  subroutine point_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    type(point), pointer :: p
+
+    call c_f_pointer(raw_c_pointer, p)
+
+    gc_count = gc_count + 1
+    gc_id_sum = gc_id_sum + p%id
+  end subroutine point_gc
+
+end module emplace_test_module
+
+
+!* emplace_back and emplace_n: building elements right in the vector, on vec and on the typed vectors.
+program test_vec_emplace
+  use :: emplace_test_module
+  use :: vector
+  use :: vector_r64
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: FIRST = 5
+  integer(c_int64_t), parameter :: COUNT = 1000
+
+  type(vec) :: v
+  type(vec_r64) :: doubles
+  type(point), pointer :: p
+  type(point), dimension(:), pointer :: points
+  real(c_double), dimension(:), pointer :: slots
+  type(c_ptr) :: slot
+  integer(c_int64_t) :: i
+
+
+  v = new_vec(int(c_sizeof(point()), c_size_t), 0_c_size_t, point_gc)
+
+
+  !* emplace_back gives you the new last slot, and the element is whatever you write there.
+  do i = 1, FIRST
+    slot = v%emplace_back()
+
+    if (v%size() /= i .or. .not. c_associated(slot, v%get(int(i, c_size_t)))) then
+      error stop "[Test] emplace_back() didn't give back the new last slot."
+    end if
+
+    call c_f_pointer(slot, p)
+    p%x = real(i, c_double)
+    p%y = -real(i, c_double)
+    p%id = i
+  end do
+
+  do i = 1, FIRST
+    call c_f_pointer(v%get(int(i, c_size_t)), p)
+    if (p%x /= real(i, c_double) .or. p%y /= -real(i, c_double) .or. p%id /= i) then
+      error stop "[Test] An emplaced element didn't keep what was written into it."
+    end if
+  end do
+
+
+  !* emplace_n makes room for all of them at once, contiguous, right after the ones already there.
+  call c_f_pointer(v%emplace_n(int(COUNT, c_size_t)), points, [COUNT])
+
+  if (v%size() /= FIRST + COUNT .or. v%capacity() < FIRST + COUNT) then
+    error stop "[Test] emplace_n() made the wrong amount of room."
+  end if
+
+  if (.not. c_associated(c_loc(points(1)), v%get(int(FIRST + 1, c_size_t))) .or. &
+    .not. c_associated(c_loc(points(COUNT)), v%get(int(FIRST + COUNT, c_size_t)))) then
+    error stop "[Test] emplace_n() didn't give back the new slots."
+  end if
+
+  do i = 1, COUNT
+    points(i)%x = 0.5_c_double * i
+    points(i)%y = 0
+    points(i)%id = FIRST + i
+  end do
+
+  !* The old ones came along if it moved.
+  call c_f_pointer(v%get(int(FIRST, c_size_t)), p)
+  if (p%id /= FIRST) then
+    error stop "[Test] emplace_n() lost an element that was already there."
+  end if
+
+  call c_f_pointer(v%get(int(FIRST + COUNT, c_size_t)), p)
+  if (p%x /= 0.5_c_double * COUNT .or. p%id /= FIRST + COUNT) then
+    error stop "[Test] An element placed by emplace_n() didn't keep what was written into it."
+  end if
+
+  !* Asking for nothing gets you nothing.
+  if (c_associated(v%emplace_n(0_c_size_t)) .or. v%size() /= FIRST + COUNT) then
+    error stop "[Test] emplace_n(0) added something."
+  end if
+
+  !* Emplacing doesn't run the GC, but everything emplaced gets GC'd like anything else.
+  if (gc_count /= 0) then
+    error stop "[Test] Emplacing ran the GC."
+  end if
+
+  call v%clear()
+
+  if (gc_count /= FIRST + COUNT .or. gc_id_sum /= ((FIRST + COUNT) * (FIRST + COUNT + 1)) / 2) then
+    error stop "[Test] The GC didn't see every emplaced element."
+  end if
+
+  call v%destroy()
+
+
+  !* The typed emplace_n hands back a Fortran array over the new slots.
+  doubles = new_vec_r64(0_c_size_t)
+  call doubles%push_back(-1.0_c_double)
+
+  slots => doubles%emplace_n(int(COUNT, c_size_t))
+
+  if (size(slots) /= COUNT .or. doubles%size() /= COUNT + 1) then
+    error stop "[Test] vec_r64 emplace_n() made the wrong amount of room."
+  end if
+
+  do i = 1, COUNT
+    slots(i) = real(i, c_double)
+  end do
+
+  if (doubles%get(1_c_size_t) /= -1.0_c_double .or. doubles%get(2_c_size_t) /= 1.0_c_double .or. &
+    doubles%get(int(COUNT + 1, c_size_t)) /= real(COUNT, c_double)) then
+    error stop "[Test] vec_r64 emplace_n() slots aren't the vector's memory."
+  end if
+
+  slots => doubles%emplace_n(0_c_size_t)
+  if (size(slots) /= 0 .or. doubles%size() /= COUNT + 1) then
+    error stop "[Test] vec_r64 emplace_n(0) added something."
+  end if
+
+  call doubles%destroy()
+
+  print*,"vec_emplace: OK"
+
+end program test_vec_emplace
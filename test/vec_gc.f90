@@ -0,0 +1,164 @@
+module gc_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* What the element GC has seen.
+  integer :: gc_count = 0
+  integer(c_int) :: gc_value_sum = 0
+
+  !* What the range GC was last called with, and how many times.
+  integer :: range_calls = 0
+  type(c_ptr) :: range_base = c_null_ptr
+  integer(c_size_t) :: range_count = 0
+  integer(c_size_t) :: range_element_size = 0
+  integer(c_int) :: range_value_sum = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_int), pointer :: int_pointer
+
+    call c_f_pointer(raw_c_pointer, int_pointer)
+
+    gc_count = gc_count + 1
+    gc_value_sum = gc_value_sum + int_pointer
+  end subroutine counting_gc
+
+
+  subroutine recording_range_gc(base_pointer, count, element_size)
+    implicit none
+
+    type(c_ptr), intent(in), value :: base_pointer
+    integer(c_size_t), intent(in), value :: count, element_size
+    integer(c_int), dimension(:), pointer :: elements
+
+    call c_f_pointer(base_pointer, elements, [count])
+
+    range_calls = range_calls + 1
+    range_base = base_pointer
+    range_count = count
+    range_element_size = element_size
+    range_value_sum = sum(elements)
+  end subroutine recording_range_gc
+
+
+  subroutine reset_range_gc()
+    implicit none
+
+    range_calls = 0
+    range_base = c_null_ptr
+    range_count = 0
+    range_element_size = 0
+    range_value_sum = 0
+  end subroutine reset_range_gc
+
+end module gc_test_module
+
+
+!* set() GCs only the slot it overwrites, and a range GC gets the whole range in one call.
+program test_vec_gc
+  use :: gc_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int), parameter :: COUNT = 100
+
+  type(vec) :: v
+  type(c_ptr) :: expected_base
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, counting_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* Overwriting one element GCs that element, and nothing after it.
+  call v%set(10_c_size_t, -10)
+
+  if (gc_count /= 1 .or. gc_value_sum /= 10) then
+    error stop "[Test] set() didn't GC just the slot it overwrote."
+  end if
+
+  !* The first and the last too.
+  call v%set(1_c_size_t, -1)
+  call v%set(int(COUNT, c_size_t), -COUNT)
+
+  if (gc_count /= 3 .or. gc_value_sum /= 10 + 1 + COUNT) then
+    error stop "[Test] set() on the first or last slot GC'd the wrong elements."
+  end if
+
+  call c_f_pointer(v%get(11_c_size_t), int_pointer)
+  if (int_pointer /= 11) then
+    error stop "[Test] set() touched the next element."
+  end if
+
+  call v%destroy()
+
+
+  !* A range GC gets a base pointer, a count, and the element size, once per operation.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, optional_gc_range_func = recording_range_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+  expected_base = v%get(10_c_size_t)
+  call v%set(10_c_size_t, -10)
+
+  if (range_calls /= 1 .or. .not. c_associated(range_base, expected_base) .or. range_count /= 1 .or. &
+    range_element_size /= c_sizeof(i) .or. range_value_sum /= 10) then
+    error stop "[Test] set() called the range GC with the wrong range."
+  end if
+
+  !* remove_range hands over exactly the removed elements.
+  call reset_range_gc()
+  expected_base = v%get(21_c_size_t)
+  call v%remove_range(21_c_size_t, 30_c_size_t)
+
+  if (range_calls /= 1 .or. .not. c_associated(range_base, expected_base) .or. range_count /= 10 .or. &
+    range_element_size /= c_sizeof(i) .or. range_value_sum /= sum([(i, i = 21, 30)])) then
+    error stop "[Test] remove_range() called the range GC with the wrong range."
+  end if
+
+  !* clear() hands over everything, in one call.
+  call reset_range_gc()
+  expected_base = v%get(1_c_size_t)
+  call v%clear()
+
+  if (range_calls /= 1 .or. .not. c_associated(range_base, expected_base) .or. range_count /= COUNT - 10 .or. &
+    range_element_size /= c_sizeof(i) .or. range_value_sum /= sum([(i, i = 1, COUNT)]) - 20 - sum([(i, i = 21, 30)])) then
+    error stop "[Test] clear() called the range GC with the wrong range."
+  end if
+
+  !* Nothing left, so destroying doesn't call it at all.
+  call reset_range_gc()
+  call v%destroy()
+
+  if (range_calls /= 0) then
+    error stop "[Test] destroy() called the range GC on an empty vector."
+  end if
+
+
+  !* destroy() hands over everything, in one call, too.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, optional_gc_range_func = recording_range_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+  expected_base = v%get(1_c_size_t)
+  call v%destroy()
+
+  if (range_calls /= 1 .or. .not. c_associated(range_base, expected_base) .or. range_count /= COUNT .or. &
+    range_element_size /= c_sizeof(i) .or. range_value_sum /= sum([(i, i = 1, COUNT)])) then
+    error stop "[Test] destroy() called the range GC with the wrong range."
+  end if
+
+  print*,"vec_gc: OK"
+
+end program test_vec_gc
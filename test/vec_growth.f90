@@ -0,0 +1,93 @@
+module growth_test_module
+  use, intrinsic :: iso_c_binding
+  use :: vector
+  implicit none
+
+contains
+
+  !* Push one at a time, and check every capacity the vector grows through, in order.
+  subroutine check_growth(v, expected)
+    implicit none
+
+    type(vec), intent(inout) :: v
+    integer(c_size_t), dimension(:), intent(in) :: expected
+    integer(c_size_t) :: last_capacity
+    integer :: grows
+    integer(c_int) :: i
+
+    last_capacity = v%capacity()
+    grows = 0
+    i = 0
+
+    do while (grows < size(expected))
+      i = i + 1
+      call v%push_back(i)
+
+      if (v%capacity() /= last_capacity) then
+        grows = grows + 1
+        last_capacity = v%capacity()
+
+        if (last_capacity /= expected(grows)) then
+          print*,"grow",grows,"got",last_capacity,"expected",expected(grows)
+          error stop "[Test] The vector grew to the wrong capacity."
+        end if
+      end if
+    end do
+
+    call v%destroy()
+  end subroutine check_growth
+
+end module growth_test_module
+
+
+!* growth_policy: the exact capacities each policy steps through.
+program test_vec_growth
+  use :: growth_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  type(vec) :: v
+  integer(c_int), dimension(1000) :: array
+  integer(c_int) :: i
+
+
+  !* Doubling is the default. Empty vectors go to 1 first.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t)
+  call check_growth(v, [1_c_size_t, 2_c_size_t, 4_c_size_t, 8_c_size_t, 16_c_size_t, 32_c_size_t, 64_c_size_t])
+
+  !* x1.5, rounded down. When that wouldn't grow at all, it grows by one.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, growth_policy = VEC_GROWTH_FACTOR_1_5)
+  call check_growth(v, [1_c_size_t, 2_c_size_t, 3_c_size_t, 4_c_size_t, 6_c_size_t, 9_c_size_t, 13_c_size_t, &
+    19_c_size_t, 28_c_size_t, 42_c_size_t, 63_c_size_t, 94_c_size_t])
+
+  !* A fixed chunk every time.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, growth_policy = VEC_GROWTH_CHUNK, growth_amount = 100_c_size_t)
+  call check_growth(v, [100_c_size_t, 200_c_size_t, 300_c_size_t, 400_c_size_t])
+
+  !* Doubling, until a grow would add more than the cap. Then it adds the cap each time.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, growth_policy = VEC_GROWTH_CAPPED, growth_amount = 64_c_size_t)
+  call check_growth(v, [1_c_size_t, 2_c_size_t, 4_c_size_t, 8_c_size_t, 16_c_size_t, 32_c_size_t, 64_c_size_t, &
+    128_c_size_t, 192_c_size_t, 256_c_size_t, 320_c_size_t])
+
+
+  !* A range that needs more than one step of the policy grows straight to what it needs.
+  array = 0
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, growth_policy = VEC_GROWTH_CHUNK, growth_amount = 100_c_size_t)
+  call v%push_back_array(array)
+
+  if (v%capacity() /= size(array)) then
+    error stop "[Test] A range didn't grow straight to the capacity it needed."
+  end if
+
+  !* After that, the policy picks up from where it is.
+  call v%push_back(1)
+  if (v%capacity() /= size(array) + 100) then
+    error stop "[Test] The policy didn't pick up after a range grow."
+  end if
+
+  call v%destroy()
+
+  print*,"vec_growth: OK"
+
+end program test_vec_growth
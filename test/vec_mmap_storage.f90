@@ -0,0 +1,92 @@
+!* vec_mmap_storage: growing in place inside the reservation, giving pages back, and moving once it's outgrown.
+program test_vec_mmap_storage
+  use :: vector
+  use :: vector_allocator
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* A small reservation, so it's easy to outgrow. 4096 elements fit, 8192 don't.
+  integer(c_size_t), parameter :: RESERVE_BYTES = 65536
+  integer(c_int64_t), parameter :: FITS = 4000
+  integer(c_int64_t), parameter :: KEPT = 100
+  integer(c_int64_t), parameter :: OUTGROWN = 20000
+
+  type(vec_mmap_storage) :: storage
+  type(vec) :: v
+  type(c_ptr) :: first_address
+  integer(c_int64_t), pointer :: int_pointer
+  integer(c_int64_t) :: i
+
+
+  storage = new_vec_mmap_storage(RESERVE_BYTES)
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, allocator = storage%get())
+
+  call v%push_back(1_c_int64_t)
+  first_address = v%get(1_c_size_t)
+
+
+  !* Inside the reservation, growing never moves anything.
+  do i = 2, FITS
+    call v%push_back(i)
+  end do
+
+  if (.not. c_associated(first_address, v%get(1_c_size_t))) then
+    error stop "[Test] The elements moved inside the reservation."
+  end if
+
+
+  !* Shrinking stays put, and gives the pages past the new end back to the kernel.
+  call v%remove_range(int(KEPT + 1, c_size_t), int(FITS, c_size_t))
+  call v%shrink_to_fit()
+
+  if (.not. c_associated(first_address, v%get(1_c_size_t)) .or. v%capacity() /= KEPT) then
+    error stop "[Test] shrink_to_fit() moved the elements."
+  end if
+
+  do i = 1, KEPT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] shrink_to_fit() lost an element it kept."
+    end if
+  end do
+
+  !* Those pages come back as zeroes when it grows into them again, so they really were given back.
+  call v%reserve(int(FITS, c_size_t))
+  call c_f_pointer(v%get_unchecked(int(FITS - 1, c_size_t)), int_pointer)
+  if (int_pointer /= 0) then
+    error stop "[Test] shrink_to_fit() didn't give the tail pages back."
+  end if
+
+
+  !* Growing again, back inside the reservation.
+  do i = KEPT + 1, FITS
+    call v%push_back(i)
+  end do
+
+  if (.not. c_associated(first_address, v%get(1_c_size_t))) then
+    error stop "[Test] The elements moved growing back into the reservation."
+  end if
+
+
+  !* Outgrowing the whole reservation moves to a bigger one, and takes every element along.
+  do i = FITS + 1, OUTGROWN
+    call v%push_back(i)
+  end do
+
+  if (c_associated(first_address, v%get(1_c_size_t))) then
+    error stop "[Test] Outgrowing the reservation didn't move to a new one."
+  end if
+
+  do i = 1, OUTGROWN
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] Moving to a bigger reservation lost an element."
+    end if
+  end do
+
+  call v%destroy()
+  call storage%destroy()
+
+  print*,"vec_mmap_storage: OK"
+
+end program test_vec_mmap_storage
@@ -0,0 +1,130 @@
+module resize_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* How many elements the GC has seen, and the sum of them.
+  integer :: gc_count = 0
+  integer(c_int64_t) :: gc_value_sum = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_int64_t), pointer :: int_pointer
+
+    call c_f_pointer(raw_c_pointer, int_pointer)
+
+    gc_count = gc_count + 1
+    gc_value_sum = gc_value_sum + int_pointer
+  end subroutine counting_gc
+
+end module resize_test_module
+
+
+!* resize() to exact sizes, GCing only what it drops, and take/pop_back_into moving elements out.
+program test_vec_resize
+  use :: resize_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 1000
+  integer(c_int64_t), parameter :: DEFAULT_ELEMENT = -7
+
+  type(vec) :: v
+  integer(c_int64_t), pointer :: int_pointer
+  integer(c_int64_t) :: i, out
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, counting_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* n to 2n: exactly 2n, the old elements untouched, and every new slot is the default.
+  call v%resize(int(2 * COUNT, c_size_t), DEFAULT_ELEMENT)
+
+  if (v%size() /= 2 * COUNT) then
+    error stop "[Test] Growing with resize() gave the wrong size."
+  end if
+
+  do i = 1, 2 * COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+
+    if (i <= COUNT .and. int_pointer /= i) then
+      error stop "[Test] Growing with resize() changed an old element."
+    else if (i > COUNT .and. int_pointer /= DEFAULT_ELEMENT) then
+      error stop "[Test] Growing with resize() didn't fill in the default element."
+    end if
+  end do
+
+  !* Nothing was dropped, so nothing was GC'd.
+  if (gc_count /= 0) then
+    error stop "[Test] Growing with resize() ran the GC."
+  end if
+
+
+  !* 2n to n/2: exactly n/2, and the GC ran on exactly what got dropped.
+  call v%resize(int(COUNT / 2, c_size_t), DEFAULT_ELEMENT)
+
+  if (v%size() /= COUNT / 2) then
+    error stop "[Test] Shrinking with resize() gave the wrong size."
+  end if
+
+  if (gc_count /= 2 * COUNT - (COUNT / 2)) then
+    error stop "[Test] Shrinking with resize() didn't GC every dropped element, once."
+  end if
+
+  if (gc_value_sum /= sum([(i, i = (COUNT / 2) + 1, COUNT)]) + (COUNT * DEFAULT_ELEMENT)) then
+    error stop "[Test] Shrinking with resize() GC'd the wrong elements."
+  end if
+
+  do i = 1, COUNT / 2
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i) then
+      error stop "[Test] Shrinking with resize() changed a kept element."
+    end if
+  end do
+
+  !* Resizing to the same size does nothing.
+  gc_count = 0
+  call v%resize(int(COUNT / 2, c_size_t), DEFAULT_ELEMENT)
+  if (v%size() /= COUNT / 2 .or. gc_count /= 0) then
+    error stop "[Test] resize() to the same size changed something."
+  end if
+
+
+  !* take() moves the bytes out, closes the gap, and leaves the GC alone.
+  call v%take(10_c_size_t, out)
+
+  if (out /= 10 .or. v%size() /= (COUNT / 2) - 1 .or. gc_count /= 0) then
+    error stop "[Test] take() went wrong."
+  end if
+
+  call c_f_pointer(v%get(10_c_size_t), int_pointer)
+  if (int_pointer /= 11) then
+    error stop "[Test] take() didn't close the gap."
+  end if
+
+  !* pop_back_into() moves the last one out, also without the GC.
+  call v%pop_back_into(out)
+
+  if (out /= COUNT / 2 .or. v%size() /= (COUNT / 2) - 2 .or. gc_count /= 0) then
+    error stop "[Test] pop_back_into() went wrong."
+  end if
+
+
+  !* Resizing to 0 GCs the rest.
+  call v%resize(0_c_size_t, DEFAULT_ELEMENT)
+  if (.not. v%is_empty() .or. gc_count /= (COUNT / 2) - 2) then
+    error stop "[Test] resize() to 0 didn't GC everything."
+  end if
+
+  call v%destroy()
+
+  print*,"vec_resize: OK"
+
+end program test_vec_resize
@@ -0,0 +1,150 @@
+module search_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* 5 blocks of 16, and 7 left over for the remainder loop.
+  integer(c_size_t), parameter :: COUNT = 87
+
+contains
+
+  !* Element k is k in the first byte and the last byte, zero in between.
+  !* near_miss puts k + 1 in the last byte, so it only differs at the far end.
+  subroutine make_element(k, element_size, near_miss, element)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: k, element_size
+    logical, intent(in), value :: near_miss
+    integer(c_int8_t), dimension(16), intent(out) :: element
+
+    element = 0
+    element(1) = int(k, c_int8_t)
+    element(element_size) = int(k, c_int8_t)
+
+    if (near_miss) then
+      element(element_size) = int(k + 1, c_int8_t)
+    end if
+  end subroutine make_element
+
+
+  subroutine check_element(v, element_size, index, k)
+    implicit none
+
+    type(vec), intent(inout) :: v
+    integer(c_size_t), intent(in), value :: element_size, index, k
+    integer(c_int8_t), dimension(16) :: expected
+    integer(c_int8_t), dimension(:), pointer :: bytes
+
+    call make_element(k, element_size, .false., expected)
+    call c_f_pointer(v%get(index), bytes, [element_size])
+
+    if (any(bytes /= expected(1:element_size))) then
+      error stop "[Test] An element has the wrong bytes."
+    end if
+  end subroutine check_element
+
+
+  !* find, count, contains, and fill on one element size.
+  subroutine check_kernels(element_size)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: element_size
+    integer(c_int8_t), dimension(16), target :: element
+    type(vec) :: v
+    integer(c_size_t) :: k
+
+    v = new_vec(element_size, 0_c_size_t)
+
+    !* Nothing to find in an empty vector.
+    call make_element(1_c_size_t, element_size, .false., element)
+    if (v%find(element(1)) /= 0 .or. v%count(element(1)) /= 0 .or. v%contains(element(1))) then
+      error stop "[Test] Found something in an empty vector."
+    end if
+
+    do k = 1, COUNT
+      call make_element(k, element_size, .false., element)
+      call v%push_back(element(1))
+    end do
+
+    !* Every element is found at its own 1-based index, including the ones in the remainder.
+    do k = 1, COUNT
+      call make_element(k, element_size, .false., element)
+
+      if (v%find(element(1)) /= k) then
+        error stop "[Test] find() gave the wrong index."
+      end if
+
+      if (v%count(element(1)) /= 1 .or. .not. v%contains(element(1))) then
+        error stop "[Test] count() or contains() missed an element."
+      end if
+    end do
+
+    !* A miss is 0.
+    call make_element(COUNT + 10, element_size, .false., element)
+    if (v%find(element(1)) /= 0 .or. v%count(element(1)) /= 0 .or. v%contains(element(1))) then
+      error stop "[Test] find() found something that isn't there."
+    end if
+
+    !* Every byte counts, even the last one.
+    if (element_size > 1) then
+      do k = 1, COUNT
+        call make_element(k, element_size, .true., element)
+        if (v%find(element(1)) /= 0) then
+          error stop "[Test] find() matched an element that differs in the last byte."
+        end if
+      end do
+    end if
+
+    !* A copy in a block and one in the remainder: find gives the first, count sees both.
+    call make_element(COUNT - 2, element_size, .false., element)
+    call v%set(3_c_size_t, element(1))
+
+    if (v%find(element(1)) /= 3 .or. v%count(element(1)) /= 2) then
+      error stop "[Test] find() or count() went wrong with a duplicate."
+    end if
+
+    !* fill() writes first to last, and nothing either side.
+    call make_element(50_c_size_t, element_size, .false., element)
+    call v%fill(element(1), 10_c_size_t, 20_c_size_t)
+
+    call check_element(v, element_size, 9_c_size_t, 9_c_size_t)
+    call check_element(v, element_size, 10_c_size_t, 50_c_size_t)
+    call check_element(v, element_size, 20_c_size_t, 50_c_size_t)
+    call check_element(v, element_size, 21_c_size_t, 21_c_size_t)
+
+    if (v%count(element(1)) /= 12 .or. v%find(element(1)) /= 10) then
+      error stop "[Test] fill() wrote the wrong range."
+    end if
+
+    !* All the way into the remainder.
+    call v%fill(element(1), 1_c_size_t, COUNT)
+    call check_element(v, element_size, COUNT, 50_c_size_t)
+
+    if (v%count(element(1)) /= COUNT .or. v%find(element(1)) /= 1) then
+      error stop "[Test] fill() over everything missed some."
+    end if
+
+    call v%destroy()
+  end subroutine check_kernels
+
+end module search_test_module
+
+
+!* find, count, contains, and fill: every kernel width, the memcmp fallback, and the remainder loop.
+program test_vec_search
+  use :: search_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  call check_kernels(1_c_size_t)
+  call check_kernels(2_c_size_t)
+  call check_kernels(4_c_size_t)
+  call check_kernels(8_c_size_t)
+  call check_kernels(16_c_size_t)
+
+  !* 12 bytes has no kernel, so this is memcmp.
+  call check_kernels(12_c_size_t)
+
+  print*,"vec_search: OK"
+
+end program test_vec_search
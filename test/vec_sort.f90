@@ -0,0 +1,248 @@
+module sort_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* Values are drawn from 0 to RANGE - 1, so big sizes have plenty of duplicates.
+  integer(c_int64_t), parameter :: RANGE = 1000
+
+  integer(c_int64_t) :: seed = 12345
+
+contains
+
+  function compare_int64(a, b) result(order) bind(c)
+    implicit none
+
+    type(c_ptr), intent(in), value :: a, b
+    integer(c_int) :: order
+    integer(c_int64_t), pointer :: x, y
+
+    call c_f_pointer(a, x)
+    call c_f_pointer(b, y)
+
+    if (x < y) then
+      order = -1
+    else if (x > y) then
+      order = 1
+    else
+      order = 0
+    end if
+  end function compare_int64
+
+
+  !* A small LCG, so every run sorts the same numbers.
+  function next_random() result(value)
+    implicit none
+
+    integer(c_int64_t) :: value
+
+    seed = modulo(seed * 1103515245_c_int64_t + 12345_c_int64_t, 2147483648_c_int64_t)
+    value = modulo(seed / 65536, RANGE)
+  end function next_random
+
+
+  !* Sort count elements made by kind (1 random, 2 already sorted, 3 all the same),
+  !* then check the order, that nothing got lost, and lower_bound/binary_search on the result.
+  subroutine check_sort(count, kind)
+    implicit none
+
+    integer(c_size_t), intent(in), value :: count
+    integer, intent(in), value :: kind
+    type(vec) :: v
+    integer(c_int64_t), dimension(:), pointer :: elements
+    integer(c_int64_t) :: i, value, sum_before, xor_before
+    integer(c_size_t) :: index
+
+    v = new_vec(8_c_size_t, 0_c_size_t)
+
+    sum_before = 0
+    xor_before = 0
+
+    do i = 1, count
+      select case (kind)
+       case (1)
+        value = next_random()
+       case (2)
+        value = (i * RANGE) / (count + 1)
+       case default
+        value = 42
+      end select
+
+      sum_before = sum_before + value
+      xor_before = ieor(xor_before, value * 7919 + i)
+      call v%push_back(value)
+    end do
+
+    call v%sort(compare_int64)
+
+    if (v%size() /= count) then
+      error stop "[Test] sort() changed the size."
+    end if
+
+    if (count == 0) then
+      if (v%lower_bound(1_c_int64_t, compare_int64) /= 1 .or. v%binary_search(1_c_int64_t, compare_int64) /= 0) then
+        error stop "[Test] Searching an empty vector went wrong."
+      end if
+
+      call v%destroy()
+      return
+    end if
+
+    call v%view(elements)
+
+    do i = 2, count
+      if (elements(i - 1) > elements(i)) then
+        error stop "[Test] sort() left the elements out of order."
+      end if
+    end do
+
+    if (sum(elements) /= sum_before) then
+      error stop "[Test] sort() lost or duplicated an element."
+    end if
+
+    !* Sorted or all-equal input has to come out exactly as it went in, position for position.
+    if (kind /= 1 .and. xor_before /= xor_sorted(elements)) then
+      error stop "[Test] sort() didn't keep already sorted input as it was."
+    end if
+
+    !* lower_bound is the first one that isn't less, and binary_search finds one that's equal.
+    do value = -1, RANGE, 37
+      index = v%lower_bound(value, compare_int64)
+
+      if (index < 1 .or. index > count + 1) then
+        error stop "[Test] lower_bound() went out of range."
+      end if
+
+      if (index <= count) then
+        if (elements(index) < value) then
+          error stop "[Test] lower_bound() stopped before value."
+        end if
+      end if
+
+      if (index > 1) then
+        if (elements(index - 1) >= value) then
+          error stop "[Test] lower_bound() stopped after the first match."
+        end if
+      end if
+
+      index = v%binary_search(value, compare_int64)
+
+      if (any(elements == value)) then
+        if (index < 1) then
+          error stop "[Test] binary_search() missed an element."
+        end if
+
+        if (elements(index) /= value) then
+          error stop "[Test] binary_search() found the wrong element."
+        end if
+      else if (index /= 0) then
+        error stop "[Test] binary_search() found something that isn't there."
+      end if
+    end do
+
+    !* Past the end and before the start.
+    if (v%lower_bound(RANGE, compare_int64) /= count + 1 .or. v%lower_bound(-1_c_int64_t, compare_int64) /= 1) then
+      error stop "[Test] lower_bound() past either end went wrong."
+    end if
+
+    call v%destroy()
+  end subroutine check_sort
+
+
+  function xor_sorted(elements) result(total)
+    implicit none
+
+    integer(c_int64_t), dimension(:), intent(in) :: elements
+    integer(c_int64_t) :: total
+    integer(c_int64_t) :: i
+
+    total = 0
+    do i = 1, size(elements, kind = c_int64_t)
+      total = ieor(total, elements(i) * 7919 + i)
+    end do
+  end function xor_sorted
+
+end module sort_test_module
+
+
+!* sort, lower_bound, and binary_search: the introsort on vec, and the radix sort on the typed vectors at the extremes.
+program test_vec_sort
+  use :: sort_test_module
+  use :: vector_i32
+  use :: vector_r64
+  use, intrinsic :: iso_c_binding
+  use, intrinsic :: ieee_arithmetic
+  implicit none
+
+  integer(c_size_t), dimension(5), parameter :: SIZES = [0_c_size_t, 1_c_size_t, 16_c_size_t, 17_c_size_t, 100000_c_size_t]
+
+  type(vec_i32) :: ints
+  type(vec_r64) :: doubles
+  integer(c_int32_t), dimension(:), pointer :: int_view
+  real(c_double), dimension(:), pointer :: double_view
+  real(c_double) :: nan, denormal
+  integer :: i, kind
+
+
+  !* 16 is all insertion sort, 17 is the first one that partitions.
+  do i = 1, size(SIZES)
+    do kind = 1, 3
+      call check_sort(SIZES(i), kind)
+    end do
+  end do
+
+
+  !* The radix sort flips the sign bit, so both ends of the range have to land right.
+  ints = new_vec_i32(0_c_size_t)
+  call ints%push_back_array([huge(0_c_int32_t), 0_c_int32_t, -huge(0_c_int32_t) - 1_c_int32_t, -1_c_int32_t, &
+    1_c_int32_t, huge(0_c_int32_t) - 1_c_int32_t, -huge(0_c_int32_t)])
+
+  call ints%sort()
+  int_view => ints%view()
+
+  if (any(int_view /= [-huge(0_c_int32_t) - 1_c_int32_t, -huge(0_c_int32_t), -1_c_int32_t, 0_c_int32_t, &
+    1_c_int32_t, huge(0_c_int32_t) - 1_c_int32_t, huge(0_c_int32_t)])) then
+    error stop "[Test] vec_i32 sort() got the extremes wrong."
+  end if
+
+  if (ints%lower_bound(-huge(0_c_int32_t) - 1_c_int32_t) /= 1 .or. ints%binary_search(huge(0_c_int32_t)) /= 7 .or. &
+    ints%binary_search(2_c_int32_t) /= 0) then
+    error stop "[Test] vec_i32 searching the extremes went wrong."
+  end if
+
+  call ints%destroy()
+
+
+  !* Reals: -0.0 goes right before 0.0, denormals go between zero and tiny, and NaN goes last.
+  nan = ieee_value(nan, ieee_quiet_nan)
+  denormal = tiny(denormal) / 4
+
+  doubles = new_vec_r64(0_c_size_t)
+  call doubles%push_back_array([1.0_c_double, nan, 0.0_c_double, -0.0_c_double, denormal, -denormal, &
+    -huge(denormal), huge(denormal), tiny(denormal), -1.0_c_double])
+
+  call doubles%sort()
+  double_view => doubles%view()
+
+  if (any(double_view(1:9) /= [-huge(denormal), -1.0_c_double, -denormal, 0.0_c_double, 0.0_c_double, &
+    denormal, tiny(denormal), 1.0_c_double, huge(denormal)])) then
+    error stop "[Test] vec_r64 sort() got the order wrong."
+  end if
+
+  if (.not. ieee_is_negative(double_view(4)) .or. ieee_is_negative(double_view(5))) then
+    error stop "[Test] vec_r64 sort() didn't put -0.0 before 0.0."
+  end if
+
+  if (.not. ieee_is_nan(double_view(10))) then
+    error stop "[Test] vec_r64 sort() didn't put NaN last."
+  end if
+
+  if (doubles%lower_bound(0.0_c_double) /= 5 .or. doubles%binary_search(denormal) /= 6) then
+    error stop "[Test] vec_r64 searching around zero went wrong."
+  end if
+
+  call doubles%destroy()
+
+  print*,"vec_sort: OK"
+
+end program test_vec_sort
@@ -0,0 +1,112 @@
+module stats_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+contains
+
+  subroutine do_nothing_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    if (.not. c_associated(raw_c_pointer)) then
+      error stop "[Test] The GC got a null pointer."
+    end if
+  end subroutine do_nothing_gc
+
+end module stats_test_module
+
+
+!* Stats: what each counter sees, that a vector without a stats_name counts nothing, and vec_stats_dump.
+program test_vec_stats
+  use :: stats_test_module
+  use :: vector
+  use :: fortran_vector_bindings, only: vector_header_size
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 1000
+
+  type(vec) :: v, quiet
+  type(vec_stats) :: stats
+  integer(c_int64_t) :: i
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, do_nothing_gc, stats_name = "counted")
+  quiet = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, do_nothing_gc)
+
+  do i = 1, COUNT
+    call v%push_back(i)
+    call quiet%push_back(i)
+  end do
+
+
+  !* Doubling from 0 up to 1024 is 11 reallocations, each carrying over the header and 0, 1, 2, ... 512 elements.
+  stats = v%stats()
+
+  if (stats%grows /= 11 .or. stats%bytes_copied /= (11 * vector_header_size) + (1023 * c_sizeof(i)) .or. &
+    stats%peak_capacity /= 1024) then
+    error stop "[Test] Growing was counted wrong."
+  end if
+
+  if (stats%memmove_bytes /= 0 .or. stats%gc_calls /= 0 .or. stats%lock_wait_nanoseconds /= 0) then
+    error stop "[Test] Pushing counted something that didn't happen."
+  end if
+
+
+  !* Removing the first one shifts everything after it down.
+  call v%remove(1_c_size_t)
+  stats = v%stats()
+
+  if (stats%memmove_bytes /= (COUNT - 1) * c_sizeof(i) .or. stats%gc_calls /= 1) then
+    error stop "[Test] remove() was counted wrong."
+  end if
+
+  !* Inserting at the front shifts them all back up.
+  call v%insert(1_c_size_t, 1_c_int64_t)
+  stats = v%stats()
+
+  if (stats%memmove_bytes /= 2 * (COUNT - 1) * c_sizeof(i) .or. stats%grows /= 11) then
+    error stop "[Test] insert() was counted wrong."
+  end if
+
+  !* clear() GCs everything that's left.
+  call v%clear()
+  stats = v%stats()
+
+  if (stats%gc_calls /= COUNT + 1) then
+    error stop "[Test] clear() didn't count its GC calls."
+  end if
+
+  !* The peak stays the peak after shrinking.
+  call v%shrink_to_fit()
+  stats = v%stats()
+
+  if (stats%peak_capacity /= 1024) then
+    error stop "[Test] shrink_to_fit() lowered the peak capacity."
+  end if
+
+
+  !* Without a stats_name, there's nothing to read.
+  call quiet%remove(1_c_size_t)
+  call quiet%clear()
+  stats = quiet%stats()
+
+  if (stats%grows /= 0 .or. stats%bytes_copied /= 0 .or. stats%memmove_bytes /= 0 .or. stats%gc_calls /= 0 .or. &
+    stats%peak_capacity /= 0) then
+    error stop "[Test] A vector without stats counted something."
+  end if
+
+
+  !* The dump lists the named one. (It goes to stdout, so this is just checking it gets through.)
+  call vec_stats_dump()
+
+  call v%destroy()
+  call quiet%destroy()
+
+  !* And once it's destroyed, the dump has nothing left to list.
+  call vec_stats_dump()
+
+  print*,"vec_stats: OK"
+
+end program test_vec_stats
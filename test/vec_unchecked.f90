@@ -0,0 +1,93 @@
+module unchecked_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* How many elements the GC has seen, and the last one it saw.
+  integer :: gc_count = 0
+  integer(c_int) :: last_gc_value = 0
+
+contains
+
+  subroutine recording_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+    integer(c_int), pointer :: int_pointer
+
+    call c_f_pointer(raw_c_pointer, int_pointer)
+
+    gc_count = gc_count + 1
+    last_gc_value = int_pointer
+  end subroutine recording_gc
+
+end module unchecked_test_module
+
+
+!* get_unchecked and set_unchecked: the same elements as get and set, worked out in Fortran.
+program test_vec_unchecked
+  use :: unchecked_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int), parameter :: COUNT = 1000
+
+  type(vec) :: v
+  integer(c_int), pointer :: int_pointer
+  integer(c_int) :: i
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t, recording_gc)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* Every address matches the checked one.
+  do i = 1, COUNT
+    if (.not. c_associated(v%get_unchecked(int(i, c_size_t)), v%get(int(i, c_size_t)))) then
+      error stop "[Test] get_unchecked() found a different address than get()."
+    end if
+  end do
+
+
+  !* set_unchecked writes straight into the element, and GCs just the one it overwrites.
+  do i = 1, COUNT
+    call v%set_unchecked(int(i, c_size_t), -i)
+
+    if (gc_count /= i .or. last_gc_value /= i) then
+      error stop "[Test] set_unchecked() didn't GC the element it overwrote."
+    end if
+  end do
+
+  do i = 1, COUNT
+    call c_f_pointer(v%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= -i) then
+      error stop "[Test] set_unchecked() wrote to the wrong place."
+    end if
+  end do
+
+  !* The first and last are where the edges would go wrong.
+  call c_f_pointer(v%get_unchecked(1_c_size_t), int_pointer)
+  if (int_pointer /= -1) then
+    error stop "[Test] get_unchecked() is off by one at the start."
+  end if
+
+  call c_f_pointer(v%get_unchecked(int(COUNT, c_size_t)), int_pointer)
+  if (int_pointer /= -COUNT) then
+    error stop "[Test] get_unchecked() is off by one at the end."
+  end if
+
+
+  !* Still right after the vector moves.
+  call v%reserve(int(COUNT * 4, c_size_t))
+  call c_f_pointer(v%get_unchecked(int(COUNT / 2, c_size_t)), int_pointer)
+  if (int_pointer /= -(COUNT / 2)) then
+    error stop "[Test] get_unchecked() is wrong after a reallocation."
+  end if
+
+  call v%destroy()
+
+  print*,"vec_unchecked: OK"
+
+end program test_vec_unchecked
@@ -0,0 +1,77 @@
+!* view() and data_ptr(): Fortran arrays straight over the vector's memory.
+program test_vec_view
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 1000
+
+  type(vec) :: v, reals, never_created
+  integer(c_int64_t), dimension(:), pointer :: ints
+  real(c_double), dimension(:), pointer :: doubles, from_data_ptr
+  integer(c_int64_t) :: i
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_c_size_t)
+  do i = 1, COUNT
+    call v%push_back(i)
+  end do
+
+
+  !* The view is the vector's memory, so it sees every element, and writes go straight in.
+  call v%view(ints)
+
+  if (size(ints) /= COUNT .or. sum(ints) /= (COUNT * (COUNT + 1)) / 2) then
+    error stop "[Test] The view doesn't see every element."
+  end if
+
+  if (.not. c_associated(c_loc(ints(1)), v%get(1_c_size_t))) then
+    error stop "[Test] The view isn't over the vector's memory."
+  end if
+
+  ints = ints * 2
+
+  call c_f_pointer(v%get(int(COUNT, c_size_t)), ints, [1])
+  if (ints(1) /= COUNT * 2) then
+    error stop "[Test] Writing through the view didn't reach the vector."
+  end if
+
+
+  !* data_ptr() is the same memory, for c_f_pointer.
+  reals = new_vec(int(c_sizeof(0.0_c_double), c_size_t), 0_c_size_t)
+  do i = 1, COUNT
+    call reals%push_back(real(i, c_double))
+  end do
+
+  call reals%view(doubles)
+  call c_f_pointer(reals%data_ptr(), from_data_ptr, [reals%size()])
+
+  if (.not. all(doubles == from_data_ptr)) then
+    error stop "[Test] data_ptr() and view() disagree."
+  end if
+
+
+  !* An empty vector gives an empty view.
+  call reals%clear()
+  call reals%view(doubles)
+  if (size(doubles) /= 0) then
+    error stop "[Test] An empty vector gave a view with elements in it."
+  end if
+
+
+  !* A vector that was never created has nothing to point at.
+  if (c_associated(never_created%data_ptr())) then
+    error stop "[Test] data_ptr() on a vector that was never created isn't null."
+  end if
+
+  call never_created%view(doubles)
+  if (size(doubles) /= 0) then
+    error stop "[Test] view() on a vector that was never created isn't empty."
+  end if
+
+  call reals%destroy()
+  call v%destroy()
+
+  print*,"vec_view: OK"
+
+end program test_vec_view
@@ -0,0 +1,142 @@
+module vector_io_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* Where the tests write their files. Deleted at the end.
+  character(len = *), parameter :: PATH = "test_vector_io.vec"
+  character(len = *), parameter :: EMPTY_PATH = "test_vector_io_empty.vec"
+
+  !* How many elements the GC has seen.
+  integer :: gc_count = 0
+
+contains
+
+  subroutine counting_gc(raw_c_pointer)
+    implicit none
+
+    type(c_ptr), intent(in), value :: raw_c_pointer
+
+    gc_count = gc_count + 1
+  end subroutine counting_gc
+
+
+  subroutine delete_file(file_path)
+    implicit none
+
+    character(len = *), intent(in) :: file_path
+    integer :: unit
+
+    open(newunit = unit, file = file_path, status = "old")
+    close(unit, status = "delete")
+  end subroutine delete_file
+
+end module vector_io_test_module
+
+
+!* save(), load(), and map_readonly(): everything that goes out comes back the same.
+program test_vector_io
+  use :: vector_io_test_module
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  integer(c_int64_t), parameter :: COUNT = 10000
+
+  type(vec) :: v, loaded, mapped, empty
+  integer(c_int64_t), pointer :: int_pointer
+  integer(c_int64_t) :: i
+
+
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+  do i = 1, COUNT
+    call v%push_back(i * 7)
+  end do
+
+  call v%save(PATH)
+
+
+  !* Loading into a fresh vector gets back every element, in order.
+  loaded = new_vec(int(c_sizeof(i), c_size_t), 0_8, counting_gc)
+  call loaded%load(PATH)
+
+  if (loaded%size() /= COUNT) then
+    error stop "[Test] load() got the wrong size."
+  end if
+
+  do i = 1, COUNT
+    call c_f_pointer(loaded%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i * 7) then
+      error stop "[Test] load() got the wrong element."
+    end if
+  end do
+
+  !* Nothing was there before, so nothing was GC'd.
+  if (gc_count /= 0) then
+    error stop "[Test] load() into an empty vector ran the GC."
+  end if
+
+  !* Loading again replaces what's there, and the GC runs on all of it first.
+  call loaded%load(PATH)
+
+  if (gc_count /= COUNT) then
+    error stop "[Test] load() didn't GC the old elements."
+  end if
+
+  if (loaded%size() /= COUNT) then
+    error stop "[Test] load() appended instead of replacing."
+  end if
+
+  !* A loaded vector is a normal one, it can still grow.
+  call loaded%push_back(-1_c_int64_t)
+  call c_f_pointer(loaded%get(int(COUNT + 1, c_size_t)), int_pointer)
+  if (int_pointer /= -1) then
+    error stop "[Test] A loaded vector can't be pushed to."
+  end if
+
+
+  !* Mapping sees the same elements, without copying them.
+  call mapped%map_readonly(PATH)
+
+  if (.not. mapped%is_read_only()) then
+    error stop "[Test] A mapped vector isn't read only."
+  end if
+
+  if (v%is_read_only() .or. loaded%is_read_only()) then
+    error stop "[Test] A normal vector says it's read only."
+  end if
+
+  if (mapped%size() /= COUNT) then
+    error stop "[Test] map_readonly() got the wrong size."
+  end if
+
+  do i = 1, COUNT
+    call c_f_pointer(mapped%get(int(i, c_size_t)), int_pointer)
+    if (int_pointer /= i * 7) then
+      error stop "[Test] map_readonly() got the wrong element."
+    end if
+  end do
+
+  !* Destroying it just unmaps the file.
+  call mapped%destroy()
+
+
+  !* An empty vector round trips too.
+  empty = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+  call empty%save(EMPTY_PATH)
+
+  call loaded%load(EMPTY_PATH)
+  if (.not. loaded%is_empty()) then
+    error stop "[Test] Loading an empty file left elements behind."
+  end if
+
+
+  call empty%destroy()
+  call loaded%destroy()
+  call v%destroy()
+
+  call delete_file(PATH)
+  call delete_file(EMPTY_PATH)
+
+  print*,"vector_io: OK"
+
+end program test_vector_io
@@ -0,0 +1,165 @@
+module vector_stream_test_module
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* Where the tests write their files. Deleted at the end.
+  character(len = *), parameter :: PATH = "test_vector_stream.vec"
+  character(len = *), parameter :: EMPTY_PATH = "test_vector_stream_empty.vec"
+  character(len = *), parameter :: SAVED_PATH = "test_vector_stream_saved.vec"
+
+contains
+
+  subroutine delete_file(file_path)
+    implicit none
+
+    character(len = *), intent(in) :: file_path
+    integer :: unit
+
+    open(newunit = unit, file = file_path, status = "old")
+    close(unit, status = "delete")
+  end subroutine delete_file
+
+end module vector_stream_test_module
+
+
+!* vec_stream_writer and vec_stream_reader: chunk sizes that never line up with what's pushed.
+program test_vector_stream
+  use :: vector_stream_test_module
+  use :: vector_stream
+  use :: vector
+  use, intrinsic :: iso_c_binding
+  implicit none
+
+  !* None of these divide each other, so every boundary lands somewhere new.
+  integer(c_int64_t), parameter :: PUSHED = 12345
+  integer(c_int64_t), parameter :: ARRAY_LENGTH = 777
+  integer(c_int64_t), parameter :: TOTAL = PUSHED + ARRAY_LENGTH
+  integer(c_size_t), parameter :: WRITE_CHUNK = 1000
+  integer(c_size_t), parameter :: READ_CHUNK = 333
+
+  type(vec_stream_writer) :: w
+  type(vec_stream_reader) :: r
+  type(vec) :: v
+  type(c_ptr) :: chunk
+  integer(c_int64_t), dimension(:), pointer :: chunk_array
+  integer(c_int64_t), dimension(ARRAY_LENGTH) :: array
+  integer(c_int64_t), pointer :: int_pointer
+  integer(c_int64_t) :: i, expected
+  integer(c_size_t) :: count
+  logical :: short_chunk_seen
+
+
+  w = new_vec_stream_writer(PATH, int(c_sizeof(i), c_size_t), WRITE_CHUNK)
+
+  do i = 1, PUSHED
+    call w%push_back(i)
+  end do
+
+  !* The writer's buffer is partly full here, so this array gets split across a write.
+  do i = 1, ARRAY_LENGTH
+    array(i) = PUSHED + i
+  end do
+  call w%push_back_array(array)
+
+  if (w%size() /= TOTAL) then
+    error stop "[Test] The writer counted the wrong size."
+  end if
+
+  !* This writes out the last, partial chunk.
+  call w%destroy()
+
+
+  !* Reading back with a different chunk size gets everything, in order, across every boundary.
+  r = new_vec_stream_reader(PATH, int(c_sizeof(i), c_size_t), READ_CHUNK)
+
+  if (r%size() /= TOTAL) then
+    error stop "[Test] The reader sees the wrong size."
+  end if
+
+  expected = 1
+  short_chunk_seen = .false.
+
+  do while (r%next(chunk, count))
+    !* Only the last chunk can come up short.
+    if (short_chunk_seen .or. count > READ_CHUNK .or. count == 0) then
+      error stop "[Test] The reader gave a chunk of the wrong size."
+    end if
+    short_chunk_seen = count < READ_CHUNK
+
+    call c_f_pointer(chunk, chunk_array, [count])
+    do i = 1, int(count, c_int64_t)
+      if (chunk_array(i) /= expected) then
+        error stop "[Test] The reader gave the wrong element."
+      end if
+      expected = expected + 1
+    end do
+  end do
+
+  if (expected /= TOTAL + 1) then
+    error stop "[Test] The reader didn't read everything."
+  end if
+
+  !* Once it's done, it stays done.
+  if (r%next(chunk, count)) then
+    error stop "[Test] The reader kept going after the end."
+  end if
+
+  call r%destroy()
+
+
+  !* Stopping early, while the next chunk is still being read in, is fine.
+  r = new_vec_stream_reader(PATH, int(c_sizeof(i), c_size_t), 10_8)
+  if (.not. r%next(chunk, count)) then
+    error stop "[Test] The reader gave nothing."
+  end if
+  call r%destroy()
+
+
+  !* The file is the same as one from save(), so load() and map_readonly() can open it.
+  v = new_vec(int(c_sizeof(i), c_size_t), 0_8)
+  call v%load(PATH)
+
+  if (v%size() /= TOTAL) then
+    error stop "[Test] load() couldn't read a streamed file."
+  end if
+
+  call c_f_pointer(v%get(int(TOTAL, c_size_t)), int_pointer)
+  if (int_pointer /= TOTAL) then
+    error stop "[Test] load() got the wrong last element."
+  end if
+
+  !* And the other way, a file from save() streams back in.
+  call v%save(SAVED_PATH)
+  call v%destroy()
+
+  r = new_vec_stream_reader(SAVED_PATH, int(c_sizeof(i), c_size_t), READ_CHUNK)
+  if (r%size() /= TOTAL) then
+    error stop "[Test] The reader couldn't read a saved file."
+  end if
+  call r%destroy()
+
+  call v%map_readonly(PATH)
+  if (v%size() /= TOTAL) then
+    error stop "[Test] map_readonly() couldn't read a streamed file."
+  end if
+  call v%destroy()
+
+
+  !* An empty stream reads back as nothing.
+  w = new_vec_stream_writer(EMPTY_PATH, int(c_sizeof(i), c_size_t), 10_8)
+  call w%destroy()
+
+  r = new_vec_stream_reader(EMPTY_PATH, int(c_sizeof(i), c_size_t), 10_8)
+  if (r%size() /= 0 .or. r%next(chunk, count)) then
+    error stop "[Test] An empty stream gave something back."
+  end if
+  call r%destroy()
+
+
+  call delete_file(PATH)
+  call delete_file(EMPTY_PATH)
+  call delete_file(SAVED_PATH)
+
+  print*,"vector_stream: OK"
+
+end program test_vector_stream